@@ -217,7 +217,6 @@ public:
             metric_report_interval,
             true
         );
-        nginx_attachment_metric.registerListener();
 
         nginx_intaker_metric.init(
             "Nginx Attachment Plugin data",
@@ -235,7 +234,6 @@ public:
             metric_report_interval,
             true
         );
-        transaction_table_metric.registerListener();
 
         nginx_plugin_cpu_metric.init(
             "Nginx Attachment Plugin CPU data",
@@ -638,8 +636,6 @@ private:
                 auto on_exit = make_scope_exit(
                     [this]()
                     {
-                        nginx_attachment_event.notify();
-                        nginx_attachment_event.resetAllCounters();
                         nginx_intaker_event.notify();
                         nginx_intaker_event.resetAllCounters();
                     }
@@ -660,9 +656,7 @@ private:
         traffic_indicator = true;
         dbgInfo(D_NGINX_ATTACHMENT) << "Successfully registered attachment";
 
-        nginx_attachment_event.addNetworkingCounter(nginxAttachmentEvent::networkVerdict::REGISTRATION_SUCCESS);
-        nginx_attachment_event.notify();
-        nginx_attachment_event.resetAllCounters();
+        nginx_attachment_metric.addNetworkingCounter(nginxAttachmentMetric::networkVerdict::REGISTRATION_SUCCESS);
         return true;
     }
 
@@ -1079,7 +1073,12 @@ private:
     {
         dbgFlow(D_NGINX_ATTACHMENT) << "Handling response headers";
         bool did_fail_on_purpose = false;
+        auto parse_start = chrono::steady_clock::now();
         auto response_headers_maybe = NginxParser::parseResponseHeaders(headers_data);
+        nginx_attachment_metric.addStageLatency(
+            nginxAttachmentMetric::inspectionStage::HEADER_PARSE,
+            getTimeSince(parse_start)
+        );
         if (SHOULD_FAIL(
             response_headers_maybe.ok(), IntentionalFailureHandler::FailureType::ParsingResponse, &did_fail_on_purpose
         )) {
@@ -1164,12 +1163,15 @@ private:
         switch (chunk_type) {
             case ChunkType::REQUEST_START:
                 return handleStartTransaction(data, opaque);
-            case ChunkType::REQUEST_HEADER:
-                return handleMultiModifiableChunks(
-                    NginxParser::parseRequestHeaders(data, ignored_headers),
-                    "request header",
-                    true
+            case ChunkType::REQUEST_HEADER: {
+                auto parse_start = chrono::steady_clock::now();
+                auto request_headers = NginxParser::parseRequestHeaders(data, ignored_headers);
+                nginx_attachment_metric.addStageLatency(
+                    nginxAttachmentMetric::inspectionStage::HEADER_PARSE,
+                    getTimeSince(parse_start)
                 );
+                return handleMultiModifiableChunks(request_headers, "request header", true);
+            }
             case ChunkType::REQUEST_BODY:
                 return handleModifiableChunk(NginxParser::parseRequestBody(data), "request body", true);
             case ChunkType::REQUEST_END: {
@@ -1186,7 +1188,7 @@ private:
             case ChunkType::RESPONSE_HEADER:
                 return handleResponseHeaders(data, opaque);
             case ChunkType::RESPONSE_BODY:
-                nginx_attachment_event.addResponseInspectionCounter(1);
+                nginx_attachment_metric.addResponseInspectionCounter(1);
                 return handleResponseBody(data, opaque);
             case ChunkType::RESPONSE_END:
                 return FilterVerdict(http_manager->inspectEndTransaction());
@@ -1480,6 +1482,12 @@ private:
         sendChunkedData(ipc, verdict_data_sizes.data(), verdict_data.data(), verdict_data.size());
     }
 
+    static chrono::microseconds
+    getTimeSince(const chrono::steady_clock::time_point &start)
+    {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+    }
+
     void
     handleVerdictResponse(const FilterVerdict &verdict, SharedMemoryIPC *ipc, SessionID session_id, bool is_header)
     {
@@ -1491,7 +1499,7 @@ private:
         vector<uint16_t> fragments_sizes = { sizeof(verdict_to_send) };
 
         if (verdict.getVerdict() == INJECT) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::INJECT);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::INJECT);
             verdict_to_send.modification_count = verdict.getModificationsAmount();
             return handleModifiedResponse(
                 ipc,
@@ -1504,7 +1512,7 @@ private:
         }
 
         if (verdict.getVerdict() == DROP) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::DROP);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::DROP);
             verdict_to_send.modification_count = 1;
             ScopedContext ctx;
             set<string> triggers_set{verdict.getWebUserResponseID()};
@@ -1534,15 +1542,15 @@ private:
         }
 
         if (verdict.getVerdict() == ACCEPT) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::ACCEPT);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::ACCEPT);
         } else if (verdict.getVerdict() == INSPECT) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::INSPECT);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::INSPECT);
         } else if (verdict.getVerdict() == IRRELEVANT) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::IRRELEVANT);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::IRRELEVANT);
         } else if (verdict.getVerdict() == RECONF) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::RECONF);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::RECONF);
         } else if (verdict.getVerdict() == WAIT) {
-            nginx_attachment_event.addTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::WAIT);
+            nginx_attachment_metric.addTrafficVerdictCounter(nginxAttachmentMetric::trafficVerdict::WAIT);
         }
 
         sendChunkedData(ipc, fragments_sizes.data(), verdict_fragments.data(), verdict_fragments.size());
@@ -1607,7 +1615,7 @@ private:
 
             resetIpc(primary_attachment_ipc, num_of_nginx_ipc_elements);
             resetIpc(secondary_attachment_sync_ipc, num_of_nginx_ipc_elements);
-            nginx_attachment_event.addNetworkingCounter(nginxAttachmentEvent::networkVerdict::CONNECTION_FAIL);
+            nginx_attachment_metric.addNetworkingCounter(nginxAttachmentMetric::networkVerdict::CONNECTION_FAIL);
             return genError("Failed to receive data from corrupted IPC");
         }
 
@@ -1616,7 +1624,7 @@ private:
             res == 0, IntentionalFailureHandler::FailureType::GetDataFromAttchment, &did_fail_on_purpose
         )) {
             dbgWarning(D_NGINX_ATTACHMENT) << "Failed to receive data from NGINX attachment";
-            nginx_attachment_event.addNetworkingCounter(nginxAttachmentEvent::networkVerdict::CONNECTION_FAIL);
+            nginx_attachment_metric.addNetworkingCounter(nginxAttachmentMetric::networkVerdict::CONNECTION_FAIL);
             return pair<uint16_t, const char *>(0, nullptr);
         }
 
@@ -1637,7 +1645,7 @@ private:
             popData(attachment_ipc);
             resetIpc(primary_attachment_ipc, num_of_nginx_ipc_elements);
             resetIpc(secondary_attachment_sync_ipc, num_of_nginx_ipc_elements);
-            nginx_attachment_event.addNetworkingCounter(nginxAttachmentEvent::networkVerdict::CONNECTION_FAIL);
+            nginx_attachment_metric.addNetworkingCounter(nginxAttachmentMetric::networkVerdict::CONNECTION_FAIL);
             return genError("Data received is smaller than expected");
         }
 
@@ -1647,11 +1655,16 @@ private:
     Maybe<pair<uint32_t, bool>>
     handleRequestFromQueue(SharedMemoryIPC *attachment_ipc, uint32_t signaled_session_id)
     {
+        auto chunk_start = chrono::steady_clock::now();
         Maybe<pair<uint16_t, const char *>> read_data = readData(attachment_ipc);
         if (!read_data.ok()) {
             dbgWarning(D_NGINX_ATTACHMENT) << "Failed to read data. Error: " << read_data.getErr();
             return make_pair(corrupted_session_id, true);
         }
+        nginx_attachment_metric.addStageLatency(
+            nginxAttachmentMetric::inspectionStage::ATTACHMENT_READ,
+            getTimeSince(chunk_start)
+        );
 
         uint16_t incoming_data_size = read_data.unpack().first;
         const char *incoming_data = read_data.unpack().second;
@@ -1673,7 +1686,7 @@ private:
             popData(attachment_ipc);
             resetIpc(primary_attachment_ipc, num_of_nginx_ipc_elements);
             resetIpc(secondary_attachment_sync_ipc, num_of_nginx_ipc_elements);
-            nginx_attachment_event.addNetworkingCounter(nginxAttachmentEvent::networkVerdict::CONNECTION_FAIL);
+            nginx_attachment_metric.addNetworkingCounter(nginxAttachmentMetric::networkVerdict::CONNECTION_FAIL);
             return make_pair(corrupted_session_id, true);
         }
 
@@ -1751,8 +1764,7 @@ private:
         }
 
         if (i_transaction_table != nullptr) {
-            transaction_table_event.setTransactionTableSize(i_transaction_table->count());
-            transaction_table_event.notify();
+            transaction_table_metric.reportTransactionTableSize(i_transaction_table->count());
         }
 
         NginxAttachmentOpaque &opaque = i_transaction_table->getState<NginxAttachmentOpaque>();
@@ -1770,7 +1782,12 @@ private:
             verdict = FilterVerdict(INSPECT);
         }
 
+        auto verdict_write_start = chrono::steady_clock::now();
         handleVerdictResponse(verdict, attachment_ipc, transaction_data->session_id, is_header);
+        nginx_attachment_metric.addStageLatency(
+            nginxAttachmentMetric::inspectionStage::VERDICT_WRITE,
+            getTimeSince(verdict_write_start)
+        );
 
         bool is_final_verdict = verdict.getVerdict() == ACCEPT ||
                                 verdict.getVerdict() == DROP   ||
@@ -1788,6 +1805,14 @@ private:
 
         popData(attachment_ipc);
 
+        opaque.addProcessingTime(getTimeSince(chunk_start));
+        if (is_final_verdict) {
+            nginx_attachment_metric.addStageLatency(
+                nginxAttachmentMetric::inspectionStage::TRANSACTION,
+                opaque.getProcessingTime()
+            );
+        }
+
         opaque.deactivateContext();
         if (is_final_verdict) {
             removeTransactionEntry(transaction_data->session_id);
@@ -2019,11 +2044,9 @@ private:
                     i_socket->closeSocket(new_attachment_socket);
                     new_attachment_socket = -1;
 
-                    nginx_attachment_event.addNetworkingCounter(
-                        nginxAttachmentEvent::networkVerdict::REGISTRATION_FAIL
+                    nginx_attachment_metric.addNetworkingCounter(
+                        nginxAttachmentMetric::networkVerdict::REGISTRATION_FAIL
                     );
-                    nginx_attachment_event.notify();
-                    nginx_attachment_event.resetAllCounters();
                     return;
                 }
 
@@ -2032,11 +2055,9 @@ private:
                     i_socket->closeSocket(new_attachment_socket);
                     new_attachment_socket = -1;
 
-                    nginx_attachment_event.addNetworkingCounter(
-                        nginxAttachmentEvent::networkVerdict::REGISTRATION_FAIL
+                    nginx_attachment_metric.addNetworkingCounter(
+                        nginxAttachmentMetric::networkVerdict::REGISTRATION_FAIL
                     );
-                    nginx_attachment_event.notify();
-                    nginx_attachment_event.resetAllCounters();
                     dbgWarning(D_NGINX_ATTACHMENT) << "Failed to register attachment";
                 } else {
                     // Set affinity to core based on received target core from NGINX
@@ -2126,8 +2147,6 @@ private:
                             auto on_exit = make_scope_exit(
                                 [this]()
                                 {
-                                    nginx_attachment_event.notify();
-                                    nginx_attachment_event.resetAllCounters();
                                     nginx_intaker_event.notify();
                                     nginx_intaker_event.resetAllCounters();
                                 }
@@ -2328,11 +2347,9 @@ private:
     chrono::time_point<chrono::steady_clock> registration_duration_start = chrono::steady_clock::now();
 
     chrono::seconds metric_report_interval;
-    nginxAttachmentEvent nginx_attachment_event;
     nginxAttachmentMetric nginx_attachment_metric;
     nginxIntakerEvent nginx_intaker_event;
     nginxIntakerMetric nginx_intaker_metric;
-    TransactionTableEvent transaction_table_event;
     TransactionTableMetric transaction_table_metric;
 
     ///
@@ -2442,11 +2459,16 @@ private:
     uint32_t
     handleRequestFromQueueAsync(SharedMemoryIPC *ipc)
     {
+        auto chunk_start = chrono::steady_clock::now();
         Maybe<pair<uint16_t, const char *>> read_data = readData(ipc);
         if (!read_data.ok()) {
             dbgWarning(D_NGINX_ATTACHMENT) << "Failed to read data. Error: " << read_data.getErr();
             return corrupted_session_id;
         }
+        nginx_attachment_metric.addStageLatency(
+            nginxAttachmentMetric::inspectionStage::ATTACHMENT_READ,
+            getTimeSince(chunk_start)
+        );
 
         uint16_t incoming_data_size = read_data.unpack().first;
         const char *incoming_data = read_data.unpack().second;
@@ -2468,7 +2490,7 @@ private:
             popData(ipc);
             resetIpc(primary_attachment_ipc, num_of_nginx_ipc_elements);
             resetIpc(secondary_attachment_sync_ipc, num_of_nginx_ipc_elements);
-            nginx_attachment_event.addNetworkingCounter(nginxAttachmentEvent::networkVerdict::CONNECTION_FAIL);
+            nginx_attachment_metric.addNetworkingCounter(nginxAttachmentMetric::networkVerdict::CONNECTION_FAIL);
             return corrupted_session_id;
         }
 
@@ -2548,8 +2570,7 @@ private:
         }
 
         if (i_transaction_table != nullptr) {
-            transaction_table_event.setTransactionTableSize(i_transaction_table->count());
-            transaction_table_event.notify();
+            transaction_table_metric.reportTransactionTableSize(i_transaction_table->count());
         }
 
         NginxAttachmentOpaque &opaque = i_transaction_table->getState<NginxAttachmentOpaque>();
@@ -2567,7 +2588,12 @@ private:
             verdict = FilterVerdict(INSPECT);
         }
 
+        auto verdict_write_start = chrono::steady_clock::now();
         handleVerdictResponse(verdict, ipc, transaction_data->session_id, is_header);
+        nginx_attachment_metric.addStageLatency(
+            nginxAttachmentMetric::inspectionStage::VERDICT_WRITE,
+            getTimeSince(verdict_write_start)
+        );
 
         bool is_final_verdict = verdict.getVerdict() == ACCEPT ||
                                 verdict.getVerdict() == DROP   ||
@@ -2585,6 +2611,14 @@ private:
 
         popData(ipc);
 
+        opaque.addProcessingTime(getTimeSince(chunk_start));
+        if (is_final_verdict) {
+            nginx_attachment_metric.addStageLatency(
+                nginxAttachmentMetric::inspectionStage::TRANSACTION,
+                opaque.getProcessingTime()
+            );
+        }
+
         opaque.deactivateContext();
         if (is_final_verdict) {
             removeTransactionEntry(cur_session_id);
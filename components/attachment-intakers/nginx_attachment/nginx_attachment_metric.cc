@@ -16,34 +16,19 @@
 USE_DEBUG_FLAG(D_METRICS_NGINX_ATTACHMENT);
 
 void
-nginxAttachmentEvent::resetAllCounters()
-{
-    successfull_registrations_counter = 0;
-    failed_registrations_counter = 0;
-    failed_connections_counter = 0;
-    accept_verdict_counter = 0;
-    inspect_verdict_counter = 0;
-    drop_verdict_counter = 0;
-    inject_verdict_counter = 0;
-    irrelevant_verdict_counter = 0;
-    reconf_verdict_counter = 0;
-    wait_verdict_counter = 0;
-}
-
-void
-nginxAttachmentEvent::addNetworkingCounter(networkVerdict _verdict)
+nginxAttachmentMetric::addNetworkingCounter(networkVerdict _verdict)
 {
     switch (_verdict) {
         case networkVerdict::REGISTRATION_SUCCESS: {
-            successfull_registrations_counter += 1;
+            successfull_registrations.report(1);
             break;
         }
         case networkVerdict::REGISTRATION_FAIL: {
-            failed_registrations_counter += 1;
+            failed_registrations.report(1);
             break;
         }
         case networkVerdict::CONNECTION_FAIL: {
-            failed_connections_counter += 1;
+            failed_connections.report(1);
             break;
         }
         default:
@@ -53,35 +38,35 @@ nginxAttachmentEvent::addNetworkingCounter(networkVerdict _verdict)
 }
 
 void
-nginxAttachmentEvent::addTrafficVerdictCounter(trafficVerdict _verdict)
+nginxAttachmentMetric::addTrafficVerdictCounter(trafficVerdict _verdict)
 {
     switch (_verdict) {
         case trafficVerdict::INSPECT: {
-            inspect_verdict_counter += 1;
+            inspect_verdict.report(1);
             break;
         }
         case trafficVerdict::ACCEPT: {
-            accept_verdict_counter += 1;
+            accept_verdict.report(1);
             break;
         }
         case trafficVerdict::DROP: {
-            drop_verdict_counter += 1;
+            drop_verdict.report(1);
             break;
         }
         case trafficVerdict::INJECT: {
-            inject_verdict_counter += 1;
+            inject_verdict.report(1);
             break;
         }
         case trafficVerdict::IRRELEVANT: {
-            irrelevant_verdict_counter += 1;
+            irrelevant_verdict.report(1);
             break;
         }
         case trafficVerdict::RECONF: {
-            reconf_verdict_counter += 1;
+            reconf_verdict.report(1);
             break;
         }
         case trafficVerdict::WAIT: {
-            wait_verdict_counter += 1;
+            // Wait verdicts are not part of the metric's report
             break;
         }
 
@@ -92,72 +77,35 @@ nginxAttachmentEvent::addTrafficVerdictCounter(trafficVerdict _verdict)
 }
 
 void
-nginxAttachmentEvent::addResponseInspectionCounter(uint64_t _counter)
+nginxAttachmentMetric::addResponseInspectionCounter(uint64_t _counter)
 {
-    response_inspection_counter += _counter;
+    response_inspection.report(_counter);
 }
 
-uint64_t
-nginxAttachmentEvent::getNetworkingCounter(networkVerdict _verdict) const
-{
-    switch (_verdict) {
-        case networkVerdict::REGISTRATION_SUCCESS:
-            return successfull_registrations_counter;
-        case networkVerdict::REGISTRATION_FAIL:
-            return failed_registrations_counter;
-        case networkVerdict::CONNECTION_FAIL:
-            return failed_connections_counter;
-        default:
-            dbgWarning(D_METRICS_NGINX_ATTACHMENT) << "Unsupported metric type. Type: " << static_cast<int>(_verdict);
-            return 0;
-    }
-}
-
-uint64_t
-nginxAttachmentEvent::getTrafficVerdictCounter(trafficVerdict _verdict) const
+void
+nginxAttachmentMetric::addStageLatency(inspectionStage _stage, std::chrono::microseconds _latency)
 {
-    switch (_verdict) {
-        case trafficVerdict::INSPECT:
-            return inspect_verdict_counter;
-        case trafficVerdict::ACCEPT:
-            return accept_verdict_counter;
-        case trafficVerdict::DROP:
-            return drop_verdict_counter;
-        case trafficVerdict::INJECT:
-            return inject_verdict_counter;
-        case trafficVerdict::IRRELEVANT:
-            return irrelevant_verdict_counter;
-        case trafficVerdict::RECONF:
-            return reconf_verdict_counter;
-        case trafficVerdict::WAIT:
-            return wait_verdict_counter;
+    switch (_stage) {
+        case inspectionStage::ATTACHMENT_READ: {
+            attachment_read_latency.report(_latency);
+            break;
+        }
+        case inspectionStage::HEADER_PARSE: {
+            header_parse_latency.report(_latency);
+            break;
+        }
+        case inspectionStage::VERDICT_WRITE: {
+            verdict_write_latency.report(_latency);
+            break;
+        }
+        case inspectionStage::TRANSACTION: {
+            transaction_latency.report(_latency);
+            break;
+        }
         default:
-            dbgWarning(D_METRICS_NGINX_ATTACHMENT) << "Unsupported metric type. Type: " << static_cast<int>(_verdict);
-            return 0;
+            dbgWarning(D_METRICS_NGINX_ATTACHMENT)
+                << "Unsupported inspection stage. Stage: "
+                << static_cast<int>(_stage);
+            return;
     }
 }
-
-uint64_t
-nginxAttachmentEvent::getResponseInspectionCounter() const
-{
-    return response_inspection_counter;
-}
-
-void
-nginxAttachmentMetric::upon(const nginxAttachmentEvent &event)
-{
-    successfull_registrations.report(
-        event.getNetworkingCounter(nginxAttachmentEvent::networkVerdict::REGISTRATION_SUCCESS)
-    );
-    failed_registrations.report(
-        event.getNetworkingCounter(nginxAttachmentEvent::networkVerdict::REGISTRATION_FAIL)
-    );
-    failed_connections.report(event.getNetworkingCounter(nginxAttachmentEvent::networkVerdict::CONNECTION_FAIL));
-    inspect_verdict.report(event.getTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::INSPECT));
-    accept_verdict.report(event.getTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::ACCEPT));
-    drop_verdict.report(event.getTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::DROP));
-    inject_verdict.report(event.getTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::INJECT));
-    irrelevant_verdict.report(event.getTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::IRRELEVANT));
-    reconf_verdict.report(event.getTrafficVerdictCounter(nginxAttachmentEvent::trafficVerdict::RECONF));
-    response_inspection.report(event.getResponseInspectionCounter());
-}
@@ -66,7 +66,6 @@ NginxAttachmentOpaque::NginxAttachmentOpaque(HttpTransactionData _transaction_da
     ctx.registerValue<IPAddr>(HttpTransactionData::listening_ip_ctx, transaction_data.getListeningIP());
     ctx.registerValue<IPAddr>(HttpTransactionData::client_ip_ctx, transaction_data.getSourceIP());
     ctx.registerValue<uint16_t>(HttpTransactionData::client_port_ctx, transaction_data.getSourcePort());
-    ctx.registerFunc<string>(HttpTransactionData::source_identifier, [this](){ return source_identifier; });
 
     ctx.registerQuickAccessValue<string>(HttpTransactionData::uri_ctx, transaction_data.getParsedURI());
     auto decoder = makeVirtualContainer<HexDecoder<'%'>>(transaction_data.getURI());
@@ -113,6 +112,8 @@ NginxAttachmentOpaque::setSourceIdentifier(const string &header_key, const strin
 {
     identifier_type = header_key;
     source_identifier = new_source_identifier;
+    // Registered as a value rather than a function, so a change of the identifier changes the context's revision
+    ctx.registerValue<string>(HttpTransactionData::source_identifier, source_identifier);
 }
 
 const string &
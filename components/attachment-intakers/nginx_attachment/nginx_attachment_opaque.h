@@ -17,6 +17,7 @@
 #include <string>
 #include <set>
 #include <map>
+#include <chrono>
 
 #include "compression_utils.h"
 #include "generic_rulebase/generic_rulebase_context.h"
@@ -85,6 +86,9 @@ public:
         EnvKeyAttr::LogSection log_ctx = EnvKeyAttr::LogSection::NONE
     );
     void setApplicationState(const ApplicationState &app_state) { application_state = app_state; }
+    // The time the agent spent on the chunks of the transaction so far
+    void addProcessingTime(std::chrono::microseconds time) { processing_time += time; }
+    std::chrono::microseconds getProcessingTime() const { return processing_time; }
     bool setKeepAliveCtx(const std::string &hdr_key, const std::string &hdr_val);
 
 private:
@@ -99,6 +103,7 @@ private:
     std::string             identifier_type;
     std::map<std::string, std::string> saved_data;
     ApplicationState application_state = ApplicationState::UNKOWN;
+    std::chrono::microseconds processing_time{0};
 };
 
 #endif // __NGINX_ATTACHMENT_OPAQUE_H__
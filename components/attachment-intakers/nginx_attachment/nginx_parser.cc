@@ -81,8 +81,8 @@ genHeaderPart(const Buffer &raw_data, uint16_t &cur_pos)
     cur_pos += sizeof(uint16_t);
     if (cur_pos + part_len > raw_data.size()) return genError("Header data extends beyond current buffer");
 
-    const u_char *part_data = raw_data.data();
-    Buffer header_part(part_data + cur_pos, part_len, Buffer::MemoryType::VOLATILE);
+    // The part refers to the segments of the raw data, so multi-segment raw data isn't made contiguous
+    Buffer header_part = raw_data.getSubBuffer(cur_pos, cur_pos + part_len);
 
     cur_pos += part_len;
 
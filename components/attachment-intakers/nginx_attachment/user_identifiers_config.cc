@@ -162,27 +162,14 @@ UsersAllIdentifiersConfig::setJWTValuesToOpaqueCtx(const HttpHeader &header) con
         dbgTrace(D_NGINX_ATTACHMENT_PARSER) << "Invalid JWT header, 'Bearer' prefix missing";
         return;
     }
-    int start_dot = -1;
-    int end_dot = -1;
-    for (uint i = 0 ; i < header.getValue().size() ; i++) {
-        if (header.getValue()[i] == '.') {
-            if (start_dot < 0) {
-                start_dot = i;
-            } else if (end_dot < 0) {
-                end_dot = i;
-            }
-        }
-    }
-    if (start_dot < 0 || end_dot < 0) {
+    auto start_dot = header.getValue().findFirstOf('.');
+    auto end_dot = start_dot.ok() ? header.getValue().findFirstOf('.', *start_dot + 1) : start_dot;
+    if (!end_dot.ok()) {
         dbgTrace(D_NGINX_ATTACHMENT_PARSER) << "The header does not contain dots";
         return;
     }
 
-    string jwt_str(
-        reinterpret_cast<const char *>(header.getValue().data()),
-        start_dot + 1,
-        end_dot - start_dot - 1
-    );
+    string jwt_str = header.getValue().getSubBuffer(*start_dot + 1, *end_dot);
     I_Encryptor *encryptor = Singleton::Consume<I_Encryptor>::by<NginxParser>();
     auto decoded_jwt = encryptor->base64Decode(jwt_str);
     dbgDebug(D_NGINX_ATTACHMENT_PARSER) << "Base64 decoded JWT: " << decoded_jwt;
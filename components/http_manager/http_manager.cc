@@ -24,6 +24,8 @@
 #include "common.h"
 #include "config.h"
 #include "http_manager_opaque.h"
+#include "http_manager_metric.h"
+#include "generic_rulebase/rulebase_config.h"
 #include "log_generator.h"
 #include "http_inspection_events.h"
 #include "agent_core_utilities.h"
@@ -68,10 +70,21 @@ public:
 
         Singleton::Consume<I_Logging>::by<HttpManager>()->addGeneralModifier(compressAppSecLogs);
         custom_header = getProfileAgentSettingWithDefault<string>("", "agent.customHeaderValueLogging");
+        skip_apps_after_drop = getProfileAgentSettingWithDefault<bool>(false, "agent.httpManager.skipAppsAfterDrop");
+
+        http_manager_metric.init(
+            "HTTP Manager data",
+            ReportIS::AudienceTeam::AGENT_CORE,
+            ReportIS::IssuingEngine::AGENT_CORE,
+            chrono::minutes(10),
+            true
+        );
 
         registerConfigLoadCb(
             [this]() {
                 custom_header = getProfileAgentSettingWithDefault<string>("", "agent.customHeaderValueLogging");
+                skip_apps_after_drop =
+                    getProfileAgentSettingWithDefault<bool>(false, "agent.httpManager.skipAppsAfterDrop");
             }
     );
     }
@@ -87,7 +100,14 @@ public:
         ScopedContext ctx;
         ctx.registerValue(app_sec_marker_key, i_transaction_table->keyToString(), EnvKeyAttr::LogSection::MARKER);
 
-        return handleEvent(NewHttpTransactionEvent(event).performNamedQuery());
+        // The asset is resolved once, so the cost of the transaction is accounted to it without further lookups
+        const auto &rule_by_ctx = getConfigurationWithCache<BasicRuleConfig>("rulebase", "rulesConfig");
+        if (rule_by_ctx.ok()) {
+            i_transaction_table->getState<HttpManagerOpaque>().setAssetId(rule_by_ctx.unpack().getAssetId());
+        }
+
+        NewHttpTransactionEvent(event).dispatch(event_responds);
+        return handleEvent(event_responds);
     }
 
     FilterVerdict
@@ -118,10 +138,12 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
-        auto event_responds =
-            is_request ?
-            HttpRequestHeaderEvent(event).performNamedQuery() :
-            HttpResponseHeaderEvent(event).performNamedQuery();
+        state.addInspectedBytes(event.getKey().size() + event.getValue().size());
+        if (is_request) {
+            dispatchChunk(HttpRequestHeaderEvent(event));
+        } else {
+            dispatchChunk(HttpResponseHeaderEvent(event));
+        }
         FilterVerdict verdict = handleEvent(event_responds);
         if (verdict.getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_INJECT) {
             applyInjectionModifications(verdict, event_responds, event.getHeaderIndex());
@@ -156,10 +178,12 @@ public:
             return verdict;
         }
 
-        auto event_responds =
-            is_request ?
-            HttpRequestBodyEvent(event, state.getPreviousDataCache()).performNamedQuery() :
-            HttpResponseBodyEvent(event, state.getPreviousDataCache()).performNamedQuery();
+        state.addInspectedBytes(event.getData().size());
+        if (is_request) {
+            dispatchChunk(HttpRequestBodyEvent(event, state.getPreviousDataCache()));
+        } else {
+            dispatchChunk(HttpResponseBodyEvent(event, state.getPreviousDataCache()));
+        }
         verdict = handleEvent(event_responds);
         state.saveCurrentDataToCache(event.getData());
         if (verdict.getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_INJECT) {
@@ -184,7 +208,8 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
-        return handleEvent(ResponseCodeEvent(event).performNamedQuery());
+        ResponseCodeEvent(event).dispatch(event_responds);
+        return handleEvent(event_responds);
     }
 
     FilterVerdict
@@ -203,7 +228,8 @@ public:
         if (state.getUserDefinedValue().ok()) {
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
-        return handleEvent(EndRequestEvent().performNamedQuery());
+        EndRequestEvent().dispatch(event_responds);
+        return handleEvent(event_responds);
     }
 
     FilterVerdict
@@ -223,7 +249,10 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
-        return handleEvent(EndTransactionEvent().performNamedQuery());
+        EndTransactionEvent().dispatch(event_responds);
+        FilterVerdict verdict = handleEvent(event_responds);
+        reportInspectionCost(state);
+        return verdict;
     }
 
     FilterVerdict
@@ -242,7 +271,8 @@ public:
             ctx.registerValue("UserDefined", state.getUserDefinedValue().unpack(), EnvKeyAttr::LogSection::DATA);
         }
 
-        return handleEvent(WaitTransactionEvent().performNamedQuery());
+        WaitTransactionEvent().dispatch(event_responds);
+        return handleEvent(event_responds);
     }
 
     void
@@ -258,6 +288,23 @@ public:
     }
 
 private:
+    // In the short-circuit mode, once an app drops the chunk the remaining (heavier) apps are not asked about it.
+    // They still learn that the transaction was dropped from the "SecurityAppsDropEvent" that follows.
+    template <typename ChunkEvent>
+    void
+    dispatchChunk(const ChunkEvent &event)
+    {
+        if (!skip_apps_after_drop) {
+            event.dispatch(event_responds);
+            return;
+        }
+
+        event.dispatch(
+            event_responds,
+            [] (const EventVerdict &verdict) { return verdict.getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_DROP; }
+        );
+    }
+
     ServiceVerdict
     handleBodySizeLimit(bool is_request_body_type, const HttpBody &event)
     {
@@ -297,53 +344,58 @@ private:
     static void
     applyInjectionModifications(
         FilterVerdict &verdict,
-        const vector<pair<string, EventVerdict>> &event_responds,
+        const vector<ListenerResponse<EventVerdict>> &event_responds,
         ModifiedChunkIndex event_idx)
     {
-        for (const pair<string, EventVerdict> &respond : event_responds) {
-            if (respond.second.getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_INJECT) {
+        for (const auto &respond : event_responds) {
+            if (respond.getResponse().getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_INJECT) {
                 dbgTrace(D_HTTP_MANAGER)
                     << "Applying inject verdict modifications for security App: "
-                    << respond.first;
-                verdict.addModifications(respond.second.getModifications(), event_idx);
+                    << respond.getListenerName();
+                verdict.addModifications(respond.getResponse().getModifications(), event_idx);
             }
         }
     }
 
     FilterVerdict
-    handleEvent(const vector<pair<string, EventVerdict>> &event_responds)
+    handleEvent(const vector<ListenerResponse<EventVerdict>> &event_responds)
     {
         HttpManagerOpaque &state = i_transaction_table->getState<HttpManagerOpaque>();
+        http_manager_metric.reportRespondTimes(event_responds);
+        state.addInspectionTimes(event_responds);
 
-        for (const pair<string, EventVerdict> &respond : event_responds) {
-            if (state.getApplicationsVerdict(respond.first) == ServiceVerdict::TRAFFIC_VERDICT_ACCEPT) {
+        for (const auto &respond : event_responds) {
+            const string &app_name = respond.getListenerName();
+            const EventVerdict &app_verdict = respond.getResponse();
+            if (state.getApplicationsVerdict(app_name) == ServiceVerdict::TRAFFIC_VERDICT_ACCEPT) {
                 dbgTrace(D_HTTP_MANAGER)
                     << "Skipping event verdict for app that already accepted traffic. App: "
-                    << respond.first;
+                    << app_name;
                 continue;
             }
 
             dbgTrace(D_HTTP_MANAGER)
                 << "Security app "
-                << respond.first
+                << app_name
                 << " returned verdict "
-                << respond.second.getVerdict();
+                << app_verdict.getVerdict();
 
-            state.setApplicationVerdict(respond.first, respond.second.getVerdict());
-            state.setApplicationWebResponse(respond.first, respond.second.getWebUserResponseByPractice());
-            if (respond.second.getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_CUSTOM_RESPONSE) {
-                if (!respond.second.getCustomResponse().ok()) {
+            state.setApplicationVerdict(app_name, app_verdict.getVerdict());
+            state.setApplicationWebResponse(app_name, app_verdict.getWebUserResponseByPractice());
+            if (app_verdict.getVerdict() == ServiceVerdict::TRAFFIC_VERDICT_CUSTOM_RESPONSE) {
+                if (!app_verdict.getCustomResponse().ok()) {
                     dbgWarning(D_HTTP_MANAGER)
                         << "Security app: "
-                        << respond.first
+                        << app_name
                         << ", returned verdict CUSTOM_RESPONSE, but no custom response was found.";
                     continue;
                 }
-                state.setCustomResponse(respond.first, respond.second.getCustomResponse().unpack());
+                state.setCustomResponse(app_name, app_verdict.getCustomResponse().unpack());
             }
         }
         auto ver = state.getCurrVerdict();
         dbgTrace(D_HTTP_MANAGER) << "Aggregated verdict is: " << ver;
+        if (isFinalVerdict(ver)) reportInspectionCost(state);
         if (ver == ServiceVerdict::TRAFFIC_VERDICT_CUSTOM_RESPONSE) {
             if (!state.getCurrentCustomResponse().ok()) {
                 dbgWarning(D_HTTP_MANAGER) << "No custom response found for verdict CUSTOM_RESPONSE";
@@ -359,6 +411,24 @@ private:
         }
     }
 
+    static bool
+    isFinalVerdict(ServiceVerdict verdict)
+    {
+        return
+            verdict == ServiceVerdict::TRAFFIC_VERDICT_ACCEPT ||
+            verdict == ServiceVerdict::TRAFFIC_VERDICT_DROP ||
+            verdict == ServiceVerdict::TRAFFIC_VERDICT_CUSTOM_RESPONSE ||
+            verdict == ServiceVerdict::TRAFFIC_VERDICT_IRRELEVANT;
+    }
+
+    void
+    reportInspectionCost(HttpManagerOpaque &state)
+    {
+        if (state.isInspectionCostReported()) return;
+        state.setInspectionCostReported();
+        http_manager_metric.reportInspectionCost(state);
+    }
+
     static void
     compressAppSecLogs(LogBulkRest &bulk)
     {
@@ -428,6 +498,10 @@ private:
 
     I_Table *i_transaction_table;
     string custom_header = "";
+    bool skip_apps_after_drop = false;
+    // Reused by all inspections, so the responses of the security apps don't allocate memory on every event
+    vector<ListenerResponse<EventVerdict>> event_responds;
+    HttpManagerMetric http_manager_metric;
     static const ServiceVerdict default_verdict;
     static const string app_sec_marker_key;
 };
@@ -0,0 +1,86 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __HTTP_MANAGER_METRIC_H__
+#define __HTTP_MANAGER_METRIC_H__
+
+#include <string>
+#include <vector>
+
+#include "generic_metric.h"
+#include "http_inspection_events.h"
+#include "http_manager_opaque.h"
+
+// The latency of every security app, as measured while the HTTP manager dispatches the transaction's events to them,
+// and the cost of the inspection of every asset: the time its transactions took every app, the bytes and the
+// transactions that were inspected.
+class HttpManagerMetric : public GenericMetric
+{
+public:
+    void
+    reportRespondTimes(const std::vector<ListenerResponse<EventVerdict>> &responses)
+    {
+        for (const auto &response : responses) {
+            app_latency.report(response.getListenerName(), response.getRespondTime());
+        }
+    }
+
+    void
+    reportInspectionCost(const HttpManagerOpaque &state)
+    {
+        const std::string &asset_id = state.getAssetId();
+        if (asset_id.empty()) return;
+
+        asset_transactions.report(asset_id, 1);
+        asset_inspected_bytes.report(asset_id, state.getInspectedBytes());
+        for (const auto &app_time : state.getInspectionTimes()) {
+            asset_inspection_time.report(asset_id, *app_time.first, app_time.second.count());
+        }
+    }
+
+private:
+    MetricCalculations::MetricMap<std::string, MetricCalculations::LatencyHistogram> app_latency{
+        MetricCalculations::LatencyHistogram(nullptr, "", "microseconds"_unit),
+        this,
+        "securityApp",
+        "securityAppLatencyMicroSecondsSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> asset_transactions{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "assetId",
+        "assetTransactionsSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> asset_inspected_bytes{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "assetId",
+        "assetInspectedBytesSample"
+    };
+    MetricCalculations::MetricMap<
+        std::string,
+        MetricCalculations::MetricMap<std::string, MetricCalculations::Counter>
+    > asset_inspection_time{
+        MetricCalculations::MetricMap<std::string, MetricCalculations::Counter>(
+            MetricCalculations::Counter(nullptr, ""),
+            nullptr,
+            "securityApp",
+            ""
+        ),
+        this,
+        "assetId",
+        "assetInspectionTimeMicroSecondsSample"
+    };
+};
+
+#endif // __HTTP_MANAGER_METRIC_H__
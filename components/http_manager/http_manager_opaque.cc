@@ -13,6 +13,8 @@
 
 #include "http_manager_opaque.h"
 
+#include <algorithm>
+
 #include "config.h"
 
 using namespace std;
@@ -48,6 +50,24 @@ HttpManagerOpaque::setCustomResponse(const std::string &app_name, const CustomRe
     current_custom_response = custom_response;
 }
 
+void
+HttpManagerOpaque::addInspectionTimes(const vector<ListenerResponse<EventVerdict>> &responses)
+{
+    for (const auto &response : responses) {
+        const string *app_name = &response.getListenerName();
+        auto app_time = find_if(
+            inspection_times.begin(),
+            inspection_times.end(),
+            [app_name] (const pair<const string *, chrono::microseconds> &time) { return *time.first == *app_name; }
+        );
+        if (app_time == inspection_times.end()) {
+            inspection_times.emplace_back(app_name, response.getRespondTime());
+        } else {
+            app_time->second += response.getRespondTime();
+        }
+    }
+}
+
 ServiceVerdict
 HttpManagerOpaque::getApplicationsVerdict(const string &app_name) const
 {
@@ -15,6 +15,8 @@
 #define __HTTP_MANAGER_OPAQUE_H__
 
 #include <unordered_map>
+#include <vector>
+#include <chrono>
 
 #include "buffer.h"
 #include "table_opaque.h"
@@ -46,6 +48,20 @@ public:
     void updatePayloadSize(const uint curr_payload);
     void resetPayloadSize() { aggregated_payload_size = 0; }
 
+    // The cost of inspecting the transaction is gathered here, and is reported once the transaction has a final verdict
+    void setAssetId(const std::string &id) { asset_id = id; }
+    const std::string & getAssetId() const { return asset_id; }
+    void addInspectedBytes(uint64_t bytes) { inspected_bytes += bytes; }
+    uint64_t getInspectedBytes() const { return inspected_bytes; }
+    void addInspectionTimes(const std::vector<ListenerResponse<EventVerdict>> &responses);
+    const std::vector<std::pair<const std::string *, std::chrono::microseconds>> &
+    getInspectionTimes() const
+    {
+        return inspection_times;
+    }
+    bool isInspectionCostReported() const { return is_inspection_cost_reported; }
+    void setInspectionCostReported() { is_inspection_cost_reported = true; }
+
 // LCOV_EXCL_START - sync functions, can only be tested once the sync module exists
     template <typename T> void serialize(T &ar, uint) { ar(applications_verdicts, prev_data_cache); }
     static std::unique_ptr<TableOpaqueBase> prototype() { return std::make_unique<HttpManagerOpaque>(); }
@@ -64,6 +80,11 @@ private:
     uint aggregated_payload_size = 0;
     Maybe<CustomResponse> current_custom_response = genError("uninitialized");
     Maybe<std::string> user_defined_value = genError("uninitialized");
+    std::string asset_id;
+    uint64_t inspected_bytes = 0;
+    // The names of the apps are kept by the dispatch tables of the events, so they outlive the transaction
+    std::vector<std::pair<const std::string *, std::chrono::microseconds>> inspection_times;
+    bool is_inspection_cost_reported = false;
 };
 
 #endif // __HTTP_MANAGER_OPAQUE_H__
@@ -22,6 +22,10 @@
 
 using ResponseCode = uint16_t;
 
+// Security apps that run a deep inspection of the traffic are dispatched after the lighter ones, so a transaction
+// that one of the lighter apps already dropped can skip them
+static const uint heavy_http_inspection_priority = 100;
+
 class HttpRequestHeaderEvent : public Event<HttpRequestHeaderEvent, EventVerdict>
 {
 public:
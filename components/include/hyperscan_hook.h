@@ -12,29 +12,42 @@
 #define __HYPERSCAN_HOOK_H__
 
 #ifdef USE_HYPERSCAN
-#include <vector>
+
 #include <string>
+#include <vector>
+#include <sys/types.h>
 
-#include <set>
 #include "hs.h"
 #include "i_pm_scan.h"
 
-class HyperscanHook : public I_PMScan {
+// Literal pattern matcher backed by a Hyperscan block-mode database.
+// Follows the same I_PMScan contract as PMHook, so the two can be swapped by PMScanFactory.
+class HyperscanHook final : public I_PMScan
+{
 public:
     HyperscanHook();
     ~HyperscanHook();
+
+    HyperscanHook(const HyperscanHook &) = delete;
+    HyperscanHook & operator=(const HyperscanHook &) = delete;
+
     Maybe<void> prepare(const std::set<PMPattern> &patterns);
     std::set<PMPattern> scanBuf(const Buffer &buf) const override;
     std::set<std::pair<uint, uint>> scanBufWithOffset(const Buffer &buf) const override;
     void scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) const override;
+
     bool ok() const { return m_hsReady; }
+
 private:
+    void collectMatches(const Buffer &buf, std::vector<std::pair<uint, uint>> &matches) const;
+
     hs_database_t *m_hsDatabase;
     hs_scratch_t *m_hsScratch;
+    bool m_hsReady;
     std::vector<std::string> m_hsPatterns;
     std::vector<PMPattern> m_idToPattern;
-    bool m_hsReady;
 };
+
 #endif // USE_HYPERSCAN
 
 #endif // __HYPERSCAN_HOOK_H__
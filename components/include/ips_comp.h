@@ -8,6 +8,7 @@
 #include "i_mainloop.h"
 #include "i_http_manager.h"
 #include "i_environment.h"
+#include "i_rest_api.h"
 #include "http_inspection_events.h"
 #include "component.h"
 
@@ -18,7 +19,8 @@ class IPSComp
     Singleton::Consume<I_Table>,
     Singleton::Consume<I_Environment>,
     Singleton::Consume<I_GenericRulebase>,
-    Singleton::Consume<I_MainLoop>
+    Singleton::Consume<I_MainLoop>,
+    Singleton::Consume<I_RestApi>
 {
 public:
     IPSComp();
@@ -14,9 +14,13 @@
 #ifndef __NGINX_ATTACHMENT_METRIC_H__
 #define __NGINX_ATTACHMENT_METRIC_H__
 
+#include <chrono>
+
 #include "generic_metric.h"
 
-class nginxAttachmentEvent : public Event<nginxAttachmentEvent>
+// The attachment counts its verdicts straight into the metric on the data path: the counters are sharded, so counting
+// doesn't go through an event and the counters are only summed when the metric is reported.
+class nginxAttachmentMetric : public GenericMetric
 {
 public:
     enum class networkVerdict {
@@ -35,7 +39,12 @@ public:
         WAIT
     };
 
-    void resetAllCounters();
+    enum class inspectionStage {
+        ATTACHMENT_READ,
+        HEADER_PARSE,
+        VERDICT_WRITE,
+        TRANSACTION
+    };
 
     void addNetworkingCounter(networkVerdict _verdict);
 
@@ -43,45 +52,40 @@ public:
 
     void addResponseInspectionCounter(uint64_t _counter);
 
-    uint64_t getNetworkingCounter(networkVerdict _verdict) const;
-
-    uint64_t getTrafficVerdictCounter(trafficVerdict _verdict) const;
-
-    uint64_t getResponseInspectionCounter() const;
-
-private:
-    uint64_t successfull_registrations_counter = 0;
-    uint64_t failed_registrations_counter = 0;
-    uint64_t failed_connections_counter = 0;
-    uint64_t accept_verdict_counter = 0;
-    uint64_t inspect_verdict_counter = 0;
-    uint64_t drop_verdict_counter = 0;
-    uint64_t inject_verdict_counter = 0;
-    uint64_t irrelevant_verdict_counter = 0;
-    uint64_t reconf_verdict_counter = 0;
-    uint64_t response_inspection_counter = 0;
-    uint64_t wait_verdict_counter = 0;
-};
-
-class nginxAttachmentMetric
-        :
-    public GenericMetric,
-    public Listener<nginxAttachmentEvent>
-{
-public:
-    void upon(const nginxAttachmentEvent &event) override;
+    // The latency histograms are not sharded, so they are only updated from the attachment's own routines
+    void addStageLatency(inspectionStage _stage, std::chrono::microseconds _latency);
 
 private:
-    MetricCalculations::Counter successfull_registrations{this, "successfullRegistrationsSum"};
-    MetricCalculations::Counter failed_registrations{this, "failedRegistrationsSum"};
-    MetricCalculations::Counter failed_connections{this, "failedConnectionsSum"};
-    MetricCalculations::Counter inspect_verdict{this, "inspectVerdictSum"};
-    MetricCalculations::Counter accept_verdict{this, "acceptVeridctSum"};
-    MetricCalculations::Counter drop_verdict{this, "dropVerdictSum"};
-    MetricCalculations::Counter inject_verdict{this, "injectVerdictSum"};
-    MetricCalculations::Counter irrelevant_verdict{this, "irrelevantVerdictSum"};
-    MetricCalculations::Counter reconf_verdict{this, "reconfVerdictSum"};
-    MetricCalculations::Counter response_inspection{this, "responseInspection"};
+    MetricCalculations::ShardedCounter successfull_registrations{this, "successfullRegistrationsSum"};
+    MetricCalculations::ShardedCounter failed_registrations{this, "failedRegistrationsSum"};
+    MetricCalculations::ShardedCounter failed_connections{this, "failedConnectionsSum"};
+    MetricCalculations::ShardedCounter inspect_verdict{this, "inspectVerdictSum"};
+    MetricCalculations::ShardedCounter accept_verdict{this, "acceptVeridctSum"};
+    MetricCalculations::ShardedCounter drop_verdict{this, "dropVerdictSum"};
+    MetricCalculations::ShardedCounter inject_verdict{this, "injectVerdictSum"};
+    MetricCalculations::ShardedCounter irrelevant_verdict{this, "irrelevantVerdictSum"};
+    MetricCalculations::ShardedCounter reconf_verdict{this, "reconfVerdictSum"};
+    MetricCalculations::ShardedCounter response_inspection{this, "responseInspection"};
+    MetricCalculations::LatencyHistogram attachment_read_latency{
+        this,
+        "attachmentReadLatencyMicroSecondsSample",
+        "microseconds"_unit
+    };
+    MetricCalculations::LatencyHistogram header_parse_latency{
+        this,
+        "headerParseLatencyMicroSecondsSample",
+        "microseconds"_unit
+    };
+    MetricCalculations::LatencyHistogram verdict_write_latency{
+        this,
+        "verdictWriteLatencyMicroSecondsSample",
+        "microseconds"_unit
+    };
+    MetricCalculations::LatencyHistogram transaction_latency{
+        this,
+        "transactionLatencyMicroSecondsSample",
+        "microseconds"_unit
+    };
 };
 
 #endif // __NGINX_ATTACHMENT_METRIC_H__
@@ -0,0 +1,129 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __PM_SCAN_FACTORY_H__
+#define __PM_SCAN_FACTORY_H__
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "i_pm_scan.h"
+#include "event.h"
+#include "generic_metric.h"
+
+enum class PMEngineType { AUTO, THIN_NFA, HYPERSCAN };
+
+std::ostream & operator<<(std::ostream &os, const PMEngineType &engine);
+
+// Builds an I_PMScan for a pattern set, choosing between the thin NFA (PMHook) and Hyperscan.
+// The returned scanner reports a PMScanEvent for a sample of its scans, so the per-engine cost of the scanners that
+// a component created can be tracked by the PMScanMetric of that component.
+class PMScanFactory
+{
+public:
+    // Pattern sets smaller than this are cheaper to compile and scan with the thin NFA
+    static const size_t hyperscan_min_patterns = 64;
+    static const uint default_scan_sample_rate = 128;
+
+    static Maybe<std::shared_ptr<I_PMScan>> create(
+        const std::set<PMPattern> &patterns,
+        PMEngineType requested = PMEngineType::THIN_NFA,
+        const std::string &consumer = ""
+    );
+
+    static PMEngineType selectEngine(const std::set<PMPattern> &patterns, PMEngineType requested);
+    static bool isHyperscanSupported();
+
+    // Accepts "auto", "thin_nfa" and "hyperscan" (the values of the "ips.patternMatcherEngine" and
+    // "waap.patternMatcherEngine" settings)
+    static Maybe<PMEngineType> engineFromString(const std::string &engine_name);
+    static const std::string & getEngineName(PMEngineType engine);
+
+    // Scanners created from now on measure one out of every `rate` scans, 0 turns the measurement off
+    static void setScanSampleRate(uint rate) { scan_sample_rate = rate; }
+    static uint getScanSampleRate() { return scan_sample_rate; }
+
+    // Takes the sample rate from the "patternMatcher.scanSampleRate" setting whenever the configuration is loaded.
+    // Every component that creates scanners calls it on init, and only the first call registers.
+    static void registerScanSampleRateSetting();
+
+private:
+    static uint scan_sample_rate;
+};
+
+class PMScanEvent : public Event<PMScanEvent>
+{
+public:
+    PMScanEvent(
+        const std::string &_consumer,
+        PMEngineType _engine,
+        size_t _bytes,
+        std::chrono::nanoseconds _duration)
+            :
+        consumer(_consumer),
+        engine(_engine),
+        bytes(_bytes),
+        duration(_duration)
+    {}
+
+    const std::string & getConsumer() const { return consumer; }
+    PMEngineType getEngine() const { return engine; }
+    size_t getBytes() const { return bytes; }
+    std::chrono::nanoseconds getDuration() const { return duration; }
+
+private:
+    const std::string &consumer;
+    PMEngineType engine;
+    size_t bytes;
+    std::chrono::nanoseconds duration;
+};
+
+// Owned by a component, and counts only the scans of the scanners that were created for it
+class PMScanMetric : public GenericMetric, public Listener<PMScanEvent>
+{
+public:
+    PMScanMetric(const std::string &_consumer) : consumer(_consumer) {}
+
+    void upon(const PMScanEvent &event) override;
+
+private:
+    std::string consumer;
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> scans{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "engine",
+        "pmScansSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> bytes_scanned{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "engine",
+        "pmBytesScannedSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> scan_time{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "engine",
+        "pmScanTimeMicroSecondsSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Max<uint64_t>> max_scan_time{
+        MetricCalculations::Max<uint64_t>(nullptr, "", 0),
+        this,
+        "engine",
+        "pmMaxScanTimeMicroSecondsSample"
+    };
+};
+
+#endif // __PM_SCAN_FACTORY_H__
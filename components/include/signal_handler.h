@@ -20,6 +20,7 @@
 #include "i_agent_details.h"
 #include "i_environment.h"
 #include "i_messaging.h"
+#include "i_rest_api.h"
 #include "i_signal_handler.h"
 #include "config/i_config.h"
 #include "component.h"
@@ -33,6 +34,7 @@ class SignalHandler
     Singleton::Consume<I_AgentDetails>,
     Singleton::Consume<I_Environment>,
     Singleton::Consume<I_Messaging>,
+    Singleton::Consume<I_RestApi>,
     Singleton::Consume<Config::I_Config>
 {
 public:
@@ -16,37 +16,17 @@
 
 #include "generic_metric.h"
 
-class TransactionTableEvent : public Event<TransactionTableEvent>
+// The size of the transaction table is sampled for every transaction, so it is reported to the metric directly rather
+// than through an event.
+class TransactionTableMetric : public GenericMetric
 {
 public:
     void
-    setTransactionTableSize(uint64_t _value)
+    reportTransactionTableSize(uint64_t transaction_table_size)
     {
-        transaction_table_size = _value;
-    }
-
-    uint64_t
-    getTransactionTableSize() const
-    {
-        return transaction_table_size;
-    }
-
-private:
-    uint64_t transaction_table_size = 0;
-};
-
-class TransactionTableMetric
-        :
-    public GenericMetric,
-    public Listener<TransactionTableEvent>
-{
-public:
-    void
-    upon(const TransactionTableEvent &event) override
-    {
-        max_transaction_table_size.report(event.getTransactionTableSize());
-        avg_transaction_table_size.report(event.getTransactionTableSize());
-        last_report_transaction_handler_size.report(event.getTransactionTableSize());
+        max_transaction_table_size.report(transaction_table_size);
+        avg_transaction_table_size.report(transaction_table_size);
+        last_report_transaction_handler_size.report(transaction_table_size);
     }
 
 private:
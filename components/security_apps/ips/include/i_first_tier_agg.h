@@ -5,12 +5,14 @@
 #include <set>
 #include <string>
 
-#include "pm_hook.h"
+#include "i_pm_scan.h"
 
 class I_FirstTierAgg
 {
 public:
-    virtual std::shared_ptr<PMHook> getHook(const std::string &context_name, const std::set<PMPattern> &patterns) = 0;
+    // The scanner is shared by all the signatures of the context, and is rebuilt as they add their patterns.
+    // When their patterns cannot be compiled it matches nothing, so nothing passes the first tier.
+    virtual std::shared_ptr<I_PMScan> getHook(const std::string &context_name, const std::set<PMPattern> &patterns) = 0;
 
 protected:
     virtual ~I_FirstTierAgg() {}
@@ -1,6 +1,9 @@
 #ifndef __IPS_CONFIGURATION_H__
 #define __IPS_CONFIGURATION_H__
 
+#include <memory>
+#include <set>
+
 #include "config.h"
 
 class IPSConfiguration
@@ -22,15 +25,20 @@ public:
     };
 
     IPSConfiguration() {}
-    IPSConfiguration(const std::map<std::string, Context> &initial_conf) : context_config(initial_conf) {}
+    IPSConfiguration(const std::map<std::string, Context> &initial_conf);
 
     void load(cereal::JSONInputArchive &ar);
 
     Context getContext(const std::string &name) const;
     uint getHistorySize(const std::string &name) const;
+    // The contexts that are kept for later contexts, resolved when the configuration is loaded
+    const std::shared_ptr<const std::set<std::string>> & getKeptContexts() const { return kept_contexts; }
 
 private:
+    void setKeptContexts();
+
     std::map<std::string, Context> context_config;
+    std::shared_ptr<const std::set<std::string>> kept_contexts = std::make_shared<std::set<std::string>>();
 };
 
 #endif // __IPS_CONFIGURATION_H__
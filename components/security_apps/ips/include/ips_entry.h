@@ -2,12 +2,14 @@
 #define __IPS_ENTRY_H__
 
 #include <map>
+#include <memory>
 #include <set>
 
 #include "table_opaque.h"
 #include "parsed_context.h"
 #include "buffer.h"
 #include "context.h"
+#include "ips_configuration.h"
 
 class IPSEntry : public TableOpaqueSerialize<IPSEntry>, public Listener<ParsedContext>
 {
@@ -32,6 +34,13 @@ public:
     void unsetFlag(const std::string &flag) { flags.erase(flag); }
     bool isFlagSet(const std::string &flag) const { return flags.count(flag) != 0; }
 
+    // The contexts that the signatures of the asset inspect, and the ones kept (after they are inspected) so later
+    // contexts can refer to them, are taken from the policy once per transaction
+    bool isContextInspected(const std::string &name);
+    bool isContextNeeded(const std::string &name);
+    // Keeps a context that no signature inspects, so later contexts can still refer to it
+    void keepContext(const std::string &name, const Buffer &buffer);
+
     Buffer getBuffer(const std::string &name) const;
     void setTransactionData(const Buffer &key, const Buffer &value);
     Maybe<Buffer> getTransactionData(const Buffer &key) const;
@@ -44,6 +53,9 @@ public:
     bool isDrop() const { return is_drop; }
 
 private:
+    void resolveContexts();
+    void storeContext(const std::string &name, Buffer &buf, const IPSConfiguration::Context &config);
+
     std::map<std::string, Buffer> past_contexts;
     std::set<std::string> flags;
     Context ctx;
@@ -51,6 +63,9 @@ private:
     std::vector<std::pair<std::string, Buffer>> pending_contexts;
 
     bool is_drop = false;
+    std::shared_ptr<const std::set<std::string>> ips_contexts;
+    std::shared_ptr<const std::set<std::string>> snort_contexts;
+    std::shared_ptr<const std::set<std::string>> kept_contexts;
 };
 
 #endif // __IPS_ENTRY_H__
@@ -0,0 +1,124 @@
+#ifndef __IPS_SIGNATURE_PROFILER_H__
+#define __IPS_SIGNATURE_PROFILER_H__
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "event.h"
+#include "generic_metric.h"
+#include "singleton.h"
+
+namespace IPSSignatureSubTypes
+{
+
+class SignatureEvaluationEvent : public Event<SignatureEvaluationEvent>
+{
+public:
+    SignatureEvaluationEvent(const std::string &name, std::chrono::nanoseconds _cost, bool _is_matched)
+            :
+        signature_name(name),
+        cost(_cost),
+        is_matched(_is_matched)
+    {}
+
+    const std::string & getSignatureName() const { return signature_name; }
+    std::chrono::nanoseconds getCost() const { return cost; }
+    bool isMatched() const { return is_matched; }
+
+private:
+    std::string signature_name;
+    std::chrono::nanoseconds cost;
+    bool is_matched;
+};
+
+class I_SignatureProfiler
+{
+public:
+    // Whether the next signature evaluation should be measured and reported with a SignatureEvaluationEvent
+    virtual bool shouldSample() = 0;
+
+protected:
+    virtual ~I_SignatureProfiler() {}
+};
+
+// Samples the CPU time spent evaluating individual signatures.
+// Sampling is off by default, and is turned on by setting "ips.signatureProfiler.sampleRate" to N,
+// which measures one out of every N signature evaluations on average. The gap between samples is random, so that
+// signatures are not skipped when the number of signatures evaluated per context shares a factor with N.
+// Only the costliest signatures are reported, and only the costliest max_tracked_signatures are tracked.
+class SignatureProfiler
+        :
+    public GenericMetric,
+    public Listener<SignatureEvaluationEvent>,
+    Singleton::Provide<I_SignatureProfiler>::SelfInterface
+{
+public:
+    static const uint max_tracked_signatures = 1000;
+
+    void setSampleRate(uint rate);
+    uint getSampleRate() const { return sample_rate; }
+    void setMaxReportedSignatures(uint max_signatures) { max_reported_signatures = max_signatures; }
+
+    bool
+    shouldSample() override
+    {
+        if (sample_rate == 0) return false;
+        if (--evaluations_to_skip > 0) return false;
+        evaluations_to_skip = getNextSkip();
+        return true;
+    }
+
+    void upon(const SignatureEvaluationEvent &event) override;
+
+    std::string getReport() const;
+    void clear() { costs.clear(); }
+
+protected:
+    void updateMetrics() override;
+
+private:
+    struct SignatureCost
+    {
+        uint64_t sampled_evaluations = 0;
+        uint64_t matches = 0;
+        std::chrono::nanoseconds total_time{0};
+        std::chrono::nanoseconds max_time{0};
+    };
+
+    uint getNextSkip();
+    SignatureCost & getCost(const std::string &signature_name);
+    std::vector<std::pair<std::string, SignatureCost>> getCostliestSignatures() const;
+
+    uint sample_rate = 0;
+    uint evaluations_to_skip = 0;
+    uint max_reported_signatures = 100;
+    std::minstd_rand generator{std::random_device{}()};
+    std::map<std::string, SignatureCost> costs;
+
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> sampled_evaluations{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "signature",
+        "ipsSignatureSampledEvaluationsSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> sampled_matches{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "signature",
+        "ipsSignatureSampledMatchesSample"
+    };
+    MetricCalculations::MetricMap<std::string, MetricCalculations::Counter> cpu_time{
+        MetricCalculations::Counter(nullptr, ""),
+        this,
+        "signature",
+        "ipsSignatureCpuTimeMicroSecondsSample"
+    };
+};
+
+} // IPSSignatureSubTypes
+
+#endif // __IPS_SIGNATURE_PROFILER_H__
@@ -18,6 +18,8 @@
 #ifndef __IPS_SIGNATURES_H__
 #define __IPS_SIGNATURES_H__
 
+#include <memory>
+#include <set>
 #include <vector>
 
 #include "config.h"
@@ -25,6 +27,7 @@
 #include "i_first_tier_agg.h"
 #include "ips_entry.h"
 #include "ips_enums.h"
+#include "ips_signature_profiler.h"
 #include "log_generator.h"
 #include "parsed_context.h"
 #include "pm_hook.h"
@@ -380,7 +383,12 @@ public:
     /// \brief Check if the signature is matched for prevention.
     /// \param context_buffer The context buffer.
     /// \param pattern The set of patterns to match.
-    bool isMatchedPrevent(const Buffer &context_buffer, const std::set<PMPattern> &pattern) const;
+    /// \param profiler The profiler that samples the evaluation, or nullptr when there is none.
+    bool isMatchedPrevent(
+        const Buffer &context_buffer,
+        const std::set<PMPattern> &pattern,
+        I_SignatureProfiler *profiler
+    ) const;
 
     /// \brief Check if the signature is matched silently.
     /// \param context_buffer The context buffer.
@@ -411,6 +419,11 @@ private:
     /// \param ips_state The IPS entry.
     ActionResults getAction(const IPSEntry &ips_state) const;
 
+    /// \brief Match the signature, measuring the evaluation cost when it is sampled by the profiler.
+    /// \param pattern The set of patterns found by the first tier.
+    /// \param profiler The profiler that samples the evaluation, or nullptr when there is none.
+    BaseSignature::MatchType getMatch(const std::set<PMPattern> &pattern, I_SignatureProfiler *profiler) const;
+
     void sendLog(
         const Buffer &context_buffer,
         const IPSEntry &ips_state,
@@ -431,7 +444,10 @@ private:
 
 /// \class IPSSignaturesPerContext
 /// \brief Represents IPS signatures per context.
-class IPSSignaturesPerContext : public Singleton::Consume<I_FirstTierAgg>
+class IPSSignaturesPerContext
+        :
+    public Singleton::Consume<I_FirstTierAgg>,
+    public Singleton::Consume<IPSSignatureSubTypes::I_SignatureProfiler>
 {
 public:
     /// \brief Add a signature to the context.
@@ -453,7 +469,7 @@ private:
 
     std::map<PMPattern, std::vector<IPSSignatureSubTypes::SignatureAndAction>> signatures_per_lss;
     std::vector<IPSSignatureSubTypes::SignatureAndAction> signatures_without_lss;
-    std::shared_ptr<PMHook> first_tier;
+    std::shared_ptr<I_PMScan> first_tier;
 };
 
 /// \class IPSSignaturesResource
@@ -563,6 +579,10 @@ public:
     /// \return True if the signatures for the context are empty, otherwise false.
     bool isEmpty(const std::string &context) const;
 
+    /// \brief Get the names of the contexts that the signatures inspect, resolved when the signatures are loaded.
+    /// \return The context names.
+    const std::shared_ptr<const std::set<std::string>> & getContexts() const { return contexts; }
+
     /// \brief Get the asset name.
     /// \return The asset name.
     const std::string &
@@ -605,6 +625,7 @@ public:
 
 private:
     std::map<std::string, IPSSignaturesPerContext> signatures_per_context;
+    std::shared_ptr<const std::set<std::string>> contexts = std::make_shared<std::set<std::string>>();
     std::string asset_name;
     std::string asset_id;
     std::string practice_name;
@@ -641,6 +662,10 @@ public:
     /// \return True if the signatures for the context are empty, otherwise false.
     bool isEmpty(const std::string &context) const;
 
+    /// \brief Get the names of the contexts that the signatures inspect, resolved when the signatures are loaded.
+    /// \return The context names.
+    const std::shared_ptr<const std::set<std::string>> & getContexts() const { return contexts; }
+
     /// \brief Get the asset name.
     /// \return The asset name.
     const std::string &
@@ -683,6 +708,7 @@ public:
 
 private:
     std::map<std::string, IPSSignaturesPerContext> signatures_per_context;
+    std::shared_ptr<const std::set<std::string>> contexts = std::make_shared<std::set<std::string>>();
     std::string asset_name;
     std::string asset_id;
     std::string practice_name;
@@ -8,6 +8,8 @@
 #include "ips_configuration.h"
 #include "ips_signatures.h"
 #include "ips_metric.h"
+#include "ips_signature_profiler.h"
+#include "pm_scan_factory.h"
 #include "generic_rulebase/parameters_config.h"
 #include "config.h"
 #include "virtual_modifiers.h"
@@ -32,6 +34,7 @@ static const string jsessionid("jsessionid");
 static const string xff("x-forwarded-for");
 static const string header("header");
 static const string source_ip("source ip");
+static const string pm_scan_consumer("ips");
 
 class IPSComp::Impl
         :
@@ -50,17 +53,54 @@ class IPSComp::Impl
     static constexpr auto ACCEPT = ServiceVerdict::TRAFFIC_VERDICT_ACCEPT;
     static constexpr auto INSPECT = ServiceVerdict::TRAFFIC_VERDICT_INSPECT;
 
+    // Every context that inspects the same buffer gets the same scanner object. When a context adds its patterns
+    // the compiled engine behind it is replaced, so only one engine per aggregation is kept alive.
+    class SharedPMScan : public I_PMScan
+    {
+    public:
+        void setEngine(shared_ptr<I_PMScan> &&new_engine) { engine = move(new_engine); }
+
+        set<PMPattern>
+        scanBuf(const Buffer &buf) const override
+        {
+            return engine != nullptr ? engine->scanBuf(buf) : set<PMPattern>();
+        }
+
+        set<pair<uint, uint>>
+        scanBufWithOffset(const Buffer &buf) const override
+        {
+            return engine != nullptr ? engine->scanBufWithOffset(buf) : set<pair<uint, uint>>();
+        }
+
+        void
+        scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) const override
+        {
+            if (engine != nullptr) engine->scanBufWithOffsetLambda(buf, cb);
+        }
+
+    private:
+        shared_ptr<I_PMScan> engine;
+    };
+
     class SigsFirstTierAgg
     {
     public:
-        const shared_ptr<PMHook> &
+        shared_ptr<I_PMScan>
         getHook(const set<PMPattern> &new_pat)
         {
             auto old_size = pats.size();
             pats.insert(new_pat.begin(), new_pat.end());
 
             if (pats.size() != old_size) {
-                if (!hook->prepare(pats).ok()) {
+                auto new_engine = PMScanFactory::create(pats, getEngineType(), pm_scan_consumer);
+                if (new_engine.ok()) {
+                    hook->setEngine(new_engine.unpackMove());
+                } else {
+                    // An engine without the new patterns would silently skip the signatures that added them
+                    dbgWarning(D_IPS)
+                        << "Failed to compile first tier, nothing will pass it. Error: "
+                        << new_engine.getErr();
+                    hook->setEngine(nullptr);
                     reportConfigurationError("failed to compile first tier");
                 }
             }
@@ -69,8 +109,18 @@ class IPSComp::Impl
         }
 
     private:
+        static PMEngineType
+        getEngineType()
+        {
+            auto engine_name = getProfileAgentSettingWithDefault<string>("thin_nfa", "ips.patternMatcherEngine");
+            auto engine = PMScanFactory::engineFromString(engine_name);
+            if (engine.ok()) return engine.unpack();
+            dbgWarning(D_IPS) << engine.getErr();
+            return PMEngineType::THIN_NFA;
+        }
+
         set<PMPattern> pats;
-        shared_ptr<PMHook> hook = make_shared<PMHook>();
+        shared_ptr<SharedPMScan> hook = make_shared<SharedPMScan>();
     };
 
 public:
@@ -95,16 +145,41 @@ public:
             ReportIS::Audience::SECURITY
         );
         ips_metric.registerListener();
+        pm_scan_metric.init(
+            "IPS Pattern Matcher Stats",
+            ReportIS::AudienceTeam::AGENT_CORE,
+            ReportIS::IssuingEngine::AGENT_CORE,
+            std::chrono::minutes(10),
+            true
+        );
+        pm_scan_metric.registerListener();
+        PMScanFactory::registerScanSampleRateSetting();
+        signature_profiler.init(
+            "IPS Signature Profile",
+            ReportIS::AudienceTeam::AGENT_CORE,
+            ReportIS::IssuingEngine::AGENT_CORE,
+            std::chrono::minutes(10),
+            true
+        );
+        signature_profiler.registerListener();
+        if (Singleton::exists<I_RestApi>()) {
+            Singleton::Consume<I_RestApi>::by<IPSComp>()->addGetCall(
+                "ips-signature-profile",
+                [&] () { return signature_profiler.getReport(); }
+            );
+        }
         registerListener();
         table = Singleton::Consume<I_Table>::by<IPSComp>();
         env = Singleton::Consume<I_Environment>::by<IPSComp>();
         updateSigsYieldCount();
+        updateSignatureProfiler();
     }
 
     void
     fini()
     {
         unregisterListener();
+        pm_scan_metric.unregisterListener();
     }
 
     void
@@ -117,6 +192,7 @@ public:
     }
 
     string getListenerName() const override { return "ips application"; }
+    uint getDispatchPriority() const override { return heavy_http_inspection_priority; }
 
     EventVerdict
     respond(const NewHttpTransactionEvent &event) override
@@ -128,10 +204,10 @@ public:
         auto leave_context = make_scope_exit([&ips_state] () { ips_state.uponLeavingContext(); });
 
         Buffer method(event.getHttpMethod());
-        ips_state.addPendingContext("HTTP_METHOD", method);
+        addPendingContext(ips_state, "HTTP_METHOD", method);
 
         Buffer uri(event.getURI());
-        ips_state.addPendingContext("HTTP_COMPLETE_URL_ENCODED", uri);
+        addPendingContext(ips_state, "HTTP_COMPLETE_URL_ENCODED", uri);
 
         auto decoder = makeVirtualContainer<HexDecoder<'%'>>(event.getURI());
         vector<u_char> decoded_url(decoder.begin(), decoder.end());
@@ -139,17 +215,19 @@ public:
 
         if (start != decoded_url.end()) {
             vector<u_char> query(start + 1, decoded_url.end());
-            ips_state.addPendingContext("HTTP_QUERY_DECODED", Buffer(move(query)));
+            addPendingContext(ips_state, "HTTP_QUERY_DECODED", Buffer(move(query)));
         }
         vector<u_char> path(decoded_url.begin(), start);
-        ips_state.addPendingContext("HTTP_PATH_DECODED", Buffer(move(path)));
-        ips_state.addPendingContext("HTTP_COMPLETE_URL_DECODED", Buffer(move(decoded_url)));
+        addPendingContext(ips_state, "HTTP_PATH_DECODED", Buffer(move(path)));
+        addPendingContext(ips_state, "HTTP_COMPLETE_URL_DECODED", Buffer(move(decoded_url)));
 
         Buffer protocol(event.getHttpProtocol());
-        ips_state.addPendingContext("HTTP_PROTOCOL", protocol);
+        addPendingContext(ips_state, "HTTP_PROTOCOL", protocol);
 
-        auto full_line = method + space + uri + space + protocol + line_sep;
-        ips_state.addPendingContext("HTTP_RAW", full_line);
+        if (ips_state.isContextNeeded("HTTP_RAW")) {
+            auto full_line = method + space + uri + space + protocol + line_sep;
+            ips_state.addPendingContext("HTTP_RAW", full_line);
+        }
 
         return INSPECT;
     }
@@ -171,29 +249,39 @@ public:
         ips_state.uponEnteringContext();
         auto leave_context = make_scope_exit([&ips_state] () { ips_state.uponLeavingContext(); });
 
-        auto header_value = event.getKey() + header_sep + event.getValue();
-        ips_state.addPendingContext("HTTP_REQUEST_ONE_HEADER", header_value);
-        auto full_header = header_value + line_sep;
-        ips_state.addPendingContext("HTTP_REQUEST_HEADER", full_header);
-        ips_state.addPendingContext(getHeaderContextName(event.getKey()), event.getValue());
-        ips_state.addPendingContext("HTTP_RAW", full_header);
+        const auto &key = event.getKey();
+        const auto &value = event.getValue();
+        if (ips_state.isContextNeeded("HTTP_REQUEST_ONE_HEADER")) {
+            ips_state.addPendingContext("HTTP_REQUEST_ONE_HEADER", key + header_sep + value);
+        }
+        bool is_header_needed = ips_state.isContextNeeded("HTTP_REQUEST_HEADER");
+        bool is_raw_needed = ips_state.isContextNeeded("HTTP_RAW");
+        if (is_header_needed || is_raw_needed) {
+            auto full_header = key + header_sep + value + line_sep;
+            if (is_header_needed) ips_state.addPendingContext("HTTP_REQUEST_HEADER", full_header);
+            if (is_raw_needed) ips_state.addPendingContext("HTTP_RAW", full_header);
+        }
+        addPendingContext(ips_state, getHeaderContextName(key), value);
 
         auto max_size = getConfigurationWithDefault<uint>(1536, "IPS", "Max Field Size");
 
         // Add request header for log
+        auto header_size = key.size() + header_sep.size() + value.size();
         auto maybe_req_headers_for_log = ips_state.getTransactionData(IPSCommonTypes::requests_header_for_log);
         if (!maybe_req_headers_for_log.ok()) {
-            ips_state.setTransactionData(IPSCommonTypes::requests_header_for_log, header_value);
-        } else if ((maybe_req_headers_for_log.unpack()).size() + log_sep.size() + header_value.size() < max_size) {
+            ips_state.setTransactionData(IPSCommonTypes::requests_header_for_log, key + header_sep + value);
+        } else if (maybe_req_headers_for_log.unpack().size() + log_sep.size() + header_size < max_size) {
             Buffer request_headers_for_log = maybe_req_headers_for_log.unpack() + log_sep;
-            request_headers_for_log += header_value;
+            request_headers_for_log += key;
+            request_headers_for_log += header_sep;
+            request_headers_for_log += value;
             ips_state.setTransactionData(IPSCommonTypes::requests_header_for_log, request_headers_for_log);
         }
 
         addRequestHdr(event.getKey(), event.getValue());
         if (event.isLastHeader()) {
             for (auto &context : ips_state.getPendingContexts()) {
-                if (isDropContext(context.first, context.second)) setDrop(ips_state);
+                if (isDropContext(ips_state, context.first, context.second)) setDrop(ips_state);
             }
             ips_state.clearPendingContexts();
             if (isDrop(ips_state)) return DROP;
@@ -211,24 +299,26 @@ public:
         ips_state.uponEnteringContext();
         auto leave_context = make_scope_exit([&ips_state] () { ips_state.uponLeavingContext(); });
 
-        if (isDropContext("HTTP_REQUEST_BODY", event.getData())) setDrop(ips_state);
+        if (isDropContext(ips_state, "HTTP_REQUEST_BODY", event.getData())) setDrop(ips_state);
 
         if (!ips_state.isFlagSet("HttpRequestData")) {
             ips_state.setFlag("HttpRequestData");
-            auto data =
-                ips_state.getBuffer("HTTP_METHOD") +
-                space +
-                ips_state.getBuffer("HTTP_COMPLETE_URL_DECODED") +
-                space +
-                ips_state.getBuffer("HTTP_PROTOCOL") +
-                line_sep +
-                ips_state.getBuffer("HTTP_REQUEST_HEADER") +
-                line_sep +
-                event.getData();
-            if (isDropContext("HTTP_REQUEST_DATA", data)) setDrop(ips_state);
+            if (ips_state.isContextNeeded("HTTP_REQUEST_DATA")) {
+                auto data =
+                    ips_state.getBuffer("HTTP_METHOD") +
+                    space +
+                    ips_state.getBuffer("HTTP_COMPLETE_URL_DECODED") +
+                    space +
+                    ips_state.getBuffer("HTTP_PROTOCOL") +
+                    line_sep +
+                    ips_state.getBuffer("HTTP_REQUEST_HEADER") +
+                    line_sep +
+                    event.getData();
+                if (isDropContext(ips_state, "HTTP_REQUEST_DATA", data)) setDrop(ips_state);
+            }
         }
 
-        if (isDropContext("HTTP_RAW", event.getData())) setDrop(ips_state);
+        if (isDropContext(ips_state, "HTTP_RAW", event.getData())) setDrop(ips_state);
 
         return INSPECT;
     }
@@ -244,22 +334,24 @@ public:
 
         if (!ips_state.isFlagSet("HttpRequestData")) {
             ips_state.setFlag("HttpRequestData");
-            auto data =
-                ips_state.getBuffer("HTTP_METHOD") +
-                space +
-                ips_state.getBuffer("HTTP_COMPLETE_URL_DECODED") +
-                space +
-                ips_state.getBuffer("HTTP_PROTOCOL") +
-                line_sep +
-                ips_state.getBuffer("HTTP_REQUEST_HEADER") +
-                line_sep;
-            if (isDropContext("HTTP_REQUEST_DATA", data)) return DROP;
+            if (ips_state.isContextNeeded("HTTP_REQUEST_DATA")) {
+                auto data =
+                    ips_state.getBuffer("HTTP_METHOD") +
+                    space +
+                    ips_state.getBuffer("HTTP_COMPLETE_URL_DECODED") +
+                    space +
+                    ips_state.getBuffer("HTTP_PROTOCOL") +
+                    line_sep +
+                    ips_state.getBuffer("HTTP_REQUEST_HEADER") +
+                    line_sep;
+                if (isDropContext(ips_state, "HTTP_REQUEST_DATA", data)) return DROP;
+            }
         }
 
         if (isDrop(ips_state)) return DROP;
 
-        if (isContextActive("HTTP_RESPONSE_HEADER")) return INSPECT;
-        if (isContextActive("HTTP_RESPONSE_BODY")) return INSPECT;
+        if (ips_state.isContextInspected("HTTP_RESPONSE_HEADER")) return INSPECT;
+        if (ips_state.isContextInspected("HTTP_RESPONSE_BODY")) return INSPECT;
         return ACCEPT;
     }
 
@@ -273,7 +365,7 @@ public:
         auto leave_context = make_scope_exit([&ips_state] () { ips_state.uponLeavingContext(); });
 
         Buffer buf(reinterpret_cast<const char *>(&event), sizeof(event), Buffer::MemoryType::VOLATILE);
-        if (isDropContext("HTTP_RESPONSE_CODE", buf)) return DROP;
+        if (isDropContext(ips_state, "HTTP_RESPONSE_CODE", buf)) return DROP;
 
         return INSPECT;
     }
@@ -287,7 +379,7 @@ public:
         ips_state.uponEnteringContext();
         auto leave_context = make_scope_exit([&ips_state] () { ips_state.uponLeavingContext(); });
 
-        if (isDropContext("HTTP_RESPONSE_HEADER", event.getValue())) return DROP;
+        if (isDropContext(ips_state, "HTTP_RESPONSE_HEADER", event.getValue())) return DROP;
 
         return INSPECT;
     }
@@ -301,7 +393,7 @@ public:
         ips_state.uponEnteringContext();
         auto leave_context = make_scope_exit([&ips_state] () { ips_state.uponLeavingContext(); });
 
-        if (isDropContext("HTTP_RESPONSE_BODY", event.getData())) return DROP;
+        if (isDropContext(ips_state, "HTTP_RESPONSE_BODY", event.getData())) return DROP;
 
         return event.isLastChunk() ? ACCEPT : INSPECT;
     }
@@ -322,13 +414,32 @@ public:
         IPSSignatureSubTypes::CompleteSignature::setYieldCounter(yield_limit);
     }
 
+    void
+    updateSignatureProfiler()
+    {
+        uint sample_rate = getProfileAgentSettingWithDefault<uint>(0, "ips.signatureProfiler.sampleRate");
+        signature_profiler.setMaxReportedSignatures(
+            getProfileAgentSettingWithDefault<uint>(100, "ips.signatureProfiler.maxReportedSignatures")
+        );
+        if (sample_rate == signature_profiler.getSampleRate()) return;
+
+        dbgDebug(D_IPS) << "Setting IPS signature profiler sample rate to " << sample_rate;
+        signature_profiler.setSampleRate(sample_rate);
+        signature_profiler.clear();
+    }
+
 private:
     static void setDrop(IPSEntry &state) { state.setDrop(); }
     static bool isDrop(const IPSEntry &state) { return state.isDrop(); }
 
     bool
-    isDropContext(const string &name, const Buffer &buf)
+    isDropContext(IPSEntry &ips_state, const string &name, const Buffer &buf)
     {
+        if (!ips_state.isContextInspected(name)) {
+            if (ips_state.isContextNeeded(name)) ips_state.keepContext(name, buf);
+            return false;
+        }
+
         auto responeses = ParsedContext(buf, name, 0).query();
         for (auto &reponse : responeses) {
             if (reponse == ParsedContextReply::DROP) return true;
@@ -336,11 +447,11 @@ private:
         return false;
     }
 
-    static bool
-    isContextActive(const string &context)
+    // Contexts that no signature inspects, and that are not kept for later contexts, are not worth building
+    static void
+    addPendingContext(IPSEntry &ips_state, const string &name, const Buffer &buf)
     {
-        return !getConfigurationWithDefault(IPSSignatures(), "IPS", "IpsProtections").isEmpty(context) ||
-            !getConfigurationWithDefault(SnortSignatures(), "IPSSnortSigs", "SnortProtections").isEmpty(context);
+        if (ips_state.isContextNeeded(name)) ips_state.addPendingContext(name, buf);
     }
 
     static bool
@@ -357,7 +468,7 @@ private:
         ips_state.setTransactionData(name, value);
     }
 
-    shared_ptr<PMHook>
+    shared_ptr<I_PMScan>
     getHook(const string &context_name, const set<PMPattern> &patterns) override
     {
         return tier_aggs[context_name].getHook(patterns);
@@ -368,6 +479,8 @@ private:
     I_Table *table = nullptr;
     I_Environment *env = nullptr;
     IPSSignatureSubTypes::IPSMetric ips_metric;
+    PMScanMetric pm_scan_metric{pm_scan_consumer};
+    IPSSignatureSubTypes::SignatureProfiler signature_profiler;
     map<string, SigsFirstTierAgg> tier_aggs;
 };
 
@@ -388,7 +501,13 @@ IPSComp::preload()
     registerExpectedConfigFile("ips", Config::ConfigFileType::Policy);
     registerExpectedConfigFile("ips", Config::ConfigFileType::Data);
     registerExpectedConfigFile("snort", Config::ConfigFileType::Policy);
-    registerConfigLoadCb([this]() { pimpl->updateSigsYieldCount(); });
+    registerConfigLoadCb(
+        [this]()
+        {
+            pimpl->updateSigsYieldCount();
+            pimpl->updateSignatureProfiler();
+        }
+    );
 
     ParameterException::preload();
 
@@ -48,6 +48,11 @@ private:
     uint size = 0;
 };
 
+IPSConfiguration::IPSConfiguration(const map<string, Context> &initial_conf) : context_config(initial_conf)
+{
+    setKeptContexts();
+}
+
 void
 IPSConfiguration::load(cereal::JSONInputArchive &ar)
 {
@@ -57,6 +62,7 @@ IPSConfiguration::load(cereal::JSONInputArchive &ar)
     for (auto &context : config) {
         context_config.emplace(context.getName(), context.getContext());
     }
+    setKeptContexts();
 }
 
 IPSConfiguration::Context
@@ -76,3 +82,13 @@ IPSConfiguration::getHistorySize(const string &name) const
         << "Try to access history size for non-exiting context";
     return context->second.getHistorySize();
 }
+
+void
+IPSConfiguration::setKeptContexts()
+{
+    auto contexts = make_shared<set<string>>();
+    for (auto &context : context_config) {
+        if (context.second.getType() != ContextType::NORMAL) contexts->insert(context.first);
+    }
+    kept_contexts = contexts;
+}
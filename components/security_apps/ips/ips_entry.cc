@@ -49,6 +49,9 @@ IPSEntry::respond(const ParsedContext &parsed)
     if (config.getType() == IPSConfiguration::ContextType::HISTORY) {
         buf = past_contexts[name] + buf;
     }
+    // Every signature evaluation works on a copy of the registered buffer, so the buffer is made contiguous once
+    // here rather than by each of the copies
+    buf.serialize();
     ctx.registerValue(I_KeywordsRule::getKeywordsRuleTag(), name);
     ctx.registerValue(name, buf);
 
@@ -59,6 +62,16 @@ IPSEntry::respond(const ParsedContext &parsed)
     should_drop |= snort_signatures.isMatchedPrevent(parsed.getName(), buf);
     ctx.deactivate();
 
+    storeContext(name, buf, config);
+
+    dbgDebug(D_IPS) << "Return " << (should_drop ? "drop" : "continue");
+
+    return should_drop ? ParsedContextReply::DROP : ParsedContextReply::ACCEPT;
+}
+
+void
+IPSEntry::storeContext(const string &name, Buffer &buf, const IPSConfiguration::Context &config)
+{
     switch(config.getType()) {
         case IPSConfiguration::ContextType::NORMAL: {
             ctx.unregisterKey<Buffer>(name);
@@ -66,6 +79,7 @@ IPSEntry::respond(const ParsedContext &parsed)
         }
         case IPSConfiguration::ContextType::KEEP: {
             past_contexts[name] += buf;
+            past_contexts[name].serialize();
             ctx.registerValue(name, past_contexts[name]);
             break;
         }
@@ -76,10 +90,41 @@ IPSEntry::respond(const ParsedContext &parsed)
             break;
         }
     }
+}
 
-    dbgDebug(D_IPS) << "Return " << (should_drop ? "drop" : "continue");
+void
+IPSEntry::keepContext(const string &name, const Buffer &buffer)
+{
+    dbgDebug(D_IPS) << "Keeping uninspected context " << name;
 
-    return should_drop ? ParsedContextReply::DROP : ParsedContextReply::ACCEPT;
+    auto config = getConfigurationWithDefault(default_conf, "IPS", "IpsConfigurations").getContext(name);
+    auto buf = buffer;
+    if (config.getType() == IPSConfiguration::ContextType::HISTORY) buf = past_contexts[name] + buf;
+    storeContext(name, buf, config);
+}
+
+bool
+IPSEntry::isContextInspected(const string &name)
+{
+    resolveContexts();
+    return ips_contexts->count(name) != 0 || snort_contexts->count(name) != 0;
+}
+
+bool
+IPSEntry::isContextNeeded(const string &name)
+{
+    return isContextInspected(name) || kept_contexts->count(name) != 0;
+}
+
+void
+IPSEntry::resolveContexts()
+{
+    if (ips_contexts != nullptr) return;
+
+    // The sets are shared rather than referred to, since the policy may be replaced during the transaction
+    ips_contexts = getConfigurationWithDefault(default_ips_sigs, "IPS", "IpsProtections").getContexts();
+    snort_contexts = getConfigurationWithDefault(default_snort_sigs, "IPSSnortSigs", "SnortProtections").getContexts();
+    kept_contexts = getConfigurationWithDefault(default_conf, "IPS", "IpsConfigurations").getKeptContexts();
 }
 
 Buffer
@@ -0,0 +1,127 @@
+#include "ips_signature_profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include "cereal/archives/json.hpp"
+
+using namespace std;
+using namespace chrono;
+
+namespace IPSSignatureSubTypes
+{
+
+void
+SignatureProfiler::setSampleRate(uint rate)
+{
+    sample_rate = rate;
+    evaluations_to_skip = rate > 0 ? getNextSkip() : 0;
+}
+
+// Uniform over [1, 2 * rate - 1], which averages to one sample every `rate` evaluations
+uint
+SignatureProfiler::getNextSkip()
+{
+    uint64_t max_skip = min<uint64_t>(2 * static_cast<uint64_t>(sample_rate) - 1, numeric_limits<uint>::max());
+    return uniform_int_distribution<uint>(1, max_skip)(generator);
+}
+
+SignatureProfiler::SignatureCost &
+SignatureProfiler::getCost(const string &signature_name)
+{
+    auto cost = costs.find(signature_name);
+    if (cost != costs.end()) return cost->second;
+
+    // The cheapest signature makes room for the new one, so the costly signatures stay tracked
+    if (costs.size() >= max_tracked_signatures) {
+        auto cheapest = min_element(
+            costs.begin(),
+            costs.end(),
+            [] (const pair<const string, SignatureCost> &first, const pair<const string, SignatureCost> &second)
+            {
+                return first.second.total_time < second.second.total_time;
+            }
+        );
+        costs.erase(cheapest);
+    }
+    return costs[signature_name];
+}
+
+void
+SignatureProfiler::upon(const SignatureEvaluationEvent &event)
+{
+    auto &cost = getCost(event.getSignatureName());
+    cost.sampled_evaluations++;
+    cost.total_time += event.getCost();
+    cost.max_time = max(cost.max_time, event.getCost());
+    if (event.isMatched()) cost.matches++;
+}
+
+vector<pair<string, SignatureProfiler::SignatureCost>>
+SignatureProfiler::getCostliestSignatures() const
+{
+    vector<pair<string, SignatureCost>> sorted_costs(costs.begin(), costs.end());
+    auto reported_size = min<size_t>(sorted_costs.size(), max_reported_signatures);
+    partial_sort(
+        sorted_costs.begin(),
+        sorted_costs.begin() + reported_size,
+        sorted_costs.end(),
+        [] (const pair<string, SignatureCost> &first, const pair<string, SignatureCost> &second)
+        {
+            return first.second.total_time > second.second.total_time;
+        }
+    );
+    sorted_costs.resize(reported_size);
+    return sorted_costs;
+}
+
+void
+SignatureProfiler::updateMetrics()
+{
+    sampled_evaluations.reset();
+    sampled_matches.reset();
+    cpu_time.reset();
+
+    for (const auto &signature : getCostliestSignatures()) {
+        const auto &cost = signature.second;
+        sampled_evaluations.report(signature.first, cost.sampled_evaluations);
+        cpu_time.report(signature.first, duration_cast<microseconds>(cost.total_time).count());
+        if (cost.matches > 0) sampled_matches.report(signature.first, cost.matches);
+    }
+}
+
+string
+SignatureProfiler::getReport() const
+{
+    stringstream report;
+    {
+        cereal::JSONOutputArchive archive(report);
+        archive(cereal::make_nvp("sampleRate", sample_rate));
+        archive.setNextName("signatures");
+        archive.startNode();
+        archive.makeArray();
+        for (const auto &signature : getCostliestSignatures()) {
+            const auto &cost = signature.second;
+            archive.startNode();
+            archive(
+                cereal::make_nvp("name", signature.first),
+                cereal::make_nvp("sampledEvaluations", cost.sampled_evaluations),
+                cereal::make_nvp("estimatedEvaluations", cost.sampled_evaluations * sample_rate),
+                cereal::make_nvp("totalNanoSeconds", static_cast<uint64_t>(cost.total_time.count())),
+                cereal::make_nvp(
+                    "averageNanoSeconds",
+                    static_cast<uint64_t>(cost.total_time.count()) / cost.sampled_evaluations
+                ),
+                cereal::make_nvp("maxNanoSeconds", static_cast<uint64_t>(cost.max_time.count())),
+                cereal::make_nvp("matchRate", static_cast<double>(cost.matches) / cost.sampled_evaluations)
+            );
+            archive.finishNode();
+        }
+        archive.finishNode();
+    }
+    return report.str();
+}
+
+} // IPSSignatureSubTypes
@@ -14,6 +14,7 @@
 #include "context.h"
 #include "ips_entry.h"
 #include "ips_metric.h"
+#include "ips_signature_profiler.h"
 #include "ips_common_types.h"
 
 USE_DEBUG_FLAG(D_IPS);
@@ -272,14 +273,19 @@ CompleteSignature::setIndicators(const string &source, const string &version)
     metadata.setIndicators(source, version);
 }
 
+static string
+getSubString(const Buffer &buf, uint max_size)
+{
+    if (buf.size() <= max_size) return static_cast<string>(buf);
+    return static_cast<string>(buf.getSubBuffer(0, max_size));
+}
+
 template <typename ErrorType>
 static string
 getSubString(const Maybe<Buffer, ErrorType> &buf, uint max_size = 0)
 {
     if (max_size == 0) max_size = buf.unpack().size();
-    const Buffer &real_buf = buf.unpack();
-    auto res = real_buf.size() <= max_size ? real_buf : real_buf.getSubBuffer(0, max_size);
-    return static_cast<string>(res);
+    return getSubString(buf.unpack(), max_size);
 }
 
 ActionResults
@@ -436,10 +442,25 @@ SignatureAndAction::matchSilent(const Buffer &sample) const
     return false;
 }
 
+MatchType
+SignatureAndAction::getMatch(const set<PMPattern> &pattern, I_SignatureProfiler *profiler) const
+{
+    if (profiler == nullptr || !profiler->shouldSample()) return signature->getMatch(pattern);
+
+    auto start = chrono::steady_clock::now();
+    auto match = signature->getMatch(pattern);
+    auto cost = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+    SignatureEvaluationEvent(signature->getName(), cost, match == MatchType::MATCH).notify();
+    return match;
+}
+
 bool
-SignatureAndAction::isMatchedPrevent(const Buffer &context_buffer, const set<PMPattern> &pattern) const
+SignatureAndAction::isMatchedPrevent(
+    const Buffer &context_buffer,
+    const set<PMPattern> &pattern,
+    I_SignatureProfiler *profiler) const
 {
-    if (signature->getMatch(pattern) != MatchType::MATCH) {
+    if (getMatch(pattern, profiler) != MatchType::MATCH) {
         dbgTrace(D_IPS) << "Signature doesn't match";
         return false;
     }
@@ -501,13 +522,7 @@ void SignatureAndAction::sendLog(
         << LogField("indicatorsVersion", signature->getFeedVersion())
         << LogField("waapIncidentType", signature->getIncidentType());
 
-    if (context_buffer.size() < 1024) {
-        log << LogField("matchedSample", static_cast<string>(context_buffer), LogFieldOption::XORANDB64);
-    } else {
-        auto sample = context_buffer;
-        sample.keepHead(1024);
-        log << LogField("matchedSample", static_cast<string>(sample), LogFieldOption::XORANDB64);
-    }
+    log << LogField("matchedSample", getSubString(context_buffer, 1024), LogFieldOption::XORANDB64);
 
     auto year = signature->getYear();
     if (year.ok()) log << LogField("matchedSignatureYear", to_string(*year));
@@ -717,24 +732,29 @@ IPSSignaturesPerContext::calcFirstTier(const string &ctx_name)
 set<PMPattern>
 IPSSignaturesPerContext::getFirstTierMatches(const Buffer &buffer) const
 {
-    return first_tier->ok() ? first_tier->scanBuf(buffer) : set<PMPattern>();
+    return first_tier != nullptr ? first_tier->scanBuf(buffer) : set<PMPattern>();
 }
 
 bool
 IPSSignaturesPerContext::isMatchedPrevent(const Buffer &context_buffer) const
 {
     auto first_tier_res = getFirstTierMatches(context_buffer);
+    // Looked up once per context rather than once per signature evaluation
+    I_SignatureProfiler *profiler = nullptr;
+    if (Singleton::exists<I_SignatureProfiler>()) {
+        profiler = Singleton::Consume<I_SignatureProfiler>::by<IPSSignaturesPerContext>();
+    }
 
     for (auto &pat : first_tier_res) {
         auto find = signatures_per_lss.find(pat);
         if (find == signatures_per_lss.end()) continue;
         for (auto &sig : find->second) {
-            if (sig.isMatchedPrevent(context_buffer, first_tier_res)) return true;
+            if (sig.isMatchedPrevent(context_buffer, first_tier_res, profiler)) return true;
         }
     }
 
     for (auto &sig : signatures_without_lss) {
-        if (sig.isMatchedPrevent(context_buffer, first_tier_res)) return true;
+        if (sig.isMatchedPrevent(context_buffer, first_tier_res, profiler)) return true;
     }
 
     return false;
@@ -788,9 +808,12 @@ IPSSignatures::load(cereal::JSONInputArchive &ar)
         }
     }
 
+    auto sig_contexts = make_shared<set<string>>();
     for (auto &sig_per_ctx : signatures_per_context) {
         sig_per_ctx.second.calcFirstTier(sig_per_ctx.first);
+        sig_contexts->insert(sig_per_ctx.first);
     }
+    contexts = sig_contexts;
 }
 
 bool
@@ -870,9 +893,12 @@ SnortSignatures::load(cereal::JSONInputArchive &ar)
         }
     }
 
+    auto sig_contexts = make_shared<set<string>>();
     for (auto &sig_per_ctx: signatures_per_context) {
         sig_per_ctx.second.calcFirstTier(sig_per_ctx.first);
+        sig_contexts->insert(sig_per_ctx.first);
     }
+    contexts = sig_contexts;
 }
 
 bool
@@ -4,6 +4,7 @@
 
 #include "cptest.h"
 #include "ips_entry.h"
+#include "parsed_context.h"
 #include "new_table_entry.h"
 #include "keyword_comp.h"
 #include "environment.h"
@@ -346,6 +347,102 @@ TEST_F(ComponentTest, check_query)
     EXPECT_THAT(EndRequestEvent().query(), ElementsAre(drop));
 }
 
+class ParsedContextCollector : public Listener<ParsedContext>
+{
+public:
+    void upon(const ParsedContext &) override {}
+
+    ParsedContextReply
+    respond(const ParsedContext &context) override
+    {
+        names.push_back(context.getName());
+        return ParsedContextReply::ACCEPT;
+    }
+
+    string getListenerName() const override { return "ParsedContextCollector"; }
+
+    vector<string> names;
+};
+
+TEST_F(ComponentTest, only_inspected_contexts_are_queried)
+{
+    string config =
+        "{"
+            "\"IPS\": {"
+                "\"protections\": ["
+                    "{"
+                        "\"protectionMetadata\": {"
+                            "\"protectionName\": \"Test\","
+                            "\"maintrainId\": \"101\","
+                            "\"severity\": \"Low\","
+                            "\"confidenceLevel\": \"Low\","
+                            "\"performanceImpact\": \"Medium High\","
+                            "\"lastUpdate\": \"20210420\","
+                            "\"tags\": [],"
+                            "\"cveList\": []"
+                        "},"
+                        "\"detectionRules\": {"
+                            "\"type\": \"simple\","
+                            "\"SSM\": \"\","
+                            "\"keywords\": \"data: \\\"POST\\\", part HTTP_METHOD; data: \\\"ddd\\\";\","
+                            "\"context\": [\"HTTP_REQUEST_BODY\"]"
+                        "}"
+                    "}"
+                "],"
+                "\"IpsProtections\": ["
+                    "{"
+                        "\"context\": \"\","
+                        "\"ruleName\": \"rule1\","
+                        "\"assetName\": \"asset1\","
+                        "\"assetId\": \"1-1-1\","
+                        "\"practiceId\": \"2-2-2\","
+                        "\"practiceName\": \"practice1\","
+                        "\"defaultAction\": \"Detect\","
+                        "\"rules\": ["
+                            "{"
+                                "\"action\": \"Prevent\","
+                                "\"severityLevel\": \"Low or above\","
+                                "\"performanceImpact\": \"High or lower\","
+                                "\"confidenceLevel\": \"Low\""
+                            "}"
+                        "]"
+                    "}"
+                "]"
+            "}"
+        "}";
+    loadPolicy(config);
+
+    EXPECT_CALL(table, createStateRValueRemoved(_, _));
+    EXPECT_CALL(table, getState(_)).WillRepeatedly(Return(&entry));
+    EXPECT_CALL(table, hasState(_)).WillRepeatedly(Return(true));
+
+    ParsedContextCollector collector;
+    collector.registerListener();
+
+    HttpTransactionData new_transaction(
+        "1.1",
+        "POST",
+        "ffff",
+        IPAddr::createIPAddr("0.0.0.0").unpack(),
+        80,
+        "/path?a=b",
+        IPAddr::createIPAddr("1.1.1.1").unpack(),
+        5428
+    );
+
+    EXPECT_THAT(NewHttpTransactionEvent(new_transaction).query(), ElementsAre(inspect));
+    HttpHeader header_req(Buffer("key"), Buffer("val"), 1, true);
+    EXPECT_THAT(HttpRequestHeaderEvent(header_req).query(), ElementsAre(inspect));
+    HttpBody body_req(Buffer("aaadddaaa"), 0, true);
+    EXPECT_THAT(HttpRequestBodyEvent(body_req, Buffer()).query(), ElementsAre(inspect));
+    EXPECT_THAT(EndRequestEvent().query(), ElementsAre(drop));
+
+    // HTTP_METHOD is kept for the signature above without being inspected on its own
+    EXPECT_THAT(collector.names, ElementsAre("HTTP_REQUEST_BODY"));
+
+    collector.unregisterListener();
+}
+
 TEST_F(ComponentTest, check_query_detect_mode)
 {
     string config =
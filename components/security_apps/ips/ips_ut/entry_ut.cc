@@ -26,11 +26,11 @@ operator<<(ostream &os, const ParsedContextReply &action)
 
 class MockAgg : Singleton::Provide<I_FirstTierAgg>::SelfInterface
 {
-    shared_ptr<PMHook>
+    shared_ptr<I_PMScan>
     getHook(const string &, const set<PMPattern> &pats) override
     {
         auto hook = make_shared<PMHook>();
-        hook->prepare(pats);
+        if (!hook->prepare(pats).ok()) return nullptr;
         return hook;
     }
 };
@@ -1,5 +1,6 @@
 #include "ips_signatures.h"
 #include "ips_common_types.h"
+#include "ips_signature_profiler.h"
 
 #include <sstream>
 #include <memory>
@@ -45,11 +46,11 @@ MATCHER_P(IsLog, IteratableFields, "")
 
 class MockAgg : Singleton::Provide<I_FirstTierAgg>::SelfInterface
 {
-    shared_ptr<PMHook>
+    shared_ptr<I_PMScan>
     getHook(const string &, const set<PMPattern> &pats) override
     {
         auto hook = make_shared<PMHook>();
-        hook->prepare(pats);
+        if (!hook->prepare(pats).ok()) return nullptr;
         return hook;
     }
 };
@@ -696,6 +697,86 @@ TEST_F(SignatureTest, context_signature_matching)
     EXPECT_FALSE(checkData("fff", "HTTP_COMPLETE_URL_DECODED"));
 }
 
+class SampledSignaturesCounter : public Listener<IPSSignatureSubTypes::SignatureEvaluationEvent>
+{
+public:
+    void upon(const IPSSignatureSubTypes::SignatureEvaluationEvent &) override { sampled++; }
+
+    uint sampled = 0;
+};
+
+TEST_F(SignatureTest, signature_profiler)
+{
+    load(single_signature, "Low or above", "Low");
+
+    IPSSignatureSubTypes::SignatureProfiler profiler;
+    profiler.registerListener();
+
+    EXPECT_FALSE(checkData("ggg"));
+    EXPECT_THAT(profiler.getReport(), HasSubstr("\"signatures\": []"));
+
+    profiler.setSampleRate(1);
+    EXPECT_FALSE(checkData("ggg"));
+    expectLog("\"protectionId\": \"Test1\"");
+    EXPECT_TRUE(checkData("fffddd"));
+
+    auto report = profiler.getReport();
+    EXPECT_THAT(report, HasSubstr("\"sampleRate\": 1"));
+    EXPECT_THAT(report, HasSubstr("\"name\": \"Test1\""));
+    EXPECT_THAT(report, HasSubstr("\"sampledEvaluations\": 2"));
+    EXPECT_THAT(report, HasSubstr("\"matchRate\": 0.5"));
+    profiler.setMaxReportedSignatures(0);
+    EXPECT_THAT(profiler.getReport(), HasSubstr("\"signatures\": []"));
+    profiler.setMaxReportedSignatures(10);
+
+    profiler.setSampleRate(2);
+    SampledSignaturesCounter counter;
+    counter.registerListener();
+    for (uint i = 0; i < 400; i++) {
+        EXPECT_FALSE(checkData("ggg"));
+    }
+    counter.unregisterListener();
+    EXPECT_GT(counter.sampled, 150u);
+    EXPECT_LT(counter.sampled, 250u);
+
+    profiler.setSampleRate(numeric_limits<uint>::max());
+    EXPECT_FALSE(checkData("ggg"));
+
+    profiler.setSampleRate(0);
+    profiler.unregisterListener();
+}
+
+TEST(SignatureProfilerTest, only_costliest_signatures_are_tracked)
+{
+    IPSSignatureSubTypes::SignatureProfiler profiler;
+    profiler.registerListener();
+    profiler.setMaxReportedSignatures(1);
+
+    uint max_tracked = IPSSignatureSubTypes::SignatureProfiler::max_tracked_signatures;
+    for (uint i = 0; i < max_tracked; i++) {
+        IPSSignatureSubTypes::SignatureEvaluationEvent("sig" + to_string(i), chrono::nanoseconds(i + 10), false)
+            .notify();
+    }
+    EXPECT_THAT(profiler.getReport(), HasSubstr("\"name\": \"sig" + to_string(max_tracked - 1) + "\""));
+
+    // Takes the place of the cheapest signature, and becomes the costliest one
+    IPSSignatureSubTypes::SignatureEvaluationEvent("new", chrono::nanoseconds(max_tracked + 10), true).notify();
+    IPSSignatureSubTypes::SignatureEvaluationEvent("sig0", chrono::nanoseconds(1), false).notify();
+    auto report = profiler.getReport();
+    EXPECT_THAT(report, HasSubstr("\"name\": \"new\""));
+    EXPECT_THAT(report, Not(HasSubstr("\"name\": \"sig")));
+
+    // The evicted signature is tracked again from its new evaluation, in place of the next cheapest one
+    profiler.setMaxReportedSignatures(max_tracked);
+    report = profiler.getReport();
+    EXPECT_THAT(report, HasSubstr("\"name\": \"sig0\""));
+    EXPECT_THAT(report, HasSubstr("\"totalNanoSeconds\": 1,"));
+    EXPECT_THAT(report, Not(HasSubstr("\"name\": \"sig1\"")));
+    EXPECT_THAT(report, HasSubstr("\"name\": \"sig2\""));
+
+    profiler.unregisterListener();
+}
+
 TEST_F(SignatureTest, id_to_log_test)
 {
     load(single_signature, "Low or above", "Low");
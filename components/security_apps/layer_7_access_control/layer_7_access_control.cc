@@ -109,6 +109,7 @@ public:
     void fini();
 
     string getListenerName() const override { return "Layer-7 Access Control app"; }
+    bool isActiveForAsset() const override { return isAppEnabled(); }
 
     EventVerdict
     respond(const HttpRequestHeaderEvent &event) override
@@ -23,6 +23,15 @@ convertMetricName(const std::string &original_metric_name)
         {"irrelevantVerdictSum", "traffic_inspection_verdict_irrelevant_counter"},
         {"reconfVerdictSum", "traffic_inspection_verdict_reconf_counter"},
         {"responseInspection", "response_body_inspection_counter"},
+        {"attachmentReadLatencyMicroSecondsSample", "attachment_read_latency_microseconds"},
+        {"headerParseLatencyMicroSecondsSample", "header_parse_latency_microseconds"},
+        {"verdictWriteLatencyMicroSecondsSample", "verdict_write_latency_microseconds"},
+        {"transactionLatencyMicroSecondsSample", "transaction_latency_microseconds"},
+        // HttpManagerMetric
+        {"securityAppLatencyMicroSecondsSample", "security_app_latency_microseconds"},
+        {"assetTransactionsSample", "asset_transactions_counter"},
+        {"assetInspectedBytesSample", "asset_inspected_bytes_counter"},
+        {"assetInspectionTimeMicroSecondsSample", "asset_inspection_time_microseconds_counter"},
         // nginxIntakerMetric
         {"successfullInspectionTransactionsSum", "successful_Inspection_counter"},
         {"failopenTransactionsSum", "fail_open_Inspection_counter"},
@@ -110,6 +119,21 @@ convertMetricName(const std::string &original_metric_name)
         {"preventEngineMatchesSample", "prevent_action_matches_counter"},
         {"detectEngineMatchesSample", "detect_action_matches_counter"},
         {"ignoreEngineMatchesSample", "ignore_action_matches_counter"},
+        // PMScanMetric
+        {"pmScansSample", "pattern_matcher_sampled_scans_counter"},
+        {"pmBytesScannedSample", "pattern_matcher_sampled_bytes_counter"},
+        {"pmScanTimeMicroSecondsSample", "pattern_matcher_sampled_scan_time_microseconds_counter"},
+        {"pmMaxScanTimeMicroSecondsSample", "pattern_matcher_scan_time_microseconds_max"},
+        // SignatureProfiler
+        {"ipsSignatureSampledEvaluationsSample", "ips_signature_sampled_evaluations_counter"},
+        {"ipsSignatureSampledMatchesSample", "ips_signature_sampled_matches_counter"},
+        {"ipsSignatureCpuTimeMicroSecondsSample", "ips_signature_cpu_time_microseconds_counter"},
+        // TableExpirationMetric
+        {"tableExpiredEntriesSum", "table_expired_entries_counter"},
+        {"tableMaxExpiredEntriesPerTickSample", "table_expired_entries_per_tick_max"},
+        {"tableAvgExpiredEntriesPerTickSample", "table_expired_entries_per_tick_average"},
+        {"tableMaxExpirationLatencyMilliSecondsSample", "table_expiration_latency_milliseconds_max"},
+        {"tableAvgExpirationLatencyMilliSecondsSample", "table_expiration_latency_milliseconds_average"},
         // CPUMetric
         {"cpuMaxSample", "cpu_usage_percentage_max"},
         {"cpuAvgSample", "cpu_usage_percentage_average"},
@@ -14,6 +14,9 @@
 #include "WaapRegexPreconditions.h"
 #include "Waf2Util.h"
 #include "debug.h"
+#include "config.h"
+#include "pm_scan_factory.h"
+#include "waap.h"
 #include <boost/algorithm/string/predicate.hpp>
 
 USE_DEBUG_FLAG(D_WAAP_REGEX);
@@ -169,18 +172,29 @@ namespace Waap {
         }
 
         // Initialize the aho-corasick pattern matcher with the patterns
-        Maybe<void> pmHookStatus = m_pmHook.prepare(pmPatterns);
-        if (!pmHookStatus.ok()) {
+        auto engine = PMScanFactory::engineFromString(
+            getProfileAgentSettingWithDefault<std::string>("thin_nfa", "waap.patternMatcherEngine")
+        );
+        if (!engine.ok()) {
+            dbgWarning(D_WAAP_REGEX) << engine.getErr();
+        }
+        auto pmScanner = PMScanFactory::create(
+            pmPatterns,
+            engine.ok() ? engine.unpack() : PMEngineType::THIN_NFA,
+            WAAP_APPLICATION_NAME
+        );
+        if (!pmScanner.ok()) {
             dbgError(D_WAAP_REGEX) << "Aho-Corasick engine failed to load!";
             error = true;
             return;
         }
+        m_pmScan = pmScanner.unpackMove();
         dbgTrace(D_WAAP_REGEX) << "Aho-Corasick engine loaded.";
         dbgTrace(D_WAAP_REGEX) << "Aho-corasick pattern matching engine initialized!";
     }
 
     RegexPreconditions::~RegexPreconditions() {
-        // No Hyperscan resource management here; handled by HyperscanHook
+        // No Hyperscan resource management here; handled by the scanner created by PMScanFactory
     }
 
     bool Waap::RegexPreconditions::isNoRegexPattern(const std::string &pattern) const
@@ -236,8 +250,9 @@ namespace Waap {
     void RegexPreconditions::pass1(RegexPreconditions::PmWordSet &wordsSet, Buffer &&buffer) const
     {
         dbgTrace(D_WAAP_REGEX) << "Rules pass #1: collect OR sets";
+        if (!m_pmScan) return;
 
-        m_pmHook.scanBufWithOffsetLambda(buffer, [this, &wordsSet, &buffer]
+        m_pmScan->scanBufWithOffsetLambda(buffer, [this, &wordsSet, &buffer]
             (u_int endMatchOffset, const PMPattern &pmPattern, bool matchAll)
         {
             uint offset = endMatchOffset + 1 - pmPattern.size(); // reported offset points to last character of a match
@@ -17,6 +17,7 @@
 #include "picojson.h"
 #include "pm_hook.h"
 #include "i_pm_scan.h"
+#include <memory>
 #include <map>
 #include <set>
 #include <stdint.h>
@@ -83,8 +84,8 @@ namespace Waap {
         // For each aho-corasick word - hold a list of "prefixes" which are in AND relationship between them (all must
         // be detected in order to trigger a condition on a prefix)
         WordToPrefixGroup m_wordToPrefixGroup;
-        // Aho-Corasick pattern matcher object
-        PMHook m_pmHook;
+        // Aho-Corasick pattern matcher object (engine is chosen by PMScanFactory)
+        std::shared_ptr<I_PMScan> m_pmScan;
 
         WordIndex registerWord(const std::string &wordStr);
         std::vector<WordInfo> m_pmWordInfo;
@@ -79,6 +79,15 @@ WaapComponent::Impl::init()
         ReportIS::Audience::INTERNAL
     );
     assets_metric.registerListener();
+    pm_scan_metric.init(
+        "WAAP Pattern Matcher Stats",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        std::chrono::minutes(10),
+        true
+    );
+    pm_scan_metric.registerListener();
+    PMScanFactory::registerScanSampleRateSetting();
     registerListener();
     waap_metric.registerListener();
 
@@ -113,6 +122,7 @@ WaapComponent::Impl::fini()
 {
     dbgTrace(D_WAAP) << "WaapComponent::impl::fini(). Shutting down waap engine before exiting...";
     unregisterListener();
+    pm_scan_metric.unregisterListener();
     waf2_proc_exit();
 }
 
@@ -22,6 +22,7 @@
 #include "waap_clib/WaapAssetState.h"
 #include "waap_clib/WaapAssetStatesManager.h"
 #include "reputation_features_agg.h"
+#include "pm_scan_factory.h"
 
 // WaapComponent implementation
 class WaapComponent::Impl
@@ -43,6 +44,7 @@ public:
     void fini();
 
     std::string getListenerName() const override;
+    uint getDispatchPriority() const override { return heavy_http_inspection_priority; }
 
     EventVerdict respond(const NewHttpTransactionEvent &event) override;
     EventVerdict respond(const HttpRequestHeaderEvent &event) override;
@@ -76,6 +78,7 @@ private:
     EventVerdict limit_response_headers;
     WaapMetricWrapper waap_metric;
     AssetsMetric assets_metric;
+    PMScanMetric pm_scan_metric{WAAP_APPLICATION_NAME};
     I_Table* waapStateTable;
     // Count of transactions processed by this WaapComponent instance
     uint64_t transactionsCount;
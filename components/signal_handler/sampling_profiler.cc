@@ -0,0 +1,286 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sampling_profiler.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <ucontext.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+
+#ifdef UNWIND_LIBRARY
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#elif defined(__GLIBC__) && !defined(__UCLIBC__)
+#define EXECINFO_BACKTRACE
+#include <execinfo.h>
+#endif // UNWIND_LIBRARY
+
+#include "debug.h"
+#include "mainloop.h"
+
+using namespace std;
+
+USE_DEBUG_FLAG(D_SIGNAL_HANDLER);
+
+static const uint max_frames = 32;
+static const uint max_routine_name = 64;
+
+struct ProfilerSample
+{
+    atomic<bool> is_ready;
+    uint first_frame;
+    uint depth;
+    char routine[max_routine_name];
+    void *frames[max_frames];
+};
+
+// The samples are allocated once, on the first run, and are kept for the life of the process: a signal that was
+// delivered just before the profiler stopped may still be writing into them.
+static unique_ptr<ProfilerSample[]> samples;
+static atomic<bool> is_running(false);
+static atomic<uint> next_sample(0);
+static atomic<uint64_t> dropped_samples(0);
+static pid_t mainloop_thread = 0;
+
+const uint SamplingProfiler::max_frequency;
+const uint SamplingProfiler::max_samples;
+
+// LCOV_EXCL_START Reason: runs within the SIGPROF handler
+static uint
+captureFrames(void **frames)
+{
+#if defined(UNWIND_LIBRARY)
+    int depth = unw_backtrace(frames, max_frames);
+#elif defined(EXECINFO_BACKTRACE)
+    int depth = backtrace(frames, max_frames);
+#else
+    (void)frames;
+    int depth = 0;
+#endif // UNWIND_LIBRARY
+    return depth > 0 ? depth : 0;
+}
+
+static void *
+getInterruptedAddress(void *context)
+{
+#if defined(__x86_64__)
+    return reinterpret_cast<void *>(static_cast<ucontext_t *>(context)->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+    return reinterpret_cast<void *>(static_cast<ucontext_t *>(context)->uc_mcontext.pc);
+#else
+    (void)context;
+    return nullptr;
+#endif // __x86_64__
+}
+
+static void
+copyRoutineName(char *dest, const char *src)
+{
+    uint index = 0;
+    for (; src[index] != '\0' && index < max_routine_name - 1; index++) {
+        dest[index] = src[index];
+    }
+    dest[index] = '\0';
+}
+
+// Only async-signal-safe operations are allowed here: no allocations, no locks and no debug prints.
+static void
+recordSample(int, siginfo_t *, void *context)
+{
+    if (!is_running.load(memory_order_relaxed)) return;
+
+    int saved_errno = errno;
+    uint index = next_sample.fetch_add(1, memory_order_relaxed);
+    if (index >= SamplingProfiler::max_samples) {
+        dropped_samples.fetch_add(1, memory_order_relaxed);
+        errno = saved_errno;
+        return;
+    }
+
+    ProfilerSample &sample = samples[index];
+    const char *routine = "[other thread]";
+    if (syscall(SYS_gettid) == mainloop_thread) {
+        const char *running_routine = mainloop_running_routine.load(memory_order_relaxed);
+        routine = running_routine != nullptr ? running_routine : "[mainloop]";
+    }
+    copyRoutineName(sample.routine, routine);
+
+    sample.depth = captureFrames(sample.frames);
+    // The innermost frames belong to this handler and to the kernel's signal trampoline, so the stack starts at the
+    // instruction that was interrupted, if it can be found.
+    sample.first_frame = 0;
+    void *interrupted_address = getInterruptedAddress(context);
+    for (uint frame = 0; frame < sample.depth; frame++) {
+        if (sample.frames[frame] == interrupted_address) {
+            sample.first_frame = frame;
+            break;
+        }
+    }
+
+    sample.is_ready.store(true, memory_order_release);
+    errno = saved_errno;
+}
+// LCOV_EXCL_STOP
+
+// Functions that aren't exported have no name dladdr can find, so they are written as "module+offset", which
+// addr2line can resolve offline.
+static string
+getFrameName(void *address)
+{
+    Dl_info info;
+    if (dladdr(address, &info) == 0) {
+        stringstream name;
+        name << address;
+        return name.str();
+    }
+
+    if (info.dli_sname == nullptr) {
+        const char *module = info.dli_fname != nullptr ? strrchr(info.dli_fname, '/') : nullptr;
+        module = module != nullptr ? module + 1 : info.dli_fname;
+        stringstream name;
+        name
+            << (module != nullptr ? module : "")
+            << "+0x"
+            << hex
+            << reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase);
+        return name.str();
+    }
+
+    int status;
+    char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    string name = status == 0 ? demangled : info.dli_sname;
+    free(demangled);
+    return name;
+}
+
+Maybe<void>
+SamplingProfiler::start(uint frequency)
+{
+    if (isRunning()) return genError("The sampling profiler is already running");
+    if (frequency == 0 || frequency > max_frequency) {
+        return genError("Illegal sampling frequency: " + to_string(frequency));
+    }
+
+    if (samples == nullptr) samples.reset(new ProfilerSample[max_samples]);
+    for (uint index = 0; index < max_samples; index++) {
+        samples[index].is_ready.store(false, memory_order_relaxed);
+    }
+    next_sample.store(0);
+    dropped_samples.store(0);
+    // The profiler is started from a mainloop routine, so this is the thread whose samples get the routines' names
+    mainloop_thread = syscall(SYS_gettid);
+
+#ifdef EXECINFO_BACKTRACE
+    // The first call to 'backtrace' loads libgcc, which allocates memory, so it can't be done by the signal handler
+    void *warm_up[1];
+    backtrace(warm_up, 1);
+#endif // EXECINFO_BACKTRACE
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    action.sa_sigaction = recordSample;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) == -1) {
+        return genError("Failed to set the SIGPROF handler. Error: " + string(strerror(errno)));
+    }
+
+    is_running.store(true);
+
+    uint period = 1000000 / frequency;
+    struct itimerval timer;
+    timer.it_interval.tv_sec = period / 1000000;
+    timer.it_interval.tv_usec = period % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) == -1) {
+        int errno_copy = errno;
+        is_running.store(false);
+        signal(SIGPROF, SIG_IGN);
+        return genError("Failed to set the profiling timer. Error: " + string(strerror(errno_copy)));
+    }
+
+    dbgInfo(D_SIGNAL_HANDLER) << "Sampling profiler started. Frequency: " << frequency << "Hz";
+    return Maybe<void>();
+}
+
+void
+SamplingProfiler::stop()
+{
+    if (!isRunning()) return;
+
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    // A signal that is still pending is ignored, as by default it would terminate the process
+    signal(SIGPROF, SIG_IGN);
+    is_running.store(false);
+
+    dbgInfo(D_SIGNAL_HANDLER)
+        << "Sampling profiler stopped. Samples: "
+        << min(next_sample.load(), max_samples)
+        << ", dropped samples: "
+        << getDroppedSamples();
+}
+
+bool
+SamplingProfiler::isRunning()
+{
+    return is_running.load();
+}
+
+uint64_t
+SamplingProfiler::getDroppedSamples()
+{
+    return dropped_samples.load();
+}
+
+string
+SamplingProfiler::getCollapsedStacks()
+{
+    if (samples == nullptr) return "";
+
+    map<void *, string> frame_names;
+    map<string, uint64_t> stacks;
+    uint collected = min(next_sample.load(), max_samples);
+    for (uint index = 0; index < collected; index++) {
+        const ProfilerSample &sample = samples[index];
+        if (!sample.is_ready.load(memory_order_acquire)) continue;
+
+        string stack = sample.routine;
+        for (uint frame = sample.depth; frame > sample.first_frame; frame--) {
+            void *address = sample.frames[frame - 1];
+            auto frame_name = frame_names.find(address);
+            if (frame_name == frame_names.end()) {
+                frame_name = frame_names.emplace(address, getFrameName(address)).first;
+            }
+            stack += ";" + frame_name->second;
+        }
+        stacks[stack]++;
+    }
+
+    stringstream collapsed_stacks;
+    for (const auto &stack : stacks) {
+        collapsed_stacks << stack.first << " " << stack.second << "\n";
+    }
+    return collapsed_stacks.str();
+}
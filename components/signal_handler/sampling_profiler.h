@@ -0,0 +1,39 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SAMPLING_PROFILER_H__
+#define __SAMPLING_PROFILER_H__
+
+#include <string>
+
+#include "maybe_res.h"
+
+// A sampling profiler of the whole process, driven by SIGPROF. Every time the process spends another period of CPU
+// time, the signal handler records the stack of the thread it interrupted, tagged with the name of the mainloop's
+// running routine, into memory that was allocated beforehand. The samples are symbolized only when they are
+// collected, as collapsed stacks ("routine;outer_frame;...;inner_frame count") that flame graph tools read.
+class SamplingProfiler
+{
+public:
+    static Maybe<void> start(uint frequency);
+    static void stop();
+    static bool isRunning();
+
+    static std::string getCollapsedStacks();
+    static uint64_t getDroppedSamples();
+
+    static const uint max_frequency = 1000;
+    static const uint max_samples = 10000;
+};
+
+#endif // __SAMPLING_PROFILER_H__
@@ -41,6 +41,8 @@
 #include "report/log_rest.h"
 #include "report/report.h"
 #include "agent_core_utilities.h"
+#include "rest.h"
+#include "sampling_profiler.h"
 
 #define stack_trace_max_len 64
 #define STACK_SIZE (1024 * 1024) // 1 MB stack size
@@ -50,12 +52,74 @@ using namespace ReportIS;
 
 USE_DEBUG_FLAG(D_SIGNAL_HANDLER);
 
+// 99Hz rather than 100Hz, so the samples don't fall in step with routines that run every 10 milliseconds
+static const uint default_profiling_frequency = 99;
+static const uint default_profiling_duration = 30;
+static const uint max_profiling_duration = 600;
+static I_MainLoop::RoutineID sampling_profiler_timer = 0;
+
+static void
+stopSamplingProfilerTimer()
+{
+    auto mainloop = Singleton::Consume<I_MainLoop>::by<SignalHandler>();
+    if (sampling_profiler_timer != 0 && mainloop->doesRoutineExist(sampling_profiler_timer)) {
+        mainloop->stop(sampling_profiler_timer);
+    }
+    sampling_profiler_timer = 0;
+}
+
+class StartSamplingProfiler : public ServerRest
+{
+public:
+    void
+    doCall() override
+    {
+        uint sampling_frequency = frequency.isActive() ? frequency.get() : default_profiling_frequency;
+        uint profiling_duration = duration.isActive() ? duration.get() : default_profiling_duration;
+        if (profiling_duration == 0 || profiling_duration > max_profiling_duration) {
+            throw JsonError("Illegal profiling duration: " + to_string(profiling_duration));
+        }
+
+        auto started = SamplingProfiler::start(sampling_frequency);
+        if (!started.ok()) throw JsonError(started.getErr());
+
+        stopSamplingProfilerTimer();
+        sampling_profiler_timer = Singleton::Consume<I_MainLoop>::by<SignalHandler>()->addOneTimeRoutine(
+            I_MainLoop::RoutineType::Offline,
+            [profiling_duration] ()
+            {
+                Singleton::Consume<I_MainLoop>::by<SignalHandler>()->yield(chrono::seconds(profiling_duration));
+                SamplingProfiler::stop();
+                sampling_profiler_timer = 0;
+            },
+            "Sampling profiler timer"
+        );
+    }
+
+private:
+    C2S_OPTIONAL_PARAM(uint, frequency);
+    C2S_OPTIONAL_PARAM(uint, duration);
+};
+
+class StopSamplingProfiler : public ServerRest
+{
+public:
+    void
+    doCall() override
+    {
+        stopSamplingProfilerTimer();
+        SamplingProfiler::stop();
+    }
+};
+
 class SignalHandler::Impl : Singleton::Provide<I_SignalHandler>::From<SignalHandler>
 {
 public:
     void
     fini()
     {
+        SamplingProfiler::stop();
+
         if (out_trace_file_fd != -1) close(out_trace_file_fd);
         out_trace_file_fd = -1;
 
@@ -79,6 +143,7 @@ public:
         alt_stack.ss_sp = nullptr;
         addSignalHandlerRoutine();
         addReloadConfigurationRoutine();
+        addSamplingProfilerRestCalls();
     }
 
     Maybe<vector<string>>
@@ -445,6 +510,17 @@ private:
     }
 // LCOV_EXCL_STOP
 
+    void
+    addSamplingProfilerRestCalls()
+    {
+        if (!Singleton::exists<I_RestApi>()) return;
+
+        auto rest = Singleton::Consume<I_RestApi>::by<SignalHandler>();
+        rest->addRestCall<StartSamplingProfiler>(RestAction::SET, "sampling-profiler");
+        rest->addRestCall<StopSamplingProfiler>(RestAction::DELETE, "sampling-profiler");
+        rest->addGetCall("sampling-profiler", [] () { return SamplingProfiler::getCollapsedStacks(); });
+    }
+
     void
     addReloadConfigurationRoutine()
     {
@@ -36,7 +36,8 @@ Maybe<bool, Context::Error>
 AssetMatcher::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<AssetMatcher>();
-    auto bc_asset_id_ctx = env->get<GenericConfigId>(AssetMatcher::ctx_key);
+    static const EnvKey<GenericConfigId> asset_id_key(AssetMatcher::ctx_key);
+    auto bc_asset_id_ctx = env->get(asset_id_key);
 
     if (bc_asset_id_ctx.ok()) {
         dbgTrace(D_RULEBASE_CONFIG)
@@ -37,7 +37,8 @@ Maybe<bool, Context::Error>
 EqualHost::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<EqualHost>();
-    auto host_ctx = env->get<string>(HttpTransactionData::host_name_ctx);
+    static const EnvKey<string> host_key(HttpTransactionData::host_name_ctx);
+    auto host_ctx = env->get(host_key);
 
     if (!host_ctx.ok())
     {
@@ -68,7 +69,8 @@ Maybe<bool, Context::Error>
 WildcardHost::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<WildcardHost>();
-    auto host_ctx = env->get<string>(HttpTransactionData::host_name_ctx);
+    static const EnvKey<string> host_key(HttpTransactionData::host_name_ctx);
+    auto host_ctx = env->get(host_key);
 
     if (!host_ctx.ok())
     {
@@ -165,7 +167,8 @@ Maybe<bool, Context::Error>
 EqualListeningPort::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<EqualListeningPort>();
-    auto port_ctx = env->get<PortNumber>(HttpTransactionData::listening_port_ctx);
+    static const EnvKey<PortNumber> port_key(HttpTransactionData::listening_port_ctx);
+    auto port_ctx = env->get(port_key);
 
     return port_ctx.ok() && port_ctx.unpack() == listening_port;
 }
@@ -180,7 +183,8 @@ Maybe<bool, Context::Error>
 BeginWithUri::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<BeginWithUri>();
-    auto uri_ctx = env->get<string>(HttpTransactionData::uri_ctx);
+    static const EnvKey<string> uri_key(HttpTransactionData::uri_ctx);
+    auto uri_ctx = env->get(uri_key);
 
     if (!uri_ctx.ok())
     {
@@ -36,7 +36,8 @@ Maybe<bool, Context::Error>
 ParameterMatcher::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<ParameterMatcher>();
-    auto bc_param_id_ctx = env->get<set<GenericConfigId>>(ParameterMatcher::ctx_key);
+    static const EnvKey<set<GenericConfigId>> param_id_key(ParameterMatcher::ctx_key);
+    auto bc_param_id_ctx = env->get(param_id_key);
     dbgTrace(D_RULEBASE_CONFIG)
         << "Trying to match parameter. ID: "
         << parameter_id << ", Current set IDs: "
@@ -36,7 +36,8 @@ Maybe<bool, Context::Error>
 PracticeMatcher::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<PracticeMatcher>();
-    auto bc_practice_id_ctx = env->get<set<GenericConfigId>>(PracticeMatcher::ctx_key);
+    static const EnvKey<set<GenericConfigId>> practice_id_key(PracticeMatcher::ctx_key);
+    auto bc_practice_id_ctx = env->get(practice_id_key);
     dbgTrace(D_RULEBASE_CONFIG)
         << "Trying to match practice. ID: "
         << practice_id << ", Current set IDs: "
@@ -45,7 +45,8 @@ TriggerMatcher::evalVariable() const
         return ac_bc_trigger_id_ctx.unpack().count(trigger_id) > 0;
     }
 
-    auto bc_trigger_id_ctx = env->get<set<GenericConfigId>>(TriggerMatcher::ctx_key);
+    static const EnvKey<set<GenericConfigId>> trigger_id_key(TriggerMatcher::ctx_key);
+    auto bc_trigger_id_ctx = env->get(trigger_id_key);
     dbgTrace(D_RULEBASE_CONFIG)
         << "Trying to match trigger. ID: "
         << trigger_id << ", Current set IDs: "
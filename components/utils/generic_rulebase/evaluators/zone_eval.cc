@@ -34,7 +34,8 @@ Maybe<bool, Context::Error>
 ZoneMatcher::evalVariable() const
 {
     I_Environment *env = Singleton::Consume<I_Environment>::by<ZoneMatcher>();
-    auto bc_zone_id_ctx = env->get<GenericConfigId>(ZoneMatcher::ctx_key);
+    static const EnvKey<GenericConfigId> zone_id_key(ZoneMatcher::ctx_key);
+    auto bc_zone_id_ctx = env->get(zone_id_key);
     if (bc_zone_id_ctx.ok() && *bc_zone_id_ctx == zone_id) return true;
 
     if (!getProfileAgentSettingWithDefault<bool>(false, "rulebase.enableQueryBasedMatch")) return false;
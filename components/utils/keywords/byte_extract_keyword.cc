@@ -14,7 +14,7 @@ class ByteExtractKeyword : public SingleKeyword
 {
 public:
     explicit ByteExtractKeyword(const vector<KeywordAttr> &attr, VariablesMapping &vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState *prev) const override;
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     enum class BaseId
@@ -26,25 +26,25 @@ private:
     };
 
     void
-    setOffset(const KeywordAttr &attr, const VariablesMapping &vars)
+    setOffset(const KeywordAttr &attr, VariablesMapping &vars)
     {
         offset.setAttr(attr, vars, "byte_extract");
     }
 
     void
-    setRelative(const KeywordAttr &attr, const VariablesMapping &)
+    setRelative(const KeywordAttr &attr, VariablesMapping &)
     {
         is_relative.setAttr(attr, "byte_extract");
     }
 
     void
-    setLittleEndian(const KeywordAttr &attr, const VariablesMapping &)
+    setLittleEndian(const KeywordAttr &attr, VariablesMapping &)
     {
         is_little_end.setAttr(attr, "byte_extract");
     }
 
     void
-    setDataType(const KeywordAttr &attr, const VariablesMapping &)
+    setDataType(const KeywordAttr &attr, VariablesMapping &)
     {
         if (data_type != BaseId::BIN) {
             throw KeywordError("Double definition of the data type in the 'byte_extract' keyword");
@@ -65,13 +65,13 @@ private:
     }
 
     void
-    setContext(const KeywordAttr &attr, const VariablesMapping &)
+    setContext(const KeywordAttr &attr, VariablesMapping &vars)
     {
-        ctx.setAttr(attr, "byte_extract");
+        ctx.setAttr(attr, vars, "byte_extract");
     }
 
     void
-    setAlign(const KeywordAttr &attr, const VariablesMapping &)
+    setAlign(const KeywordAttr &attr, VariablesMapping &)
     {
         if (align != 1) throw KeywordError("Double definition of the 'align' in the 'byte_extract' keyword");
         auto &vec = attr.getParams();
@@ -92,7 +92,7 @@ private:
         return !is_relative && bytes.isConstant() && offset.isConstant();
     }
 
-    pair<uint, uint> getStartOffsetAndLength(uint buf_size, const I_KeywordRuntimeState *prev) const;
+    pair<uint, uint> getStartOffsetAndLength(uint buf_size, const KeywordRuntimeState &state) const;
     uint applyAlignment(uint value) const;
     Maybe<uint> readValue(uint start, uint length, const Buffer &buf) const;
     Maybe<uint> readStringValue(uint start, uint length, const Buffer &buf) const;
@@ -106,10 +106,10 @@ private:
     int         align = 1;
     CtxAttr     ctx;
 
-    static const map<string, void(ByteExtractKeyword::*)(const KeywordAttr &, const VariablesMapping &)> setops;
+    static const map<string, void(ByteExtractKeyword::*)(const KeywordAttr &, VariablesMapping &)> setops;
 };
 
-const map<string, void(ByteExtractKeyword::*)(const KeywordAttr &, const VariablesMapping &)>
+const map<string, void(ByteExtractKeyword::*)(const KeywordAttr &, VariablesMapping &)>
 ByteExtractKeyword::setops = {
     { "offset",             &ByteExtractKeyword::setOffset       },
     { "relative",           &ByteExtractKeyword::setRelative     },
@@ -132,7 +132,7 @@ ByteExtractKeyword::ByteExtractKeyword(const vector<KeywordAttr> &attrs, Variabl
         throw KeywordError("More than one element in the 'bytes' in the 'byte_extract' keyword");
     }
     bytes.setAttr("bytes", bytes_param[0], vars, "byte_extract", static_cast<uint>(BaseId::DEC), true);
-    if (bytes.isConstant() && bytes.evalAttr(nullptr) == 0) {
+    if (bytes.isConstant() && bytes.getConstValue() == 0) {
         throw KeywordError("Number of bytes is zero in the 'byte_extract' keyword");
     }
 
@@ -166,7 +166,7 @@ ByteExtractKeyword::ByteExtractKeyword(const vector<KeywordAttr> &attrs, Variabl
         if (!bytes.isConstant()) {
             throw KeywordError("Data type is binary, but the 'bytes' is not constant in the 'byte_extract' keyword");
         }
-        int num_bytes = bytes.evalAttr(nullptr);
+        int num_bytes = bytes.getConstValue();
         if (num_bytes != 1 && num_bytes != 2 && num_bytes != 4) {
             throw KeywordError("Data type is binary, but the 'bytes' is not constant in the 'byte_extract' keyword");
         }
@@ -199,10 +199,10 @@ addOffset(uint offset, int add)
 }
 
 pair<uint, uint>
-ByteExtractKeyword::getStartOffsetAndLength(uint buf_size, const I_KeywordRuntimeState *prev) const
+ByteExtractKeyword::getStartOffsetAndLength(uint buf_size, const KeywordRuntimeState &state) const
 {
-    uint relative_offset = is_relative ? prev->getOffset(ctx) : 0;
-    int offset_attr = offset.evalAttr(prev);
+    uint relative_offset = is_relative ? state.getOffset(ctx.getSlot()) : 0;
+    int offset_attr = offset.evalAttr(state);
     uint start_offset = addOffset(relative_offset, offset_attr);
 
     if (start_offset >= buf_size) return make_pair(0, 0);
@@ -270,20 +270,20 @@ ByteExtractKeyword::applyAlignment(uint value) const
 }
 
 MatchStatus
-ByteExtractKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+ByteExtractKeyword::isMatch(KeywordRuntimeState &state) const
 {
-    auto part = Singleton::Consume<I_Environment>::by<KeywordComp>()->get<Buffer>(static_cast<string>(ctx));
+    auto part = state.getBuffer(ctx.getSlot());
 
-    if (!part.ok()) return MatchStatus::NoMatchFinal;
+    if (part == nullptr) return MatchStatus::NoMatchFinal;
 
-    uint bytes_to_extr = bytes.evalAttr(prev);
+    uint bytes_to_extr = bytes.evalAttr(state);
     if (bytes_to_extr == 0) {
         dbgDebug(D_KEYWORD) << "Number of bytes is zero in the 'byte_extract' keyword";
         return MatchStatus::NoMatch;  //the case of constant number of bytes was checked during compilation
     }
     
     uint start_offset, length_to_end;
-    tie(start_offset, length_to_end) = getStartOffsetAndLength((*part).size(), prev);
+    tie(start_offset, length_to_end) = getStartOffsetAndLength((*part).size(), state);
 
     uint offset_after_extracted_bytes = applyAlignment(start_offset + bytes_to_extr);
 
@@ -307,9 +307,9 @@ ByteExtractKeyword::isMatch(const I_KeywordRuntimeState *prev) const
     }
 
     //add variable and move offset after number of extracted bytes
-    VariableRuntimeState new_var(prev, var_id, extracted_val);
-    OffsetRuntimeState new_offset(&new_var, ctx, offset_after_extracted_bytes);
-    return runNext(&new_offset);
+    ScopedVariable new_var(state, var_id, extracted_val);
+    ScopedOffset new_offset(state, ctx.getSlot(), offset_after_extracted_bytes);
+    return runNext(state);
 }
 
 unique_ptr<SingleKeyword>
@@ -13,8 +13,8 @@ USE_DEBUG_FLAG(D_KEYWORD);
 class CompareKeyword : public SingleKeyword
 {
 public:
-    explicit CompareKeyword(const vector<KeywordAttr> &attr, const VariablesMapping &vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState* prev) const override;
+    explicit CompareKeyword(const vector<KeywordAttr> &attr, VariablesMapping &vars);
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     bool
@@ -28,7 +28,7 @@ private:
     ComparisonAttr comparison;
 };
 
-CompareKeyword::CompareKeyword(const vector<KeywordAttr> &attrs, const VariablesMapping &vars)
+CompareKeyword::CompareKeyword(const vector<KeywordAttr> &attrs, VariablesMapping &vars)
 {
     if (attrs.size() != 3) throw KeywordError("Invalid number of attributes in the 'compare' keyword");
     
@@ -52,12 +52,12 @@ CompareKeyword::CompareKeyword(const vector<KeywordAttr> &attrs, const Variables
 }
 
 MatchStatus
-CompareKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+CompareKeyword::isMatch(KeywordRuntimeState &state) const
 {
-    int keyword_first_val = first_val.evalAttr(prev);
-    int keyword_second_val = second_val.evalAttr(prev);
+    int keyword_first_val = first_val.evalAttr(state);
+    int keyword_second_val = second_val.evalAttr(state);
 
-    if (comparison(keyword_first_val, keyword_second_val)) return runNext(prev);
+    if (comparison(keyword_first_val, keyword_second_val)) return runNext(state);
 
     // If there was no matches and the keyword is effected by other keywords, then we know that the rule won't match
     return isConstant() ? MatchStatus::NoMatchFinal : MatchStatus::NoMatch;
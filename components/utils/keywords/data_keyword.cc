@@ -3,7 +3,11 @@
 #include "debug.h"
 
 #include <map>
+#include <string.h>
 #include <strings.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
 
 using namespace std;
 
@@ -12,44 +16,44 @@ USE_DEBUG_FLAG(D_KEYWORD);
 class DataKeyword : public SingleKeyword
 {
 public:
-    explicit DataKeyword(const vector<KeywordAttr> &attr, const VariablesMapping &vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState* prev) const override;
+    explicit DataKeyword(const vector<KeywordAttr> &attr, VariablesMapping &vars);
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     void
-    setOffset(const KeywordAttr &attr, const VariablesMapping &vars)
+    setOffset(const KeywordAttr &attr, VariablesMapping &vars)
     {
         offset.setAttr(attr, vars, "data");
     }
 
     void
-    setDepth(const KeywordAttr &attr, const VariablesMapping &vars)
+    setDepth(const KeywordAttr &attr, VariablesMapping &vars)
     {
         depth.setAttr(attr, vars, "data");
     }
 
     void
-    setCaret(const KeywordAttr &attr, const VariablesMapping &)
+    setCaret(const KeywordAttr &attr, VariablesMapping &)
     {
         is_caret.setAttr(attr, "data");
     }
 
     void
-    setRelative(const KeywordAttr &attr, const VariablesMapping &)
+    setRelative(const KeywordAttr &attr, VariablesMapping &)
     {
         is_relative.setAttr(attr, "data");
     }
 
     void
-    setCaseInsensitive(const KeywordAttr &attr, const VariablesMapping &)
+    setCaseInsensitive(const KeywordAttr &attr, VariablesMapping &)
     {
         is_case_insensitive.setAttr(attr, "data");
     }
 
     void
-    setContext(const KeywordAttr &attr, const VariablesMapping &)
+    setContext(const KeywordAttr &attr, VariablesMapping &vars)
     {
-        ctx.setAttr(attr, "data");
+        ctx.setAttr(attr, vars, "data");
     }
 
     void parseString(const string &str);
@@ -60,33 +64,15 @@ private:
         pattern.push_back(static_cast<unsigned char>(ch));
     }
 
-    void calcTables();
+    // The way the pattern is searched for is chosen once, when the keyword is loaded
+    enum class MatchMethod { ANCHORED, SINGLE_BYTE, SUBSTRING, CASELESS_SUBSTRING };
 
-    pair<uint, uint> getStartAndEndOffsets(uint buf_size, const I_KeywordRuntimeState *prev) const;
-    uint bytesMatched(const Buffer&, uint) const;
+    void selectMatchMethod();
 
-    uint
-    moveOnMatch() const
-    {
-        return pattern.size();
-    }
-
-    uint
-    moveOnNoMatch(uint offset_from_end, unsigned char first_unmatched_byte) const
-    {
-        dbgAssert(shift.size() > offset_from_end)
-            << AlertInfo(AlertTeam::CORE, "keywords")
-            << "Shift table of the 'data' keyword is shorter than the offset";
-
-        uint skip_size;
-        if (skip[first_unmatched_byte]>offset_from_end) {
-            skip_size = skip[first_unmatched_byte]-offset_from_end;
-        } else {
-            skip_size = 1;
-        }
-
-        return max(shift[offset_from_end], skip_size);
-    }
+    pair<uint, uint> getStartAndEndOffsets(uint buf_size, const KeywordRuntimeState &state) const;
+    Maybe<uint> findNext(const u_char *buf, uint start, uint end) const;
+    Maybe<uint> findNextCaseless(const u_char *buf, uint start, uint end) const;
+    bool isCaselessMatchAt(const u_char *buf, uint offset) const;
 
     bool
     isConstant() const
@@ -95,8 +81,10 @@ private:
     }
 
     vector<unsigned char> pattern;
-    uint                  skip[256];
-    vector<uint>          shift;
+    MatchMethod           method = MatchMethod::SUBSTRING;
+    // Both cases of the first pattern byte, used to look for candidates of caseless matches
+    unsigned char         first_lower = 0;
+    unsigned char         first_upper = 0;
 
     NumericAttr           offset;
     NumericAttr           depth;
@@ -106,10 +94,10 @@ private:
     BoolAttr              is_case_insensitive;
     CtxAttr               ctx;
 
-    static const map<string, void(DataKeyword::*)(const KeywordAttr &, const VariablesMapping &)> setops;
+    static const map<string, void(DataKeyword::*)(const KeywordAttr &, VariablesMapping &)> setops;
 };
 
-const map<string, void(DataKeyword::*)(const KeywordAttr &, const VariablesMapping &)> DataKeyword::setops = {
+const map<string, void(DataKeyword::*)(const KeywordAttr &, VariablesMapping &)> DataKeyword::setops = {
     { "relative", &DataKeyword::setRelative        },
     { "offset",   &DataKeyword::setOffset          },
     { "depth",    &DataKeyword::setDepth           },
@@ -118,7 +106,7 @@ const map<string, void(DataKeyword::*)(const KeywordAttr &, const VariablesMappi
     { "part",     &DataKeyword::setContext         }
 };
 
-DataKeyword::DataKeyword(const vector<KeywordAttr> &attrs, const VariablesMapping &vars)
+DataKeyword::DataKeyword(const vector<KeywordAttr> &attrs, VariablesMapping &vars)
         :
     offset(),
     depth()
@@ -143,6 +131,7 @@ DataKeyword::DataKeyword(const vector<KeywordAttr> &attrs, const VariablesMappin
     if (start+1 >= end) throw KeywordError("No input for the 'data' keyword");
 
     parseString(string_pattern.substr(start+1, end-(start+1)));
+    if (pattern.empty()) throw KeywordError("No input for the 'data' keyword");
 
     for (uint i = 1; i<attrs.size(); i++) {
         auto curr = setops.find(attrs[i].getAttrName());
@@ -153,11 +142,25 @@ DataKeyword::DataKeyword(const vector<KeywordAttr> &attrs, const VariablesMappin
         (this->*set_func)(attrs[i], vars);
     }
 
-    calcTables();
+    selectMatchMethod();
 }
 
+static const struct LowerCaseTable
+{
+    LowerCaseTable()
+    {
+        for (uint ch = 0; ch < 256; ch++) {
+            table[ch] = tolower(ch);
+        }
+    }
+
+    unsigned char operator[](unsigned char ch) const { return table[ch]; }
+
+    unsigned char table[256];
+} lower_case;
+
 void
-DataKeyword::calcTables()
+DataKeyword::selectMatchMethod()
 {
     if (is_case_insensitive) {
         for (auto &ch : pattern) {
@@ -167,64 +170,21 @@ DataKeyword::calcTables()
         }
     }
 
-    // Initialize skip table - when we meet a charecter that isn't in the pattern, we skip the whole pattern
-    for (auto &ch_skip : skip) {
-        ch_skip = pattern.size();
+    first_lower = pattern[0];
+    first_upper = is_case_insensitive ? toupper(pattern[0]) : pattern[0];
+    bool needs_case_folding = false;
+    for (auto ch : pattern) {
+        if (is_case_insensitive && toupper(ch) != ch) needs_case_folding = true;
     }
 
-    // Go over the charecters in the pattern.
-    // We can skip from a charecter to the end of the pattern.
-    // If a charecter appear more than once, the latest occurence take precedent.
-    for (uint index = 0; index<pattern.size(); index++) {
-        unsigned char ch = pattern[index];
-
-        uint dist_to_end = pattern.size()-(index+1);
-        if (is_case_insensitive && islower(ch)) {
-            skip[toupper(ch)] = dist_to_end;
-        }
-        skip[ch] = dist_to_end;
-    }
-
-    // Initialize the shift table.
-    shift.resize(pattern.size(), 0);
-
-    uint end_offset = pattern.size()-1;
-    // Go over all the suffixes (from the empty to the pattern-1)
-    for (size_t suffix_len = 0; suffix_len<pattern.size(); suffix_len++) {
-        // Find the smallest shift, so when shifting the suffix left:
-        // 1. All chars overlapping between pattern and shifted suffix match.
-        // 2. If the character before the shifted suffix overlaps the pattern, it doesn't match.
-        // pattern = "hellololo", suff=2 (must match "[^o]lo"), shift=4 ("hel(lo)lolo")
-        // pattern = "olo" suff=2 (must match "[^o]lo"), shift=2 ("(.o)lo")
-        //           characters before the patterns are considered wild.
-        for (uint shift_offset = 1; shift_offset<=pattern.size(); shift_offset++) {
-            // Verify that in the current offset matches the suffix
-            size_t num_of_overlapping_char;
-            unsigned char *suffix_start_ptr;
-            unsigned char *shifted_suffix_start_ptr;
-            if (shift_offset+suffix_len <= pattern.size()) {
-                // Shifted suffix doesn't exceed the pattern. Compare the whole suffix.
-                num_of_overlapping_char  = suffix_len;
-                suffix_start_ptr         = pattern.data() + pattern.size() - suffix_len;
-                shifted_suffix_start_ptr = suffix_start_ptr - shift_offset;
-            } else {
-                // Shifted suffix exceeds the pattern. Compare only the overlaping charecters.
-                num_of_overlapping_char  = pattern.size() - shift_offset;
-                suffix_start_ptr         = pattern.data() + shift_offset;
-                shifted_suffix_start_ptr = pattern.data();
-            }
-
-            if (bcmp(suffix_start_ptr, shifted_suffix_start_ptr, num_of_overlapping_char) != 0) continue;
-
-            // Verify that what comes after the suffix doesn't match
-            if (shift_offset+suffix_len < pattern.size()) {
-                if (pattern[end_offset-suffix_len] == pattern[end_offset-(shift_offset+suffix_len)]) continue;
-            }
-
-            // Set the currect shift offset
-            shift[suffix_len] = shift_offset;
-            break;
-        }
+    if (is_caret) {
+        method = MatchMethod::ANCHORED;
+    } else if (needs_case_folding) {
+        method = MatchMethod::CASELESS_SUBSTRING;
+    } else if (pattern.size() == 1) {
+        method = MatchMethod::SINGLE_BYTE;
+    } else {
+        method = MatchMethod::SUBSTRING;
     }
 }
 
@@ -317,14 +277,14 @@ addOffset(uint offset, int add)
 }
 
 pair<uint, uint>
-DataKeyword::getStartAndEndOffsets(uint buf_size, const I_KeywordRuntimeState *prev) const
+DataKeyword::getStartAndEndOffsets(uint buf_size, const KeywordRuntimeState &state) const
 {
-    uint relative_offset = is_relative?prev->getOffset(ctx):0;
-    int offset_attr = offset.evalAttr(prev);
+    uint relative_offset = is_relative?state.getOffset(ctx.getSlot()):0;
+    int offset_attr = offset.evalAttr(state);
     uint start_offset = addOffset(relative_offset, offset_attr);
 
     if (depth.isSet()) {
-        uint depth_size = addOffset(start_offset, depth.evalAttr(prev));
+        uint depth_size = addOffset(start_offset, depth.evalAttr(state));
         buf_size = std::min(buf_size, depth_size);
     }
     if (is_caret) {
@@ -334,23 +294,78 @@ DataKeyword::getStartAndEndOffsets(uint buf_size, const I_KeywordRuntimeState *p
     return make_pair(start_offset, buf_size);
 }
 
-uint
-DataKeyword::bytesMatched(const Buffer &buf, uint offset) const
+bool
+DataKeyword::isCaselessMatchAt(const u_char *buf, uint offset) const
 {
-    if (is_case_insensitive) {
-        for (uint i = 0;  i<pattern.size(); i++) {
-            if (pattern[pattern.size()-(i+1)] != tolower(buf[offset-(i+1)])) return i;
+    for (uint i = 0; i < pattern.size(); i++) {
+        if (lower_case[buf[offset + i]] != pattern[i]) return false;
+    }
+    return true;
+}
+
+Maybe<uint>
+DataKeyword::findNextCaseless(const u_char *buf, uint start, uint end) const
+{
+    uint last_start = end - pattern.size();
+    uint curr = start;
+
+#ifdef __SSE2__
+    // Look for both cases of the first byte, 16 bytes at a time, and only compare the rest on candidates
+    const __m128i lower = _mm_set1_epi8(first_lower);
+    const __m128i upper = _mm_set1_epi8(first_upper);
+    while (curr + 16 <= last_start + 1) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + curr));
+        uint candidates = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, lower), _mm_cmpeq_epi8(block, upper))
+        );
+        while (candidates != 0) {
+            uint candidate = curr + __builtin_ctz(candidates);
+            if (isCaselessMatchAt(buf, candidate)) return candidate;
+            candidates &= candidates - 1;
         }
-    } else {
-        for (uint i = 0 ; i < pattern.size() ; i++ ) {
-            if (pattern[pattern.size()-(i+1)] != buf[offset-(i+1)] ) return i;
+        curr += 16;
+    }
+#endif // __SSE2__
+
+    for (; curr <= last_start; curr++) {
+        if ((buf[curr] == first_lower || buf[curr] == first_upper) && isCaselessMatchAt(buf, curr)) return curr;
+    }
+    return genError("Pattern not found");
+}
+
+// Returns the start of the first appearance of the pattern in buf[start, end)
+Maybe<uint>
+DataKeyword::findNext(const u_char *buf, uint start, uint end) const
+{
+    if (start > end || end - start < pattern.size()) return genError("Pattern not found");
+
+    switch (method) {
+        case MatchMethod::ANCHORED: {
+            bool match = is_case_insensitive ?
+                isCaselessMatchAt(buf, start) :
+                memcmp(buf + start, pattern.data(), pattern.size()) == 0;
+            if (match) return start;
+            break;
+        }
+        case MatchMethod::SINGLE_BYTE: {
+            auto found = memchr(buf + start, pattern[0], end - start);
+            if (found != nullptr) return static_cast<const u_char *>(found) - buf;
+            break;
+        }
+        case MatchMethod::SUBSTRING: {
+            auto found = memmem(buf + start, end - start, pattern.data(), pattern.size());
+            if (found != nullptr) return static_cast<const u_char *>(found) - buf;
+            break;
+        }
+        case MatchMethod::CASELESS_SUBSTRING: {
+            return findNextCaseless(buf, start, end);
         }
     }
-    return pattern.size();
+    return genError("Pattern not found");
 }
 
 MatchStatus
-DataKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+DataKeyword::isMatch(KeywordRuntimeState &state) const
 {
     dbgAssert(pattern.size()>0)
         << AlertInfo(AlertTeam::CORE, "keywords")
@@ -358,47 +373,37 @@ DataKeyword::isMatch(const I_KeywordRuntimeState *prev) const
 
     dbgDebug(D_KEYWORD) << "Searching for " << dumpHex(pattern);
 
-    auto part = Singleton::Consume<I_Environment>::by<KeywordComp>()->get<Buffer>(static_cast<string>(ctx));
-    if (!part.ok()) {
-        if (is_negative) return runNext(prev);
+    auto part = state.getBuffer(ctx.getSlot());
+    if (part == nullptr) {
+        if (is_negative) return runNext(state);
         return MatchStatus::NoMatchFinal;
     }
 
-    const auto &buf = part.unpack();
+    const auto &buf = *part;
 
     dbgTrace(D_KEYWORD) << "Full buffer: " << dumpHex(buf);
 
     uint offset, max_offset;
 
-    tie(offset, max_offset) = getStartAndEndOffsets(buf.size(), prev);
-    offset += pattern.size();
+    tie(offset, max_offset) = getStartAndEndOffsets(buf.size(), state);
 
-    bool match_found = false;
-    while (offset<=max_offset) {
-        // Short circuit for the common, simple case where the last byte doesn't match
-        if (skip[buf[offset-1]]) {
-            offset += skip[buf[offset - 1]];
-            continue;
-        }
+    // The buffer is cached by the runtime state, so it is linearized at most once per rule evaluation
+    const u_char *data = buf.data();
 
-        // Full search Boyer-Moore
-        uint match_size = bytesMatched(buf, offset);
-        if (match_size == pattern.size()) {
-            if (is_negative) {
-                return isConstant()?MatchStatus::NoMatchFinal:MatchStatus::NoMatch;
-            }
-            match_found = true;
-            OffsetRuntimeState new_offset(prev, ctx, offset);
-            auto next_keyword_result = runNext(&new_offset);
-            if (next_keyword_result!=MatchStatus::NoMatch) return next_keyword_result;
-            offset += moveOnMatch();
-        } else {
-            offset += moveOnNoMatch(match_size, buf[offset-(match_size+1)]);
+    bool match_found = false;
+    for (auto found = findNext(data, offset, max_offset); found.ok(); found = findNext(data, offset, max_offset)) {
+        if (is_negative) {
+            return isConstant()?MatchStatus::NoMatchFinal:MatchStatus::NoMatch;
         }
+        match_found = true;
+        offset = found.unpack() + pattern.size();
+        ScopedOffset new_offset(state, ctx.getSlot(), offset);
+        auto next_keyword_result = runNext(state);
+        if (next_keyword_result!=MatchStatus::NoMatch) return next_keyword_result;
     }
 
     // No matchs is a success for negative keywords
-    if (is_negative && !match_found) return runNext(prev);
+    if (is_negative && !match_found) return runNext(state);
 
     // If there were no matchs and the keyword is an effected by other keywords, then we know that the rule won't match
     if (isConstant() && !match_found) return MatchStatus::NoMatchFinal;
@@ -12,8 +12,8 @@ USE_DEBUG_FLAG(D_KEYWORD);
 class jumpKeyword : public SingleKeyword
 {
 public:
-    explicit jumpKeyword(const vector<KeywordAttr> &attr, const VariablesMapping &vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState* prev) const override;
+    explicit jumpKeyword(const vector<KeywordAttr> &attr, VariablesMapping &vars);
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     enum class JumpFromId
@@ -24,13 +24,13 @@ private:
     };
 
     void
-    setContext(const KeywordAttr &attr)
+    setContext(const KeywordAttr &attr, VariablesMapping &vars)
     {
-        ctx.setAttr(attr, "byte_extract");
+        ctx.setAttr(attr, vars, "byte_extract");
     }
 
     void
-    setAlign(const KeywordAttr &attr)
+    setAlign(const KeywordAttr &attr, VariablesMapping &)
     {
         if (align != 1) throw KeywordError("Double definition of the 'align' in the 'jump' keyword");
         auto &vec = attr.getParams();
@@ -56,18 +56,18 @@ private:
     int         align = 1;
     CtxAttr     ctx;
 
-    static const map<string, void(jumpKeyword::*)(const KeywordAttr &)> setops;
-    uint getStartOffset(uint buf_size, const I_KeywordRuntimeState *prev) const;
+    static const map<string, void(jumpKeyword::*)(const KeywordAttr &, VariablesMapping &)> setops;
+    uint getStartOffset(uint buf_size, const KeywordRuntimeState &state) const;
     uint applyAlignment(uint value) const;
     uint addOffset(uint offset, int add) const;
 };
 
-const map<string, void(jumpKeyword::*)(const KeywordAttr &)> jumpKeyword::setops = {
+const map<string, void(jumpKeyword::*)(const KeywordAttr &, VariablesMapping &)> jumpKeyword::setops = {
     { "part",            &jumpKeyword::setContext   },
     { "align",           &jumpKeyword::setAlign     }
 };
 
-jumpKeyword::jumpKeyword(const vector<KeywordAttr> &attrs, const VariablesMapping &vars)
+jumpKeyword::jumpKeyword(const vector<KeywordAttr> &attrs, VariablesMapping &vars)
 {
 
     //two requied attributes - jumping value and jumping from
@@ -103,7 +103,7 @@ jumpKeyword::jumpKeyword(const vector<KeywordAttr> &attrs, const VariablesMappin
             throw KeywordError("Unknown attribute " + attrs[i].getAttrName() + " in the 'jump' keyword");
         }
         auto set_func = curr->second;
-        (this->*set_func)(attrs[i]);
+        (this->*set_func)(attrs[i], vars);
     }
 }
 
@@ -130,7 +130,7 @@ jumpKeyword::addOffset(uint offset, int add) const
 }
 
 uint
-jumpKeyword::getStartOffset(uint buf_size, const I_KeywordRuntimeState *prev) const
+jumpKeyword::getStartOffset(uint buf_size, const KeywordRuntimeState &state) const
 {
     switch (jumping_from) {
         case JumpFromId::FROM_BEGINNING: {
@@ -140,7 +140,7 @@ jumpKeyword::getStartOffset(uint buf_size, const I_KeywordRuntimeState *prev) co
             return buf_size;
         }
         case JumpFromId::RELATIVE: {
-            return prev->getOffset(ctx);
+            return state.getOffset(ctx.getSlot());
         }
     }
     dbgAssert(false) << AlertInfo(AlertTeam::CORE, "keywords") << "Invalid jumping 'from' parameter";
@@ -148,23 +148,23 @@ jumpKeyword::getStartOffset(uint buf_size, const I_KeywordRuntimeState *prev) co
 }
 
 MatchStatus
-jumpKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+jumpKeyword::isMatch(KeywordRuntimeState &state) const
 {
-    auto part = Singleton::Consume<I_Environment>::by<KeywordComp>()->get<Buffer>(static_cast<string>(ctx));
+    auto part = state.getBuffer(ctx.getSlot());
 
-    if (!part.ok()) return MatchStatus::NoMatchFinal;
+    if (part == nullptr) return MatchStatus::NoMatchFinal;
 
-    uint start_offset = getStartOffset((*part).size(), prev);
+    uint start_offset = getStartOffset((*part).size(), state);
 
-    uint offset_to_jump = addOffset(start_offset, jumping_val.evalAttr(prev));
+    uint offset_to_jump = addOffset(start_offset, jumping_val.evalAttr(state));
 
     if (offset_to_jump > (*part).size()) {
         dbgDebug(D_KEYWORD) << "New offset exceeds the buffer size in the 'jump' keyword";
         return isConstant() ? MatchStatus::NoMatchFinal : MatchStatus::NoMatch;
     }
 
-    OffsetRuntimeState new_offset(prev, ctx, offset_to_jump);
-    return runNext(&new_offset);
+    ScopedOffset new_offset(state, ctx.getSlot(), offset_to_jump);
+    return runNext(state);
 }
 
 unique_ptr<SingleKeyword>
@@ -1,7 +1,7 @@
 #include "keyword_comp.h"
 
 #include <vector>
-#include "sentinel_runtime_state.h"
+#include "single_keyword.h"
 
 using namespace std;
 
@@ -100,41 +100,6 @@ KeywordParsed::KeywordParsed(string const &keyword) {
     }
 }
 
-uint
-SentinelRuntimeState::getOffset(const std::string &) const
-{
-    return 0;
-}
-
-// LCOV_EXCL_START Reason: this function is tested in one_element_list_negative_test but marked as not covered.
-uint
-SentinelRuntimeState::getVariable(uint var_id) const
-{
-    dbgAssert(false) << AlertInfo(AlertTeam::CORE, "keywords") << "Could not find the variable ID: " << var_id;
-    return 0;
-}
-// LCOV_EXCL_STOP
-
-class SentinelKeyword : public SingleKeyword
-{
-public:
-    MatchStatus
-    isMatch() const
-    {
-        SentinelRuntimeState curr_state;
-        return runNext(&curr_state);
-    }
-
-private:
-    // LCOV_EXCL_START Reason: Unreachable function.
-    MatchStatus
-    isMatch(const I_KeywordRuntimeState *state) const override
-    {
-        return runNext(state);
-    }
-    // LCOV_EXCL_STOP
-};
-
 class KeywordComp::Impl : Singleton::Provide<I_KeywordsRule>::From<KeywordComp>
 {
 public:
@@ -154,7 +119,13 @@ private:
     class KeywordsRuleImpl : public VirtualRule
     {
     public:
-        bool isMatch() const override { return start.isMatch() == MatchStatus::Match; }
+        bool
+        isMatch() const override
+        {
+            if (keywords.empty()) return true;
+            KeywordRuntimeState state(known_vars);
+            return keywords.front()->isMatch(state) == MatchStatus::Match;
+        }
 
         static unique_ptr<KeywordsRuleImpl>
         genRule(const string &rule)
@@ -169,18 +140,22 @@ private:
 
             if (rule[pos]!=';') throw KeywordError(rule + " - end of text pass rule");
 
-            VariablesMapping known_vars;
-
             auto key_vec = split(rule, ";");
             for (auto &keyword : key_vec) {
-                res->start.appendKeyword(getKeywordByName(keyword, known_vars));
+                res->keywords.push_back(getKeywordByName(keyword, res->known_vars));
+            }
+
+            // Variables and contexts were assigned their slots while parsing, so only the order is left to resolve
+            for (uint index = 1; index < res->keywords.size(); index++) {
+                res->keywords[index - 1]->setNext(res->keywords[index].get());
             }
 
             return res;
         }
 
     private:
-        SentinelKeyword start;
+        VariablesMapping known_vars;
+        vector<unique_ptr<SingleKeyword>> keywords;
     };
 };
 
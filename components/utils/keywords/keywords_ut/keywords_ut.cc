@@ -72,6 +72,16 @@ TEST_F(KeywordsRuleTest, data_relative_test) {
     EXPECT_TRUE(ruleRun("data: \"234\", part HTTP_RESPONSE_BODY; data: \"567\", part HTTP_RESPONSE_BODY, relative;"));
 }
 
+TEST_F(KeywordsRuleTest, data_relative_to_default_part_test) {
+    appendBuffer("HTTP_RESPONSE_BODY", "1234567890");
+    appendBuffer("HTTP_REQUEST_BODY", "1234567890");
+
+    EXPECT_TRUE(ruleRun("data: \"234\", part HTTP_RESPONSE_BODY; data: \"567\", relative;", "HTTP_RESPONSE_BODY"));
+    EXPECT_FALSE(ruleRun("data: \"567\", part HTTP_RESPONSE_BODY; data: \"234\", relative;", "HTTP_RESPONSE_BODY"));
+    EXPECT_FALSE(ruleRun("data: \"567\"; data: \"234\", part HTTP_RESPONSE_BODY, relative;", "HTTP_RESPONSE_BODY"));
+    EXPECT_TRUE(ruleRun("data: \"567\", part HTTP_RESPONSE_BODY; data: \"234\", relative;", "HTTP_REQUEST_BODY"));
+}
+
 TEST_F(KeywordsRuleTest, data_depth_test) {
     appendBuffer("HTTP_RESPONSE_BODY", "1234567890");
 
@@ -120,6 +130,68 @@ TEST_F(KeywordsRuleTest, data_part_test) {
     EXPECT_FALSE(ruleRun("data: \"345\", part HTTP_REQUEST_BODY; data: \"cde\", part HTTP_REQUEST_BODY;"));
 }
 
+TEST_F(KeywordsRuleTest, data_single_byte_test) {
+    appendBuffer("HTTP_RESPONSE_BODY", "1234567890");
+
+    EXPECT_TRUE(ruleRun("data: \"7\", part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"7\", depth 7, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"7\", depth 6, part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"|37|\", nocase, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"a\", part HTTP_RESPONSE_BODY;"));
+}
+
+TEST_F(KeywordsRuleTest, data_nocase_long_buffer_test) {
+    appendBuffer("HTTP_RESPONSE_BODY", "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxXxXXxxxSeLeCt * FROM users");
+
+    EXPECT_TRUE(ruleRun("data: \"select\", nocase, part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"USERS\", nocase, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"select\", part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"select\", nocase, depth 46, part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"select\", nocase, depth 49, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"xselectx\", nocase, part HTTP_RESPONSE_BODY;"));
+}
+
+TEST_F(KeywordsRuleTest, data_nocase_caret_test) {
+    appendBuffer("HTTP_RESPONSE_BODY", "GET /index.html");
+
+    EXPECT_TRUE(ruleRun("data: \"get\", nocase, caret, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"get\", caret, part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"/INDEX\", nocase, caret, offset 4, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"/INDEX\", nocase, caret, offset 3, part HTTP_RESPONSE_BODY;"));
+}
+
+TEST_F(KeywordsRuleTest, data_split_buffer_test) {
+    appendBuffer("HTTP_RESPONSE_BODY", "12345");
+    appendBuffer("HTTP_RESPONSE_BODY", "67890");
+
+    EXPECT_TRUE(ruleRun("data: \"456\", part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"4567\", nocase, part HTTP_RESPONSE_BODY;"));
+    EXPECT_TRUE(ruleRun("data: \"567\", caret, offset 4, part HTTP_RESPONSE_BODY;"));
+    EXPECT_FALSE(ruleRun("data: \"568\", part HTTP_RESPONSE_BODY;"));
+}
+
+TEST_F(KeywordsRuleTest, data_repeated_match_test) {
+    appendBuffer("HTTP_RESPONSE_BODY", "key=a;key=b;key=c;");
+
+    EXPECT_TRUE(
+        ruleRun("data: \"key=\", part HTTP_RESPONSE_BODY; data: \"c\", part HTTP_RESPONSE_BODY, relative, depth 1;")
+    );
+    EXPECT_TRUE(
+        ruleRun(
+            "data: \"KEY=\", nocase, part HTTP_RESPONSE_BODY; data: \"b\", part HTTP_RESPONSE_BODY, relative, depth 1;"
+        )
+    );
+    EXPECT_FALSE(
+        ruleRun("data: \"key=\", part HTTP_RESPONSE_BODY; data: \"d\", part HTTP_RESPONSE_BODY, relative, depth 1;")
+    );
+    EXPECT_FALSE(ruleRun("data: \"aa\", part HTTP_RESPONSE_BODY;"));
+}
+
+TEST_F(KeywordsRuleTest, data_empty_pattern_test) {
+    EXPECT_EQ(ruleCompileFail("data: \"\";"), "No input for the 'data' keyword");
+    EXPECT_EQ(ruleCompileFail("data: \"||\";"), "No input for the 'data' keyword");
+}
+
 TEST_F(KeywordsRuleTest, pcre_basic_test) {
     appendBuffer("HTTP_RESPONSE_BODY", "1234567890");
 
@@ -972,7 +1044,7 @@ TEST_F(KeywordsRuleTest, stateop)
     EXPECT_CALL(table, createStateRValueRemoved(_, _))
         .WillOnce(testing::DoAll(
             testing::Invoke(
-                [&] (const type_index &, std::unique_ptr<TableOpaqueBase> &other)
+                [&] (uint, std::unique_ptr<TableOpaqueBase> &other)
                 {
                     opq = std::move(other);
                     opq_ptr = opq.get();
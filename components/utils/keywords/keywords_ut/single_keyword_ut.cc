@@ -1,16 +1,14 @@
-#include "../sentinel_runtime_state.h"
 #include "../single_keyword.h"
 #include "cptest.h"
-#include <list>
+#include "environment.h"
+#include "mock/mock_mainloop.h"
+#include "mock/mock_time_get.h"
 
 using namespace std;
 using namespace testing;
 
-#define FIRST_VARIABLE_ID 1
 #define FIRST_VARIABLE_VAL 2u
-#define SECOND_VARIABLE_ID 3
 #define SECOND_VARIABLE_VAL 4u
-#define THIRD_VARIABLE_ID 5
 #define THIRD_VARIABLE_VAL 6u
 
 #define FIRST_OFFSET 4u
@@ -19,153 +17,167 @@ using namespace testing;
 
 const static unsigned int zero = 0;
 
-class I_KeywordRuntimeStateTest : public Test
+class KeywordRuntimeStateTest : public Test
 {
 public:
-    //  Constructs SentinelKeyword as head because it is the only I_KeywordRuntimeState implementation
-    //  that does not hold I_KeywordRuntimeState *prev
-    I_KeywordRuntimeStateTest() : list_head(&sentinel) {}
-
-    uint
-    getOffset(const string &id)
-    {
-        return list_head->getOffset(id);
-    }
-
-    uint
-    getVariable(uint requested_var_id)
-    {
-        return list_head->getVariable(requested_var_id);
-    }
-
-    void
-    addOffsetState(const string &_ctx, uint _offset)
-    {
-        offset_list.push_front(make_unique<OffsetRuntimeState>(list_head, _ctx, _offset));
-        list_head = offset_list.front().get();
-    }
-
-    void
-    addVariableState(uint _var_id, uint _val)
+    KeywordRuntimeStateTest()
     {
-        variable_list.push_front(make_unique<VariableRuntimeState>(list_head, _var_id, _val));
-        list_head = variable_list.front().get();
+        ctx.registerValue(I_KeywordsRule::getKeywordsRuleTag(), string("HTTP_METHOD"));
+        first_var = mapping.addNewVariable("first");
+        second_var = mapping.addNewVariable("second");
+        third_var = mapping.addNewVariable("third");
+        url_slot = mapping.addContext("HTTP_COMPLETE_URL_ENCODED");
+        cookie_slot = mapping.addContext("HTTP_REQ_COOKIE");
+        method_slot = mapping.addContext("HTTP_METHOD");
     }
 
-private:
-    list<unique_ptr<VariableRuntimeState>> variable_list;
-    list<unique_ptr<OffsetRuntimeState>> offset_list;
-    SentinelRuntimeState sentinel;
-    I_KeywordRuntimeState *list_head;
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_timer;
+    ::Environment env;
+    ScopedContext ctx;
+    VariablesMapping mapping;
+    uint first_var;
+    uint second_var;
+    uint third_var;
+    uint url_slot;
+    uint cookie_slot;
+    uint method_slot;
 };
 
-TEST_F(I_KeywordRuntimeStateTest, one_element_list_positive_test) {
-    EXPECT_EQ(getOffset("HTTP_METHOD"), zero);
-    EXPECT_EQ(getOffset("HTTP_REQ_COOKIE"), zero);
-    EXPECT_EQ(getOffset("HTTP_REQUEST_HEADERS"), zero);
-}
-
-TEST_F(I_KeywordRuntimeStateTest, one_variable_state_list_positive_test) {
-    addVariableState(FIRST_VARIABLE_ID, FIRST_VARIABLE_VAL);
-    EXPECT_EQ(getOffset("HTTP_COMPLETE_URL_ENCODED"), zero);
-    EXPECT_EQ(getOffset("HTTP_METHOD"), zero);
-    EXPECT_EQ(getVariable(FIRST_VARIABLE_ID), FIRST_VARIABLE_VAL);
+TEST_F(KeywordRuntimeStateTest, context_slots)
+{
+    EXPECT_EQ(mapping.addContext("HTTP_REQ_COOKIE"), cookie_slot);
+    EXPECT_NE(url_slot, KeywordRuntimeState::default_ctx_slot);
+    EXPECT_NE(url_slot, cookie_slot);
+    EXPECT_THAT(
+        mapping.getContexts(),
+        ElementsAre("", "HTTP_COMPLETE_URL_ENCODED", "HTTP_REQ_COOKIE", "HTTP_METHOD")
+    );
 }
 
-TEST_F(I_KeywordRuntimeStateTest, one_offset_state_list_positive_test) {
-    EXPECT_EQ(getOffset("HTTP_REQUEST_HEADERS"), zero);
-    addOffsetState("HTTP_REQUEST_HEADERS", FIRST_OFFSET);
-    EXPECT_EQ(getOffset("HTTP_REQUEST_HEADERS"), FIRST_OFFSET);
+TEST_F(KeywordRuntimeStateTest, initial_state)
+{
+    KeywordRuntimeState state(mapping);
+    EXPECT_EQ(state.getOffset(KeywordRuntimeState::default_ctx_slot), zero);
+    EXPECT_EQ(state.getOffset(url_slot), zero);
+    EXPECT_EQ(state.getOffset(cookie_slot), zero);
+    EXPECT_EQ(state.getVariable(first_var), zero);
+    EXPECT_EQ(state.getContextName(KeywordRuntimeState::default_ctx_slot), "HTTP_METHOD");
+    EXPECT_EQ(state.getContextName(cookie_slot), "HTTP_REQ_COOKIE");
 }
 
-TEST_F(I_KeywordRuntimeStateTest, one_element_list_negative_test) {
+TEST_F(KeywordRuntimeStateTest, unknown_variable)
+{
+    KeywordRuntimeState state(mapping);
     cptestPrepareToDie();
-    EXPECT_DEATH(getVariable(FIRST_OFFSET), "");
-    EXPECT_DEATH(getVariable(SECOND_OFFSET), "");
-    EXPECT_DEATH(getVariable(THIRD_OFFSET), "");
+    EXPECT_DEATH(state.getVariable(FIRST_OFFSET), "");
+    EXPECT_DEATH(state.getVariable(SECOND_OFFSET), "");
+    EXPECT_DEATH(state.getVariable(THIRD_OFFSET), "");
 }
 
-TEST_F(I_KeywordRuntimeStateTest, variable_runtime_state_list_positive_test) {
-    //  Notice that variables ids and values are different
-    addVariableState(FIRST_VARIABLE_ID, FIRST_VARIABLE_VAL);
-    addVariableState(SECOND_VARIABLE_ID, SECOND_VARIABLE_VAL);
-    addVariableState(THIRD_VARIABLE_ID, THIRD_VARIABLE_VAL);
-
-    EXPECT_EQ(getOffset("HTTP_METHOD"), zero);
-    EXPECT_EQ(getOffset("HTTP_COMPLETE_URL_ENCODED"), zero);
-    EXPECT_EQ(getOffset("HTTP_REQ_COOKIE"), zero);
-    EXPECT_EQ(getOffset("HTTP_REQUEST_HEADERS"), zero);
-    EXPECT_EQ(getOffset("HTTP_REQUEST_BODY"), zero);
-
-    EXPECT_EQ(getVariable(FIRST_VARIABLE_ID), FIRST_VARIABLE_VAL);
-    EXPECT_EQ(getVariable(SECOND_VARIABLE_ID), SECOND_VARIABLE_VAL);
-    EXPECT_EQ(getVariable(THIRD_VARIABLE_ID), THIRD_VARIABLE_VAL);
+TEST_F(KeywordRuntimeStateTest, variables)
+{
+    KeywordRuntimeState state(mapping);
+    ScopedVariable first(state, first_var, FIRST_VARIABLE_VAL);
+    ScopedVariable second(state, second_var, SECOND_VARIABLE_VAL);
+    ScopedVariable third(state, third_var, THIRD_VARIABLE_VAL);
+
+    EXPECT_EQ(state.getOffset(url_slot), zero);
+    EXPECT_EQ(state.getOffset(cookie_slot), zero);
+
+    EXPECT_EQ(state.getVariable(first_var), FIRST_VARIABLE_VAL);
+    EXPECT_EQ(state.getVariable(second_var), SECOND_VARIABLE_VAL);
+    EXPECT_EQ(state.getVariable(third_var), THIRD_VARIABLE_VAL);
 }
 
-TEST_F(I_KeywordRuntimeStateTest, OffsetRuntimeState_list_negative_test) {
-    addOffsetState("HTTP_COMPLETE_URL_ENCODED", FIRST_OFFSET);
-    addOffsetState("HTTP_REQ_COOKIE", SECOND_OFFSET);
-    addOffsetState("HTTP_METHOD", THIRD_OFFSET);
+TEST_F(KeywordRuntimeStateTest, offsets)
+{
+    KeywordRuntimeState state(mapping);
+    ScopedOffset url(state, url_slot, FIRST_OFFSET);
+    ScopedOffset cookie(state, cookie_slot, SECOND_OFFSET);
 
-    cptestPrepareToDie();
-    EXPECT_DEATH(getVariable(FIRST_OFFSET), "");
-    EXPECT_DEATH(getVariable(SECOND_OFFSET), "");
-    EXPECT_DEATH(getVariable(THIRD_OFFSET), "");
+    EXPECT_EQ(state.getOffset(url_slot), FIRST_OFFSET);
+    EXPECT_EQ(state.getOffset(cookie_slot), SECOND_OFFSET);
+    EXPECT_EQ(state.getOffset(KeywordRuntimeState::default_ctx_slot), zero);
 }
 
-TEST_F(I_KeywordRuntimeStateTest, offset_runtime_state_list_positive_test) {
-    EXPECT_EQ(getOffset("HTTP_REQUEST_HEADERS"), zero);
-    EXPECT_EQ(getOffset("HTTP_REQ_COOKIE"), zero);
+TEST_F(KeywordRuntimeStateTest, offset_shadowing)
+{
+    KeywordRuntimeState state(mapping);
+    ScopedOffset url(state, url_slot, FIRST_OFFSET);
+    EXPECT_EQ(state.getOffset(url_slot), FIRST_OFFSET);
 
-    addOffsetState("HTTP_REQUEST_HEADERS", FIRST_OFFSET);
-    addOffsetState("HTTP_REQ_COOKIE", SECOND_OFFSET);
+    {
+        ScopedVariable second(state, second_var, SECOND_VARIABLE_VAL);
+        ScopedOffset inner_url(state, url_slot, THIRD_OFFSET);
+        EXPECT_EQ(state.getOffset(url_slot), THIRD_OFFSET);
+    }
 
-    EXPECT_EQ(getOffset("HTTP_REQUEST_HEADERS"), FIRST_OFFSET);
-    EXPECT_EQ(getOffset("HTTP_REQ_COOKIE"), SECOND_OFFSET);
+    EXPECT_EQ(state.getOffset(url_slot), FIRST_OFFSET);
+    EXPECT_EQ(state.getVariable(second_var), zero);
 }
 
-TEST_F(I_KeywordRuntimeStateTest, mixed_types_list_positive_test) {
-    EXPECT_EQ(getOffset("HTTP_COMPLETE_URL_ENCODED"), zero);
-    EXPECT_EQ(getOffset("HTTP_METHOD"), zero);
-
-    addOffsetState("HTTP_COMPLETE_URL_ENCODED", FIRST_OFFSET);
-    addVariableState(SECOND_VARIABLE_ID, SECOND_VARIABLE_VAL);
-    addOffsetState("HTTP_METHOD", THIRD_OFFSET);
+TEST_F(KeywordRuntimeStateTest, variable_shadowing)
+{
+    KeywordRuntimeState state(mapping);
+    ScopedVariable first(state, first_var, FIRST_VARIABLE_VAL);
+    EXPECT_EQ(state.getVariable(first_var), FIRST_VARIABLE_VAL);
 
-    EXPECT_EQ(getOffset("HTTP_COMPLETE_URL_ENCODED"), FIRST_OFFSET);
-    EXPECT_EQ(getOffset("HTTP_METHOD"), THIRD_OFFSET);
+    {
+        ScopedOffset url(state, url_slot, SECOND_OFFSET);
+        ScopedVariable inner_first(state, first_var, THIRD_VARIABLE_VAL);
+        EXPECT_EQ(state.getVariable(first_var), THIRD_VARIABLE_VAL);
+    }
 
-    EXPECT_EQ(getVariable(SECOND_VARIABLE_ID), SECOND_VARIABLE_VAL);
+    EXPECT_EQ(state.getVariable(first_var), FIRST_VARIABLE_VAL);
+    EXPECT_EQ(state.getOffset(url_slot), zero);
 }
 
-TEST_F(I_KeywordRuntimeStateTest, mixed_types_list_negative_test) {
-    addOffsetState("HTTP_COMPLETE_URL_ENCODED", FIRST_OFFSET);
-    addVariableState(SECOND_VARIABLE_ID, SECOND_VARIABLE_VAL);
-    addOffsetState("HTTP_METHOD", THIRD_OFFSET);
+TEST_F(KeywordRuntimeStateTest, default_context_shares_explicit_slot)
+{
+    KeywordRuntimeState state(mapping);
+    ScopedOffset method(state, method_slot, FIRST_OFFSET);
+    EXPECT_EQ(state.getOffset(KeywordRuntimeState::default_ctx_slot), FIRST_OFFSET);
 
-    cptestPrepareToDie();
-    EXPECT_DEATH(getVariable(FIRST_OFFSET), "");
-    EXPECT_DEATH(getVariable(THIRD_OFFSET), "");
+    ScopedOffset default_ctx(state, KeywordRuntimeState::default_ctx_slot, SECOND_OFFSET);
+    EXPECT_EQ(state.getOffset(method_slot), SECOND_OFFSET);
 }
 
-TEST_F(I_KeywordRuntimeStateTest, mixed_types_list_offset_shadowing_test) {
-    addOffsetState("HTTP_COMPLETE_URL_ENCODED", FIRST_OFFSET);
-
-    EXPECT_EQ(getOffset("HTTP_COMPLETE_URL_ENCODED"), FIRST_OFFSET);
+TEST_F(KeywordRuntimeStateTest, buffers)
+{
+    ctx.registerValue("HTTP_REQ_COOKIE", Buffer("cookie"));
+    KeywordRuntimeState state(mapping);
 
-    addVariableState(SECOND_VARIABLE_ID, SECOND_VARIABLE_VAL);
-    addOffsetState("HTTP_COMPLETE_URL_ENCODED", THIRD_OFFSET);
+    auto cookie = state.getBuffer(cookie_slot);
+    ASSERT_NE(cookie, nullptr);
+    EXPECT_EQ(*cookie, Buffer("cookie"));
+    EXPECT_EQ(state.getBuffer(cookie_slot), cookie);
 
-    EXPECT_EQ(getOffset("HTTP_COMPLETE_URL_ENCODED"), THIRD_OFFSET);
+    EXPECT_EQ(state.getBuffer(url_slot), nullptr);
+    EXPECT_EQ(state.getBuffer(KeywordRuntimeState::default_ctx_slot), nullptr);
 }
 
-TEST_F(I_KeywordRuntimeStateTest, mixed_types_list_variable_shadowing_test) {
-    addVariableState(FIRST_VARIABLE_ID, FIRST_VARIABLE_VAL);
-
-    EXPECT_EQ(getVariable(FIRST_VARIABLE_ID), FIRST_VARIABLE_VAL);
+TEST_F(KeywordRuntimeStateTest, more_slots_than_inline_storage)
+{
+    vector<uint> vars;
+    for (uint i = 0; i <= SlotArray<uint>::inline_size; i++) {
+        vars.push_back(mapping.addNewVariable("var" + to_string(i)));
+    }
+    KeywordRuntimeState state(mapping);
 
-    addOffsetState("HTTP_COMPLETE_URL_ENCODED", SECOND_OFFSET);
-    addVariableState(FIRST_VARIABLE_ID, THIRD_VARIABLE_VAL);
+    for (uint i = 0; i < vars.size(); i++) state.setVariable(vars[i], i + 1);
+    for (uint i = 0; i < vars.size(); i++) EXPECT_EQ(state.getVariable(vars[i]), i + 1);
+    EXPECT_EQ(state.getVariable(first_var), zero);
+}
 
-    EXPECT_EQ(getVariable(FIRST_VARIABLE_ID), THIRD_VARIABLE_VAL);
+TEST_F(KeywordRuntimeStateTest, default_context_is_resolved_on_use)
+{
+    ScopedContext other_ctx;
+    KeywordRuntimeState state(mapping);
+    other_ctx.registerValue(I_KeywordsRule::getKeywordsRuleTag(), string("HTTP_REQ_COOKIE"));
+
+    ScopedOffset default_ctx(state, KeywordRuntimeState::default_ctx_slot, FIRST_OFFSET);
+    EXPECT_EQ(state.getContextName(KeywordRuntimeState::default_ctx_slot), "HTTP_REQ_COOKIE");
+    EXPECT_EQ(state.getOffset(cookie_slot), FIRST_OFFSET);
+    EXPECT_EQ(state.getOffset(method_slot), zero);
 }
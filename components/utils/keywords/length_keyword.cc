@@ -14,27 +14,27 @@ class LengthKeyword : public SingleKeyword
 {
 public:
     explicit LengthKeyword(const vector<KeywordAttr> &attr, VariablesMapping &vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState* prev) const override;
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     enum class Mode { EXACT, MIN, MAX, COUNT };
     using ModeFlags = Flags<Mode>;
 
     void
-    setRelative(const KeywordAttr &attr, const VariablesMapping &)
+    setRelative(const KeywordAttr &attr, VariablesMapping &)
     {
         is_relative.setAttr(attr, "length");
     }
 
     void
-    setExact(const KeywordAttr &, const VariablesMapping &)
+    setExact(const KeywordAttr &, VariablesMapping &)
     {
         if (!mode.empty()) throw KeywordError("Redefining 'length' keyword operation");
         mode.setFlag(Mode::EXACT);
     }
 
     void
-    setMin(const KeywordAttr &, const VariablesMapping &)
+    setMin(const KeywordAttr &, VariablesMapping &)
     {
         if (!mode.empty()) throw KeywordError("Redefining 'length' keyword operation");
         mode.setFlag(Mode::MIN);
@@ -42,7 +42,7 @@ private:
 
 
     void
-    setMax(const KeywordAttr &, const VariablesMapping &)
+    setMax(const KeywordAttr &, VariablesMapping &)
     {
         if (!mode.empty()) throw KeywordError("Redefining 'length' keyword operation");
         mode.setFlag(Mode::MAX);
@@ -50,9 +50,9 @@ private:
 
 
     void
-    setContext(const KeywordAttr &attr, const VariablesMapping &)
+    setContext(const KeywordAttr &attr, VariablesMapping &vars)
     {
-        ctx.setAttr(attr, "length");
+        ctx.setAttr(attr, vars, "length");
     }
 
     bool
@@ -67,10 +67,10 @@ private:
     uint        var_id;
     NumericAttr compare_size;
 
-    static const map<string, void(LengthKeyword::*)(const KeywordAttr &, const VariablesMapping &)> setops;
+    static const map<string, void(LengthKeyword::*)(const KeywordAttr &, VariablesMapping &)> setops;
 };
 
-const map<string, void(LengthKeyword::*)(const KeywordAttr &, const VariablesMapping &)> LengthKeyword::setops = {
+const map<string, void(LengthKeyword::*)(const KeywordAttr &, VariablesMapping &)> LengthKeyword::setops = {
     { "relative",   &LengthKeyword::setRelative },
     { "exact",      &LengthKeyword::setExact    },
     { "min",        &LengthKeyword::setMin      },
@@ -129,25 +129,25 @@ LengthKeyword::LengthKeyword(const vector<KeywordAttr> &attrs, VariablesMapping
 }
 
 MatchStatus
-LengthKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+LengthKeyword::isMatch(KeywordRuntimeState &state) const
 {
-    auto part = Singleton::Consume<I_Environment>::by<KeywordComp>()->get<Buffer>(static_cast<string>(ctx));
+    auto part = state.getBuffer(ctx.getSlot());
 
-    if (!part.ok()) return MatchStatus::NoMatchFinal;
+    if (part == nullptr) return MatchStatus::NoMatchFinal;
 
-    uint offset = is_relative ? prev->getOffset(ctx) : 0;
+    uint offset = is_relative ? state.getOffset(ctx.getSlot()) : 0;
     uint size = (*part).size();
 
     if (offset <= size) {
         if (mode.isSet(Mode::EXACT)) {
-            if (size - offset == static_cast<uint>(compare_size.evalAttr(prev))) return runNext(prev);
+            if (size - offset == static_cast<uint>(compare_size.evalAttr(state))) return runNext(state);
         } else if (mode.isSet(Mode::MIN)) {
-            if (size - offset >= static_cast<uint>(compare_size.evalAttr(prev))) return runNext(prev);
+            if (size - offset >= static_cast<uint>(compare_size.evalAttr(state))) return runNext(state);
         } else if (mode.isSet(Mode::MAX)) {
-            if (size - offset <= static_cast<uint>(compare_size.evalAttr(prev))) return runNext(prev);
+            if (size - offset <= static_cast<uint>(compare_size.evalAttr(state))) return runNext(state);
         } else {
-            VariableRuntimeState new_length_var(prev, var_id, size-offset);
-            return runNext(&new_length_var);
+            ScopedVariable new_length_var(state, var_id, size-offset);
+            return runNext(state);
         }
     }
 
@@ -19,7 +19,7 @@ public:
         if (!attr.empty()) throw KeywordError("The 'no_match' keyword doesn't take attributes");
     }
 
-    MatchStatus isMatch(const I_KeywordRuntimeState *) const override { return MatchStatus::NoMatchFinal; }
+    MatchStatus isMatch(KeywordRuntimeState &) const override { return MatchStatus::NoMatchFinal; }
 };
 
 unique_ptr<SingleKeyword>
@@ -15,38 +15,38 @@ USE_DEBUG_FLAG(D_KEYWORD);
 class PCREKeyword : public SingleKeyword
 {
 public:
-    explicit PCREKeyword(const vector<KeywordAttr> &attr, const VariablesMapping &known_vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState *prev) const override;
+    explicit PCREKeyword(const vector<KeywordAttr> &attr, VariablesMapping &known_vars);
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     void
-    setOffset(const KeywordAttr &attr, const VariablesMapping &vars)
+    setOffset(const KeywordAttr &attr, VariablesMapping &vars)
     {
         offset.setAttr(attr, vars, "pcre");
     }
 
     void
-    setDepth(const KeywordAttr &attr, const VariablesMapping &vars)
+    setDepth(const KeywordAttr &attr, VariablesMapping &vars)
     {
         depth.setAttr(attr, vars, "pcre");
     }
 
     void
-    setRelative(const KeywordAttr &attr, const VariablesMapping &)
+    setRelative(const KeywordAttr &attr, VariablesMapping &)
     {
         is_relative.setAttr(attr, "pcre");
     }
 
     void
-    setCaseInsensitive(const KeywordAttr &attr, const VariablesMapping &)
+    setCaseInsensitive(const KeywordAttr &attr, VariablesMapping &)
     {
         is_case_insensitive.setAttr(attr, "pcre");
     }
 
     void
-    setContext(const KeywordAttr &attr, const VariablesMapping &)
+    setContext(const KeywordAttr &attr, VariablesMapping &vars)
     {
-        ctx.setAttr(attr, "pcre");
+        ctx.setAttr(attr, vars, "pcre");
     }
 
     string parseString(const string &str);
@@ -54,7 +54,7 @@ private:
     void parseOptions(const string &str);
     void compilePCRE(const string &str);
 
-    pair<uint, uint> getStartOffsetAndLength(uint buf_size, const I_KeywordRuntimeState *prev) const;
+    pair<uint, uint> getStartOffsetAndLength(uint buf_size, const KeywordRuntimeState &state) const;
 
     bool
     isConstant() const
@@ -101,10 +101,10 @@ private:
 
     string pcre_expr;
 
-    static const map<string, void(PCREKeyword::*)(const KeywordAttr &, const VariablesMapping &)> setops;
+    static const map<string, void(PCREKeyword::*)(const KeywordAttr &, VariablesMapping &)> setops;
 };
 
-const map<string, void(PCREKeyword::*)(const KeywordAttr&, const VariablesMapping&)> PCREKeyword::setops = {
+const map<string, void(PCREKeyword::*)(const KeywordAttr&, VariablesMapping &)> PCREKeyword::setops = {
     { "relative", &PCREKeyword::setRelative        },
     { "offset",   &PCREKeyword::setOffset          },
     { "depth",    &PCREKeyword::setDepth           },
@@ -112,7 +112,7 @@ const map<string, void(PCREKeyword::*)(const KeywordAttr&, const VariablesMappin
     { "part",     &PCREKeyword::setContext         },
 };
 
-PCREKeyword::PCREKeyword(const vector<KeywordAttr> &attrs, const VariablesMapping &known_vars)
+PCREKeyword::PCREKeyword(const vector<KeywordAttr> &attrs, VariablesMapping &known_vars)
         :
     offset(),
     depth()
@@ -278,40 +278,40 @@ addOffset(uint offset, int add)
 }
 
 pair<uint, uint>
-PCREKeyword::getStartOffsetAndLength(uint buf_size, const I_KeywordRuntimeState *prev) const
+PCREKeyword::getStartOffsetAndLength(uint buf_size, const KeywordRuntimeState &state) const
 {
-    uint keyword_offset = is_relative?prev->getOffset(ctx):0;
-    uint start_offset = addOffset(keyword_offset, offset.evalAttr(prev));
+    uint keyword_offset = is_relative?state.getOffset(ctx.getSlot()):0;
+    uint start_offset = addOffset(keyword_offset, offset.evalAttr(state));
 
     if (start_offset>=buf_size) return make_pair(0, 0);
 
     uint length = buf_size-start_offset;
 
     if (depth.isSet()) {
-        length = min(length, static_cast<uint>(depth.evalAttr(prev)));
+        length = min(length, static_cast<uint>(depth.evalAttr(state)));
     }
 
     return make_pair(start_offset, length);
 }
 
 MatchStatus
-PCREKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+PCREKeyword::isMatch(KeywordRuntimeState &state) const
 {
     dbgAssert(pcre_machine!=nullptr)
         << AlertInfo(AlertTeam::CORE, "keywords")
         << "Trying to run on an uninitialized keyword 'pcre'";
 
-    auto part = Singleton::Consume<I_Environment>::by<KeywordComp>()->get<Buffer>(static_cast<string>(ctx));
+    auto part = state.getBuffer(ctx.getSlot());
 
-    if (!part.ok()) {
+    if (part == nullptr) {
         if (is_negative) {
-            return runNext(prev);
+            return runNext(state);
         }
         return MatchStatus::NoMatchFinal;
     }
 
     uint offset, length;
-    tie(offset, length) = getStartOffsetAndLength((*part).size(), prev);
+    tie(offset, length) = getStartOffsetAndLength((*part).size(), state);
     auto buf = (*part).getPtr(offset, length);
 
     if (!buf.ok()) {
@@ -348,15 +348,15 @@ PCREKeyword::isMatch(const I_KeywordRuntimeState *prev) const
         }
         match_found = true;
         buf_offset_found = pcre2_get_ovector_pointer(pcre_result.get())[0];
-        OffsetRuntimeState new_offset(prev, ctx, offset+buf_offset_found);
-        auto next_keyword_result = runNext(&new_offset);
+        ScopedOffset new_offset(state, ctx.getSlot(), offset+buf_offset_found);
+        auto next_keyword_result = runNext(state);
         if (next_keyword_result!=MatchStatus::NoMatch) return next_keyword_result;
         if (buf_offset_found<=buf_pos) buf_offset_found = buf_pos+1; // Deal with empty matches
     }
 
     // No matchs is a success for negative keywords
     if (is_negative && !match_found) {
-        return runNext(prev);
+        return runNext(state);
     }
 
     // If there were no matchs and the keyword is an effected by other keywords, then we know that the rule won't match
@@ -4,71 +4,95 @@
 
 using namespace std;
 
+KeywordRuntimeState::KeywordRuntimeState(const VariablesMapping &mapping)
+        :
+    contexts(mapping.getContexts()),
+    offsets(contexts.size()),
+    variables(mapping.getNumOfVariables()),
+    buffers(contexts.size()),
+    buffers_status(contexts.size())
+{
+}
+
 void
-SingleKeyword::appendKeyword(unique_ptr<SingleKeyword> &&_next)
+KeywordRuntimeState::resolveDefaultContext() const
 {
-    if (next==nullptr) {
-        next = move(_next);
+    is_default_ctx_resolved = true;
+
+    auto env = Singleton::Consume<I_Environment>::by<KeywordComp>();
+    static const EnvKey<string> rule_default_ctx_key(I_KeywordsRule::getKeywordsRuleTag());
+    auto rule_default_ctx = env->get(rule_default_ctx_key);
+    if (rule_default_ctx.ok()) {
+        default_ctx = rule_default_ctx.unpackMove();
     } else {
-        next->appendKeyword(move(_next));
+        dbgError(D_KEYWORD) << "Running keyword rule without specific context and without default";
+        default_ctx = "Missing Default Context";
     }
-}
 
-MatchStatus
-SingleKeyword::runNext(const I_KeywordRuntimeState *curr) const
-{
-    if (next==nullptr) {
-        return MatchStatus::Match;
+    // Keywords that use the default context must share offsets with keywords that name the same context explicitly
+    for (uint slot = default_ctx_slot + 1; slot < contexts.size(); slot++) {
+        if (contexts[slot] == default_ctx) {
+            default_ctx_alias = slot;
+            break;
+        }
     }
-    return next->isMatch(curr);
 }
 
-OffsetRuntimeState::OffsetRuntimeState(
-    const I_KeywordRuntimeState *_p,
-    const string &_ctx,
-    uint _offset)
-        :
-    prev(_p),
-    ctx(_ctx),
-    offset(_offset)
+uint
+KeywordRuntimeState::setOffset(uint ctx_slot, uint offset)
 {
+    auto &curr_offset = offsets[resolveSlot(ctx_slot)];
+    auto prev_offset = curr_offset;
+    curr_offset = offset;
+    return prev_offset;
 }
 
 uint
-OffsetRuntimeState::getOffset(const string &requested_ctx) const
+KeywordRuntimeState::getVariable(uint var_id) const
 {
-    if (ctx==requested_ctx) return offset;
-    return prev->getOffset(requested_ctx);
+    if (var_id >= variables.getSize()) {
+        dbgAssert(false) << AlertInfo(AlertTeam::CORE, "keywords") << "Could not find the variable ID: " << var_id;
+        return 0;
+    }
+    return variables[var_id];
 }
 
 uint
-OffsetRuntimeState::getVariable(uint requested_var_id) const
+KeywordRuntimeState::setVariable(uint var_id, uint value)
 {
-    return prev->getVariable(requested_var_id);
+    dbgAssert(var_id < variables.getSize())
+        << AlertInfo(AlertTeam::CORE, "keywords")
+        << "Could not find the variable ID: "
+        << var_id;
+    auto prev_value = variables[var_id];
+    variables[var_id] = value;
+    return prev_value;
 }
 
-VariableRuntimeState::VariableRuntimeState(
-    const I_KeywordRuntimeState *_p,
-    uint _var_id,
-    uint _val)
-        :
-    prev(_p),
-    var_id(_var_id),
-    value(_val)
+const Buffer *
+KeywordRuntimeState::getBuffer(uint ctx_slot)
 {
-}
+    auto slot = resolveSlot(ctx_slot);
+    if (buffers_status[slot] == BufferStatus::Unknown) {
+        auto env = Singleton::Consume<I_Environment>::by<KeywordComp>();
+        auto part = env->get<Buffer>(getContextName(slot));
+        if (part.ok()) {
+            buffers[slot] = part.unpackMove();
+            buffers_status[slot] = BufferStatus::Found;
+        } else {
+            buffers_status[slot] = BufferStatus::Missing;
+        }
+    }
 
-uint
-VariableRuntimeState::getOffset(const string &requested_ctx) const
-{
-    return prev->getOffset(requested_ctx);
+    return buffers_status[slot] == BufferStatus::Found ? &buffers[slot] : nullptr;
 }
 
-uint
-VariableRuntimeState::getVariable(uint requested_var_id) const
+const string &
+KeywordRuntimeState::getContextName(uint ctx_slot) const
 {
-    if (var_id==requested_var_id) return value;
-    return prev->getVariable(requested_var_id);
+    if (ctx_slot != default_ctx_slot) return contexts[ctx_slot];
+    if (!is_default_ctx_resolved) resolveDefaultContext();
+    return default_ctx;
 }
 
 uint
@@ -81,6 +105,16 @@ VariablesMapping::addNewVariable(const string &param)
     return mapping[param];
 }
 
+uint
+VariablesMapping::addContext(const string &ctx)
+{
+    for (uint slot = KeywordRuntimeState::default_ctx_slot + 1; slot < contexts.size(); slot++) {
+        if (contexts[slot] == ctx) return slot;
+    }
+    contexts.push_back(ctx);
+    return contexts.size() - 1;
+}
+
 Maybe<uint>
 VariablesMapping::getVariableId(const string &param) const
 {
@@ -160,10 +194,10 @@ NumericAttr::setAttr(
 }
 
 int
-NumericAttr::evalAttr(const I_KeywordRuntimeState *prev) const
+NumericAttr::evalAttr(const KeywordRuntimeState &state) const
 {
     if (status==Status::Var) {
-        return prev->getVariable(val);
+        return state.getVariable(val);
     }
     return val;
 }
@@ -187,13 +221,13 @@ BoolAttr::setAttr(const string &keyword_name, const string &attr_name)
 }
 
 void
-CtxAttr::setAttr(const KeywordAttr &attr, const string &keyword_name)
+CtxAttr::setAttr(const KeywordAttr &attr, VariablesMapping &known_vars, const string &keyword_name)
 {
     if (is_set) throw KeywordError("Double definition of the 'part' in the '" + keyword_name + "' keyword");
     is_set = true;
     auto vec = attr.getParams();
     if (vec.size()!=2) throw KeywordError("Malformed 'part' in the '" + keyword_name + "' keyword");
-    ctx = vec[1];
+    slot = known_vars.addContext(vec[1]);
 }
 
 const map<string, ComparisonAttr::CompId> ComparisonAttr::name_to_operator {
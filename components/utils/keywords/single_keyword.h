@@ -1,6 +1,7 @@
 #ifndef ___SINGLE_KEYWORD_H__
 #define ___SINGLE_KEYWORD_H__
 
+#include <array>
 #include <map>
 #include <string>
 #include <vector>
@@ -74,58 +75,128 @@ private:
     std::vector<KeywordAttr> attr;
 };
 
-class I_KeywordRuntimeState
+class VariablesMapping
+{
+public:
+    uint addNewVariable(const std::string &name);
+    Maybe<uint> getVariableId(const std::string &name) const;
+    uint getNumOfVariables() const { return mapping.size(); }
+
+    // Contexts named by 'part' attributes get slots the same way variables get IDs.
+    // Slot 0 stands for the rule's default context, which is only known when the rule runs.
+    uint addContext(const std::string &ctx);
+    const std::vector<std::string> & getContexts() const { return contexts; }
+
+private:
+    std::map<std::string, uint> mapping;
+    std::vector<std::string> contexts{ "" };
+};
+
+// Per-slot storage of a rule evaluation. Rules use a handful of slots, so the storage is kept inline and only
+// rules that use more slots than that allocate.
+template <typename T>
+class SlotArray
 {
 public:
-    virtual uint getOffset(const std::string &ctx) const = 0;
-    virtual uint getVariable(uint requested_var_id) const = 0;
-protected:
-    virtual ~I_KeywordRuntimeState()
+    static constexpr uint inline_size = 8;
+
+    SlotArray(uint _size) : size(_size)
     {
+        if (size > inline_size) overflow = std::make_unique<T[]>(size);
     }
+
+    uint getSize() const { return size; }
+    T & operator[](uint index) { return getData()[index]; }
+    const T & operator[](uint index) const { return getData()[index]; }
+
+private:
+    T * getData() { return overflow != nullptr ? overflow.get() : inline_data.data(); }
+    const T * getData() const { return overflow != nullptr ? overflow.get() : inline_data.data(); }
+
+    uint size;
+    std::array<T, inline_size> inline_data{};
+    std::unique_ptr<T[]> overflow;
 };
 
-class OffsetRuntimeState : public I_KeywordRuntimeState
+// Runtime state of a single rule evaluation.
+// Offsets and variables are kept in flat arrays indexed by the slots assigned when the rule was compiled, and the
+// buffer of each context is fetched from the environment at most once per evaluation.
+class KeywordRuntimeState
 {
 public:
-    OffsetRuntimeState(const I_KeywordRuntimeState *prev, const std::string &ctx, uint offset);
-    virtual ~OffsetRuntimeState()
+    static constexpr uint default_ctx_slot = 0;
+
+    KeywordRuntimeState(const VariablesMapping &mapping);
+
+    uint getOffset(uint ctx_slot) const { return offsets[resolveSlot(ctx_slot)]; }
+    uint setOffset(uint ctx_slot, uint offset);
+    uint getVariable(uint var_id) const;
+    uint setVariable(uint var_id, uint value);
+    const Buffer * getBuffer(uint ctx_slot);
+    const std::string & getContextName(uint ctx_slot) const;
+
+private:
+    enum class BufferStatus { Unknown, Found, Missing };
+
+    uint
+    resolveSlot(uint ctx_slot) const
     {
+        if (ctx_slot != default_ctx_slot) return ctx_slot;
+        if (!is_default_ctx_resolved) resolveDefaultContext();
+        return default_ctx_alias;
     }
-    uint getOffset(const std::string &requested_ctx_id) const override;
-    uint getVariable(uint requested_var_id) const override;
 
-private:
-    const I_KeywordRuntimeState *prev;
-    std::string ctx;
-    uint offset;
+    void resolveDefaultContext() const;
+
+    const std::vector<std::string> &contexts;
+    // The rule's default context is only looked up if a keyword uses it
+    mutable bool is_default_ctx_resolved = false;
+    mutable std::string default_ctx;
+    mutable uint default_ctx_alias = default_ctx_slot;
+    SlotArray<uint> offsets;
+    SlotArray<uint> variables;
+    SlotArray<Buffer> buffers;
+    SlotArray<BufferStatus> buffers_status;
 };
 
-class VariableRuntimeState : public I_KeywordRuntimeState
+// Sets an offset for the keywords that follow, and restores the previous one when leaving the scope
+class ScopedOffset
 {
 public:
-    VariableRuntimeState(const I_KeywordRuntimeState *prev, uint var_id, uint val);
-    virtual ~VariableRuntimeState()
+    ScopedOffset(KeywordRuntimeState &_state, uint _ctx_slot, uint offset)
+            :
+        state(_state),
+        ctx_slot(_ctx_slot),
+        prev_offset(state.setOffset(ctx_slot, offset))
     {
     }
 
-    uint getOffset(const std::string &requested_ctx_id) const override;
-    uint getVariable(uint requested_var_id) const override;
+    ~ScopedOffset() { state.setOffset(ctx_slot, prev_offset); }
 
 private:
-    const I_KeywordRuntimeState *prev;
-    uint var_id;
-    uint value;
+    KeywordRuntimeState &state;
+    uint ctx_slot;
+    uint prev_offset;
 };
 
-class VariablesMapping
+// Sets a variable for the keywords that follow, and restores the previous value when leaving the scope
+class ScopedVariable
 {
 public:
-    uint addNewVariable(const std::string &name);
-    Maybe<uint> getVariableId(const std::string &name) const;
+    ScopedVariable(KeywordRuntimeState &_state, uint _var_id, uint value)
+            :
+        state(_state),
+        var_id(_var_id),
+        prev_value(state.setVariable(var_id, value))
+    {
+    }
+
+    ~ScopedVariable() { state.setVariable(var_id, prev_value); }
 
 private:
-    std::map<std::string, uint> mapping;
+    KeywordRuntimeState &state;
+    uint var_id;
+    uint prev_value;
 };
 
 class NumericAttr
@@ -147,7 +218,14 @@ public:
         const uint base = 10,
         bool is_unsigned_val = false);
 
-    int evalAttr(const I_KeywordRuntimeState *prev) const;
+    int evalAttr(const KeywordRuntimeState &state) const;
+
+    // Should only be used on attributes that are constant
+    int
+    getConstValue() const
+    {
+        return val;
+    }
 
     bool
     isConstant() const
@@ -184,22 +262,16 @@ private:
 class CtxAttr
 {
 public:
-    void setAttr(const KeywordAttr &attr, const std::string &keyword_name);
+    void setAttr(const KeywordAttr &attr, VariablesMapping &known_vars, const std::string &keyword_name);
 
-    operator std::string() const
+    uint
+    getSlot() const
     {
-        if (!is_set) {
-            auto env = Singleton::Consume<I_Environment>::by<KeywordComp>();
-            auto default_ctx = env->get<std::string>(I_KeywordsRule::getKeywordsRuleTag());
-            if (default_ctx.ok()) return *default_ctx;
-            dbgError(D_KEYWORD) << "Running keyword rule without specific context and without default";
-            return "Missing Default Context";
-        }
-        return ctx;
+        return slot;
     }
 
 private:
-    std::string ctx;
+    uint slot = KeywordRuntimeState::default_ctx_slot;
     bool is_set = false;
 };
 
@@ -233,6 +305,8 @@ private:
     CompId comp_val;
 };
 
+// Keywords of a rule are kept in an array, each one pointing to the keyword that follows it.
+// A keyword that matches passes the runtime state on to the rest of the rule via runNext().
 class SingleKeyword
 {
 public:
@@ -244,12 +318,18 @@ public:
     {
     }
 
-    MatchStatus runNext(const I_KeywordRuntimeState *curr) const;
-    void appendKeyword(std::unique_ptr<SingleKeyword> &&_next);
-    virtual MatchStatus isMatch(const I_KeywordRuntimeState *prev) const = 0;
+    MatchStatus
+    runNext(KeywordRuntimeState &state) const
+    {
+        if (next == nullptr) return MatchStatus::Match;
+        return next->isMatch(state);
+    }
+
+    void setNext(const SingleKeyword *_next) { next = _next; }
+    virtual MatchStatus isMatch(KeywordRuntimeState &state) const = 0;
 
 private:
-    std::unique_ptr<SingleKeyword> next;
+    const SingleKeyword *next = nullptr;
 };
 
 std::unique_ptr<SingleKeyword> genDataKeyword(
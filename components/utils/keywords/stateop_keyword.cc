@@ -16,14 +16,14 @@ class StateopKeyword : public SingleKeyword
 {
 public:
     explicit StateopKeyword(const vector<KeywordAttr> &attr, VariablesMapping &vars);
-    MatchStatus isMatch(const I_KeywordRuntimeState* prev) const override;
+    MatchStatus isMatch(KeywordRuntimeState &state) const override;
 
 private:
     enum class Operation { ISSET, SET, UNSET, COUNT };
     using OpFlags = Flags<Operation>;
 
     void
-    setState(const KeywordAttr &attr, const VariablesMapping &)
+    setState(const KeywordAttr &attr, VariablesMapping &)
     {
         auto &var_name_param = attr.getParams();
 
@@ -35,21 +35,21 @@ private:
     }
 
     void
-    setTesting(const KeywordAttr &, const VariablesMapping &)
+    setTesting(const KeywordAttr &, VariablesMapping &)
     {
         if (!mode.empty()) throw KeywordError("Redefining 'stateop' keyword operation");
         mode.setFlag(Operation::ISSET);
     }
 
     void
-    setSetting(const KeywordAttr &, const VariablesMapping &)
+    setSetting(const KeywordAttr &, VariablesMapping &)
     {
         if (!mode.empty()) throw KeywordError("Redefining 'stateop' keyword operation");
         mode.setFlag(Operation::SET);
     }
 
     void
-    setUnsetting(const KeywordAttr &, const VariablesMapping &)
+    setUnsetting(const KeywordAttr &, VariablesMapping &)
     {
         if (!mode.empty()) throw KeywordError("Redefining 'stateop' keyword operation");
         mode.setFlag(Operation::UNSET);
@@ -58,10 +58,10 @@ private:
     string  var_name;
     OpFlags mode;
 
-    static const map<string, void(StateopKeyword::*)(const KeywordAttr &, const VariablesMapping &)> setops;
+    static const map<string, void(StateopKeyword::*)(const KeywordAttr &, VariablesMapping &)> setops;
 };
 
-const map<string, void(StateopKeyword::*)(const KeywordAttr &, const VariablesMapping &)> StateopKeyword::setops = {
+const map<string, void(StateopKeyword::*)(const KeywordAttr &, VariablesMapping &)> StateopKeyword::setops = {
     { "isset", &StateopKeyword::setTesting   },
     { "set",   &StateopKeyword::setSetting   },
     { "unset", &StateopKeyword::setUnsetting },
@@ -114,22 +114,22 @@ private:
 };
 
 MatchStatus
-StateopKeyword::isMatch(const I_KeywordRuntimeState *prev) const
+StateopKeyword::isMatch(KeywordRuntimeState &state) const
 {
     auto table = Singleton::Consume<I_Table>::by<KeywordComp>();
 
     if (mode.isSet(Operation::ISSET)) {
         if (!table->hasState<KeywordStateop>()) return MatchStatus::NoMatchFinal;
-        auto &state = table->getState<KeywordStateop>();
-        if (state.hasVariable(var_name)) return runNext(prev);
+        auto &stateop_state = table->getState<KeywordStateop>();
+        if (stateop_state.hasVariable(var_name)) return runNext(state);
         else return MatchStatus::NoMatchFinal;
     } else if (mode.isSet(Operation::SET)) {
         if (!table->hasState<KeywordStateop>()) table->createState<KeywordStateop>();
         table->getState<KeywordStateop>().addVariable(var_name);
-        return runNext(prev);
+        return runNext(state);
     } else if (mode.isSet(Operation::UNSET)) {
         if (table->hasState<KeywordStateop>()) table->getState<KeywordStateop>().removeVariable(var_name);
-        return runNext(prev);
+        return runNext(state);
     } else {
         dbgAssert(false) << AlertInfo(AlertTeam::CORE, "keywords") << "Impossible 'stateop' keyword without operation";
     }
@@ -12,11 +12,22 @@
 #include "hyperscan_hook.h"
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
 
-// Helper function to escape regex special characters for literal matching
-static std::string escapeRegexChars(const std::string& input) {
-    std::string escaped;
-    for (char c : input) {
+#include "debug.h"
+#include "pm_match_filter.h"
+
+using namespace std;
+
+USE_DEBUG_FLAG(D_PM_COMP);
+USE_DEBUG_FLAG(D_PM);
+
+// Helper function to escape a literal pattern so Hyperscan treats every byte as-is
+static string
+escapeRegexChars(const string &input)
+{
+    string escaped;
+    for (unsigned char c : input) {
         switch (c) {
             case '.':
             case '^':
@@ -36,7 +47,14 @@ static std::string escapeRegexChars(const std::string& input) {
                 escaped += c;
                 break;
             default:
-                escaped += c;
+                if (isprint(c)) {
+                    escaped += c;
+                } else {
+                    // Hyperscan patterns are NUL terminated strings, so binary bytes must be hex-escaped
+                    char hex[5];
+                    snprintf(hex, sizeof(hex), "\\x%02x", c);
+                    escaped += hex;
+                }
                 break;
         }
     }
@@ -45,48 +63,77 @@ static std::string escapeRegexChars(const std::string& input) {
 
 HyperscanHook::HyperscanHook() : m_hsDatabase(nullptr), m_hsScratch(nullptr), m_hsReady(false) {}
 
-HyperscanHook::~HyperscanHook() {
+HyperscanHook::~HyperscanHook()
+{
     if (m_hsScratch) hs_free_scratch(m_hsScratch);
     if (m_hsDatabase) hs_free_database(m_hsDatabase);
 }
 
-Maybe<void> HyperscanHook::prepare(const std::set<PMPattern> &patterns) {
+Maybe<void>
+HyperscanHook::prepare(const set<PMPattern> &patterns)
+{
+    m_hsReady = false;
     m_hsPatterns.clear();
-    m_idToPattern.clear();    for (const auto &pat : patterns) {
-        if (pat.empty()) continue; // Use pat.empty() instead of pat.pattern().empty()
+    m_idToPattern.clear();
+    if (m_hsScratch) {
+        hs_free_scratch(m_hsScratch);
+        m_hsScratch = nullptr;
+    }
+    if (m_hsDatabase) {
+        hs_free_database(m_hsDatabase);
+        m_hsDatabase = nullptr;
+    }
 
-        // Convert pattern data to string using the public interface
-        std::string pattern_str(reinterpret_cast<const char*>(pat.data()), pat.size());
+    for (const auto &pat : patterns) {
+        if (pat.empty()) continue;
 
-        // Escape regex special characters for literal matching
-        std::string escaped_pattern = escapeRegexChars(pattern_str);
+        string pattern_str(reinterpret_cast<const char *>(pat.data()), pat.size());
+        string escaped_pattern = escapeRegexChars(pattern_str);
+        // Keep the same anchoring semantics as the thin NFA (KISS_PM_LSS_AT_BUF_START/END)
+        if (pat.isStartMatch()) escaped_pattern = "^" + escaped_pattern;
+        if (pat.isEndMatch()) escaped_pattern += "$";
 
         m_hsPatterns.push_back(escaped_pattern);
         m_idToPattern.push_back(pat);
     }
 
-    std::vector<const char*> c_patterns;
-    std::vector<unsigned int> flags;
-    std::vector<unsigned int> ids;
+    if (m_hsPatterns.empty()) return genError("No patterns to compile");
+
+    vector<const char *> c_patterns;
+    vector<unsigned int> flags;
+    vector<unsigned int> ids;
 
     for (size_t i = 0; i < m_hsPatterns.size(); ++i) {
         c_patterns.push_back(m_hsPatterns[i].c_str());
-        flags.push_back(HS_FLAG_CASELESS); // adjust as needed
-        ids.push_back((unsigned int)i);
-    }    hs_compile_error_t *compile_err = nullptr;
-    hs_error_t result = hs_compile_multi(c_patterns.data(), flags.data(), ids.data(),
-                        (unsigned int)c_patterns.size(), HS_MODE_BLOCK, nullptr,
-                        &m_hsDatabase, &compile_err);
+        flags.push_back(HS_FLAG_CASELESS);
+        ids.push_back(static_cast<unsigned int>(i));
+    }
+
+    hs_compile_error_t *compile_err = nullptr;
+    hs_error_t result = hs_compile_multi(
+        c_patterns.data(),
+        flags.data(),
+        ids.data(),
+        static_cast<unsigned int>(c_patterns.size()),
+        HS_MODE_BLOCK,
+        nullptr,
+        &m_hsDatabase,
+        &compile_err
+    );
 
     if (result != HS_SUCCESS) {
-        std::string error_msg = "Failed to compile Hyperscan database";
+        string error_msg = "Failed to compile Hyperscan database";
         if (compile_err) {
             error_msg += ": ";
             error_msg += compile_err->message;
             hs_free_compile_error(compile_err);
         }
+        dbgError(D_PM_COMP) << "HyperscanHook::prepare() failed: " << error_msg;
         return genError(error_msg);
-    }if (hs_alloc_scratch(m_hsDatabase, &m_hsScratch) != HS_SUCCESS) {
+    }
+
+    if (hs_alloc_scratch(m_hsDatabase, &m_hsScratch) != HS_SUCCESS) {
+        dbgError(D_PM_COMP) << "HyperscanHook::prepare() failed to allocate scratch space";
         return genError("Failed to allocate Hyperscan scratch space");
     }
 
@@ -94,42 +141,65 @@ Maybe<void> HyperscanHook::prepare(const std::set<PMPattern> &patterns) {
     return Maybe<void>();
 }
 
-// TODO - No need for HS hook, scanning is done by WaapHyperscanEngine::scanSample()
-std::set<PMPattern> HyperscanHook::scanBuf(const Buffer &buf) const {
-    std::set<PMPattern> results;
-    scanBufWithOffsetLambda(buf, [&results](uint, const PMPattern &pattern, bool) {
-        results.insert(pattern);
-    });
-    return results;
+void
+HyperscanHook::collectMatches(const Buffer &buf, vector<pair<uint, uint>> &matches) const
+{
+    if (!m_hsReady || buf.size() == 0) return;
+
+    auto on_match = [] (unsigned int id, unsigned long long, unsigned long long to, unsigned int, void *ctx) -> int
+    {
+        auto res = static_cast<vector<pair<uint, uint>> *>(ctx);
+        // Hyperscan reports the offset past the match, the I_PMScan contract uses the last matched byte
+        res->emplace_back(id, static_cast<uint>(to) - 1);
+        return 0;
+    };
+
+    hs_scan(
+        m_hsDatabase,
+        reinterpret_cast<const char *>(buf.data()),
+        static_cast<unsigned int>(buf.size()),
+        0,
+        m_hsScratch,
+        on_match,
+        &matches
+    );
+    dbgTrace(D_PM) << matches.size() << " raw matches found";
 }
 
-std::set<std::pair<uint, uint>> HyperscanHook::scanBufWithOffset(const Buffer &buf) const {
-    std::set<std::pair<uint, uint>> results;
-    scanBufWithOffsetLambda(buf, [&results](uint endMatchOffset, const PMPattern &pattern, bool) {
-        uint startOffset = endMatchOffset + 1 - pattern.size();
-        results.insert(std::make_pair(startOffset, endMatchOffset));
-    });
-    return results;
+set<PMPattern>
+HyperscanHook::scanBuf(const Buffer &buf) const
+{
+    vector<pair<uint, uint>> matches;
+    collectMatches(buf, matches);
+
+    set<PMPattern> res;
+    for (auto &match : matches) {
+        res.insert(m_idToPattern[match.first]);
+    }
+    return res;
 }
 
-void HyperscanHook::scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) const {
-    if (!m_hsReady) return;
-    struct HyperScanContext {
-        const HyperscanHook *self;
-        const Buffer *buffer;
-        I_PMScan::CBFunction cb;
-    };
-    auto onMatch = [](unsigned int id, unsigned long long, unsigned long long to, unsigned int,
-                    void *ctx) -> int {
-        HyperScanContext *hctx = (HyperScanContext*)ctx;
-        const HyperscanHook *self = hctx->self;
-        const PMPattern &pat = self->m_idToPattern[id];
-        uint endMatchOffset = (uint)to - 1;
-        hctx->cb(endMatchOffset, pat, false); // matchAll logic can be extended if needed
-        return 0;
-    };
-    HyperScanContext ctx{this, &buf, cb};
-    hs_scan(m_hsDatabase, (const char*)buf.data(), (unsigned int)buf.size(), 0, m_hsScratch, onMatch, &ctx);
+set<pair<uint, uint>>
+HyperscanHook::scanBufWithOffset(const Buffer &buf) const
+{
+    vector<pair<uint, uint>> matches;
+    collectMatches(buf, matches);
+
+    return set<pair<uint, uint>>(matches.begin(), matches.end());
+}
+
+void
+HyperscanHook::scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) const
+{
+    vector<pair<uint, uint>> matches;
+    collectMatches(buf, matches);
+
+    uint total_count = dispatchFilteredMatches(
+        matches,
+        [this] (uint index) -> const PMPattern & { return m_idToPattern[index]; },
+        cb
+    );
+    dbgTrace(D_PM) << total_count << " filtered matches found";
 }
 
 #endif // USE_HYPERSCAN
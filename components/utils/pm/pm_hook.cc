@@ -17,9 +17,9 @@
 #include <fstream>
 #include <algorithm>
 #include <string>
-#include <unordered_map>
 #include "kiss_patterns.h"
 #include "kiss_thin_nfa_impl.h"
+#include "pm_match_filter.h"
 
 using namespace std;
 
@@ -137,35 +137,15 @@ PMHook::scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) cons
 {
     dbgAssert(handle != nullptr) << AlertInfo(AlertTeam::CORE, "pattern matcher") << "Unusable Pattern Matcher";
 
-    unordered_map<uint, uint> match_counts;
     vector<pair<uint, uint>> pm_matches;
-    static const uint maxCbCount = 3;
-    uint totalCount = 0;
-
     kiss_thin_nfa_exec(handle.get(), buf, pm_matches);
     dbgTrace(D_PM) << pm_matches.size() << " raw matches found";
 
-    for (auto &res : pm_matches) {
-        uint patIndex = res.first;
-        uint cbCount = match_counts[patIndex];
-        const PMPattern &pat = patterns.at(patIndex);
-        bool noRegex = pat.isNoRegex();
-        bool isShort = (pat.size() == 1);
-
-        // Limit the max number of callback calls per precondition, unless it's used as a regex substitute
-        // On the last callback call, make sure to add the pre/post-word associated preconditions
-        if (noRegex || cbCount < maxCbCount) {
-            bool matchAll = !noRegex && (cbCount == maxCbCount-1 || isShort);
-
-            totalCount++;
-            cb(res.second, pat, matchAll);
-
-            if (matchAll)
-                match_counts[patIndex] = maxCbCount;
-            else
-                match_counts[patIndex]++;
-        }
-    }
+    uint totalCount = dispatchFilteredMatches(
+        pm_matches,
+        [this] (uint index) -> const PMPattern & { return patterns.at(index); },
+        cb
+    );
 
     dbgTrace(D_PM) << totalCount << " filtered matches found";
 }
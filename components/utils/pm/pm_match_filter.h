@@ -0,0 +1,64 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __PM_MATCH_FILTER_H__
+#define __PM_MATCH_FILTER_H__
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "i_pm_scan.h"
+
+// Shared implementation of the I_PMScan::scanBufWithOffsetLambda() contract, so every engine reports the same
+// callbacks for the same raw matches.
+// `matches` holds (pattern id, offset of the last matched byte) pairs, `lookup` maps a pattern id to its PMPattern.
+// Returns the number of callbacks that were issued.
+template <typename PatternLookup>
+uint
+dispatchFilteredMatches(
+    const std::vector<std::pair<uint, uint>> &matches,
+    const PatternLookup &lookup,
+    const I_PMScan::CBFunction &cb)
+{
+    static const uint max_cb_count = 3;
+    std::unordered_map<uint, uint> match_counts;
+    uint total_count = 0;
+
+    for (auto &res : matches) {
+        uint pat_index = res.first;
+        uint cb_count = match_counts[pat_index];
+        const PMPattern &pat = lookup(pat_index);
+        bool no_regex = pat.isNoRegex();
+        bool is_short = (pat.size() == 1);
+
+        // Limit the max number of callback calls per precondition, unless it's used as a regex substitute
+        // On the last callback call, make sure to add the pre/post-word associated preconditions
+        if (no_regex || cb_count < max_cb_count) {
+            bool match_all = !no_regex && (cb_count == max_cb_count - 1 || is_short);
+
+            total_count++;
+            cb(res.second, pat, match_all);
+
+            if (match_all) {
+                match_counts[pat_index] = max_cb_count;
+            } else {
+                match_counts[pat_index]++;
+            }
+        }
+    }
+
+    return total_count;
+}
+
+#endif // __PM_MATCH_FILTER_H__
@@ -0,0 +1,214 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pm_scan_factory.h"
+
+#include <atomic>
+
+#include "config.h"
+#include "debug.h"
+#include "pm_hook.h"
+#include "hyperscan_hook.h"
+
+using namespace std;
+using namespace chrono;
+
+USE_DEBUG_FLAG(D_PM_COMP);
+
+uint PMScanFactory::scan_sample_rate = PMScanFactory::default_scan_sample_rate;
+
+const string &
+PMScanFactory::getEngineName(PMEngineType engine)
+{
+    static const string auto_name = "auto";
+    static const string thin_nfa_name = "thin_nfa";
+    static const string hyperscan_name = "hyperscan";
+    static const string unknown_name = "unknown";
+
+    switch (engine) {
+        case PMEngineType::AUTO: return auto_name;
+        case PMEngineType::THIN_NFA: return thin_nfa_name;
+        case PMEngineType::HYPERSCAN: return hyperscan_name;
+    }
+    return unknown_name;
+}
+
+ostream &
+operator<<(ostream &os, const PMEngineType &engine)
+{
+    return os << PMScanFactory::getEngineName(engine);
+}
+
+// Wraps a concrete engine and reports the cost of a sample of the scans
+template <typename Engine>
+class MeasuredPMScan final : public I_PMScan
+{
+public:
+    MeasuredPMScan(const string &_consumer, PMEngineType _type, uint _sample_rate)
+            :
+        consumer(_consumer),
+        type(_type),
+        sample_rate(_sample_rate)
+    {}
+
+    Maybe<void> prepare(const set<PMPattern> &patterns) { return engine.prepare(patterns); }
+
+    set<PMPattern>
+    scanBuf(const Buffer &buf) const override
+    {
+        if (!shouldMeasure()) return engine.scanBuf(buf);
+        auto start = steady_clock::now();
+        auto res = engine.scanBuf(buf);
+        report(buf, start);
+        return res;
+    }
+
+    set<pair<uint, uint>>
+    scanBufWithOffset(const Buffer &buf) const override
+    {
+        if (!shouldMeasure()) return engine.scanBufWithOffset(buf);
+        auto start = steady_clock::now();
+        auto res = engine.scanBufWithOffset(buf);
+        report(buf, start);
+        return res;
+    }
+
+    void
+    scanBufWithOffsetLambda(const Buffer &buf, I_PMScan::CBFunction cb) const override
+    {
+        if (!shouldMeasure()) return engine.scanBufWithOffsetLambda(buf, cb);
+        auto start = steady_clock::now();
+        engine.scanBufWithOffsetLambda(buf, cb);
+        report(buf, start);
+    }
+
+private:
+    bool
+    shouldMeasure() const
+    {
+        // Scanners may be shared by the threads of the process
+        return sample_rate != 0 && ++scans % sample_rate == 0;
+    }
+
+    void
+    report(const Buffer &buf, const steady_clock::time_point &start) const
+    {
+        PMScanEvent(consumer, type, buf.size(), duration_cast<nanoseconds>(steady_clock::now() - start)).notify();
+    }
+
+    Engine engine;
+    string consumer;
+    PMEngineType type;
+    uint sample_rate;
+    mutable atomic<uint64_t> scans{0};
+};
+
+template <typename Engine>
+static Maybe<shared_ptr<I_PMScan>>
+createEngine(const set<PMPattern> &patterns, PMEngineType type, const string &consumer)
+{
+    auto scanner = make_shared<MeasuredPMScan<Engine>>(consumer, type, PMScanFactory::getScanSampleRate());
+    auto prepare_res = scanner->prepare(patterns);
+    if (!prepare_res.ok()) return genError(prepare_res.getErr());
+    return shared_ptr<I_PMScan>(scanner);
+}
+
+bool
+PMScanFactory::isHyperscanSupported()
+{
+#ifdef USE_HYPERSCAN
+    return true;
+#else
+    return false;
+#endif // USE_HYPERSCAN
+}
+
+PMEngineType
+PMScanFactory::selectEngine(const set<PMPattern> &patterns, PMEngineType requested)
+{
+    if (!isHyperscanSupported()) return PMEngineType::THIN_NFA;
+    if (requested != PMEngineType::AUTO) return requested;
+    if (patterns.size() < hyperscan_min_patterns) return PMEngineType::THIN_NFA;
+
+    // Single byte patterns match almost everywhere, the thin NFA handles the resulting match flood better
+    size_t single_byte_patterns = 0;
+    for (auto &pat : patterns) {
+        if (pat.size() <= 1) single_byte_patterns++;
+    }
+    if (single_byte_patterns * 2 > patterns.size()) return PMEngineType::THIN_NFA;
+
+    return PMEngineType::HYPERSCAN;
+}
+
+Maybe<shared_ptr<I_PMScan>>
+PMScanFactory::create(const set<PMPattern> &patterns, PMEngineType requested, const string &consumer)
+{
+    auto engine = selectEngine(patterns, requested);
+    dbgTrace(D_PM_COMP)
+        << "Creating pattern matcher. Requested engine: "
+        << requested
+        << ", selected engine: "
+        << engine
+        << ", number of patterns: "
+        << patterns.size();
+
+#ifdef USE_HYPERSCAN
+    if (engine == PMEngineType::HYPERSCAN) {
+        auto hyperscan = createEngine<HyperscanHook>(patterns, PMEngineType::HYPERSCAN, consumer);
+        if (hyperscan.ok()) return hyperscan;
+        dbgWarning(D_PM_COMP) << "Falling back to thin NFA. Error: " << hyperscan.getErr();
+    }
+#endif // USE_HYPERSCAN
+
+    return createEngine<PMHook>(patterns, PMEngineType::THIN_NFA, consumer);
+}
+
+Maybe<PMEngineType>
+PMScanFactory::engineFromString(const string &engine_name)
+{
+    if (engine_name == "auto") return PMEngineType::AUTO;
+    if (engine_name == "thin_nfa") return PMEngineType::THIN_NFA;
+    if (engine_name == "hyperscan") return PMEngineType::HYPERSCAN;
+    return genError("Unknown pattern matcher engine: " + engine_name);
+}
+
+void
+PMScanFactory::registerScanSampleRateSetting()
+{
+    static bool is_registered = false;
+    if (is_registered) return;
+    is_registered = true;
+
+    registerConfigLoadCb(
+        [] ()
+        {
+            setScanSampleRate(
+                getProfileAgentSettingWithDefault<uint>(default_scan_sample_rate, "patternMatcher.scanSampleRate")
+            );
+        }
+    );
+}
+
+void
+PMScanMetric::upon(const PMScanEvent &event)
+{
+    if (event.getConsumer() != consumer) return;
+
+    const string &engine = PMScanFactory::getEngineName(event.getEngine());
+    uint64_t scan_usec = duration_cast<microseconds>(event.getDuration()).count();
+
+    scans.report(engine, 1);
+    bytes_scanned.report(engine, event.getBytes());
+    scan_time.report(engine, scan_usec);
+    max_scan_time.report(engine, scan_usec);
+}
@@ -0,0 +1,175 @@
+#include <string>
+
+#include "cptest.h"
+#include "pm_hook.h"
+#include "hyperscan_hook.h"
+#include "pm_scan_factory.h"
+
+using namespace std;
+using namespace testing;
+
+class ScanCollector : public Listener<PMScanEvent>
+{
+public:
+    void
+    upon(const PMScanEvent &event) override
+    {
+        consumers.push_back(event.getConsumer());
+        engines.push_back(event.getEngine());
+        bytes += event.getBytes();
+    }
+
+    vector<string> consumers;
+    vector<PMEngineType> engines;
+    size_t bytes = 0;
+};
+
+static set<PMPattern>
+getManyPatterns(uint count)
+{
+    set<PMPattern> pats;
+    for (uint i = 0; i < count; i++) {
+        pats.insert(PMPattern("pattern_" + to_string(i), false, false, i));
+    }
+    return pats;
+}
+
+TEST(pm_scan_factory, engine_from_string)
+{
+    EXPECT_THAT(PMScanFactory::engineFromString("auto"), IsValue(PMEngineType::AUTO));
+    EXPECT_THAT(PMScanFactory::engineFromString("thin_nfa"), IsValue(PMEngineType::THIN_NFA));
+    EXPECT_THAT(PMScanFactory::engineFromString("hyperscan"), IsValue(PMEngineType::HYPERSCAN));
+    EXPECT_THAT(PMScanFactory::engineFromString("aho"), IsError("Unknown pattern matcher engine: aho"));
+}
+
+TEST(pm_scan_factory, engine_selection)
+{
+    auto few = getManyPatterns(3);
+    auto many = getManyPatterns(PMScanFactory::hyperscan_min_patterns);
+
+    EXPECT_EQ(PMScanFactory::selectEngine(few, PMEngineType::THIN_NFA), PMEngineType::THIN_NFA);
+    EXPECT_EQ(PMScanFactory::selectEngine(few, PMEngineType::AUTO), PMEngineType::THIN_NFA);
+
+    if (PMScanFactory::isHyperscanSupported()) {
+        EXPECT_EQ(PMScanFactory::selectEngine(many, PMEngineType::AUTO), PMEngineType::HYPERSCAN);
+        EXPECT_EQ(PMScanFactory::selectEngine(few, PMEngineType::HYPERSCAN), PMEngineType::HYPERSCAN);
+    } else {
+        EXPECT_EQ(PMScanFactory::selectEngine(many, PMEngineType::AUTO), PMEngineType::THIN_NFA);
+        EXPECT_EQ(PMScanFactory::selectEngine(few, PMEngineType::HYPERSCAN), PMEngineType::THIN_NFA);
+    }
+}
+
+TEST(pm_scan_factory, same_results_as_thin_nfa)
+{
+    set<PMPattern> pats;
+    pats.insert(PMPattern("ABC", false, false));
+    pats.insert(PMPattern("ABCD", false, false, 4));
+    pats.insert(PMPattern("^12345", true, false));
+    pats.insert(PMPattern("DCB", false, false));
+    pats.insert(PMPattern("*", false, false));
+
+    PMHook pm;
+    ASSERT_TRUE(pm.prepare(pats).ok());
+
+    Buffer buf("12345ABCDEF5678 * DCB * DCB * DCB * DCB");
+
+    for (auto engine : { PMEngineType::AUTO, PMEngineType::THIN_NFA, PMEngineType::HYPERSCAN }) {
+        auto scanner = PMScanFactory::create(pats, engine);
+        ASSERT_TRUE(scanner.ok()) << scanner.getErr();
+
+        EXPECT_EQ((*scanner)->scanBuf(buf), pm.scanBuf(buf));
+
+        set<pair<uint, PMPattern>> expected;
+        pm.scanBufWithOffsetLambda(
+            buf,
+            [&] (uint offset, const PMPattern &pat, bool) { expected.emplace(offset, pat); }
+        );
+        set<pair<uint, PMPattern>> results;
+        (*scanner)->scanBufWithOffsetLambda(
+            buf,
+            [&] (uint offset, const PMPattern &pat, bool) { results.emplace(offset, pat); }
+        );
+        EXPECT_EQ(results, expected);
+    }
+}
+
+TEST(pm_scan_factory, scan_is_reported)
+{
+    ScanCollector collector;
+    collector.registerListener();
+
+    PMScanFactory::setScanSampleRate(1);
+    auto scanner = PMScanFactory::create(getManyPatterns(3), PMEngineType::THIN_NFA, "consumer");
+    ASSERT_TRUE(scanner.ok()) << scanner.getErr();
+
+    (*scanner)->scanBuf(Buffer("pattern_1 and pattern_2"));
+    (*scanner)->scanBufWithOffset(Buffer("pattern_0"));
+    (*scanner)->scanBufWithOffsetLambda(Buffer("nothing"), [] (uint, const PMPattern &, bool) {});
+
+    EXPECT_THAT(collector.engines, ElementsAre(PMEngineType::THIN_NFA, PMEngineType::THIN_NFA, PMEngineType::THIN_NFA));
+    EXPECT_EQ(collector.bytes, 23u + 9u + 7u);
+    EXPECT_THAT(collector.consumers, ElementsAre("consumer", "consumer", "consumer"));
+
+    collector.unregisterListener();
+    PMScanFactory::setScanSampleRate(PMScanFactory::default_scan_sample_rate);
+}
+
+TEST(pm_scan_factory, scans_are_sampled)
+{
+    ScanCollector collector;
+    collector.registerListener();
+
+    PMScanFactory::setScanSampleRate(3);
+    auto sampled_scanner = PMScanFactory::create(getManyPatterns(3));
+    PMScanFactory::setScanSampleRate(0);
+    auto unmeasured_scanner = PMScanFactory::create(getManyPatterns(3));
+    PMScanFactory::setScanSampleRate(PMScanFactory::default_scan_sample_rate);
+    ASSERT_TRUE(sampled_scanner.ok()) << sampled_scanner.getErr();
+    ASSERT_TRUE(unmeasured_scanner.ok()) << unmeasured_scanner.getErr();
+
+    for (uint i = 0; i < 7; i++) {
+        EXPECT_THAT((*sampled_scanner)->scanBuf(Buffer("pattern_1")), SizeIs(1));
+        EXPECT_THAT((*unmeasured_scanner)->scanBuf(Buffer("pattern_2")), SizeIs(1));
+    }
+
+    EXPECT_THAT(collector.engines, ElementsAre(PMEngineType::THIN_NFA, PMEngineType::THIN_NFA));
+    EXPECT_EQ(collector.bytes, 9u * 2);
+
+    collector.unregisterListener();
+}
+
+TEST(pm_scan_factory, failed_compilation)
+{
+    EXPECT_FALSE(PMScanFactory::create(set<PMPattern>()).ok());
+}
+
+#ifdef USE_HYPERSCAN
+TEST(hyperscan_hook, same_results_as_thin_nfa)
+{
+    set<PMPattern> pats;
+    pats.insert(PMPattern("ABC", false, false, 1));
+    pats.insert(PMPattern("12345", true, false, 2));
+    pats.insert(PMPattern("5678", false, true, 3));
+    pats.insert(PMPattern("DCB", false, false, 4));
+    pats.insert(PMPattern(string("\0\xff.", 3), false, false, 5));
+
+    PMHook pm;
+    ASSERT_TRUE(pm.prepare(pats).ok());
+    HyperscanHook hyperscan;
+    ASSERT_TRUE(hyperscan.prepare(pats).ok());
+    EXPECT_TRUE(hyperscan.ok());
+
+    for (auto &str : { string("12345ABC DCB 5678"), string("x12345ABC 5678x"), string("a\0\xff.b\0\xff", 7) }) {
+        Buffer buf(str);
+        EXPECT_EQ(hyperscan.scanBuf(buf), pm.scanBuf(buf)) << str;
+        EXPECT_EQ(hyperscan.scanBufWithOffset(buf), pm.scanBufWithOffset(buf)) << str;
+    }
+}
+
+TEST(hyperscan_hook, no_patterns)
+{
+    HyperscanHook hyperscan;
+    EXPECT_FALSE(hyperscan.prepare(set<PMPattern>()).ok());
+    EXPECT_FALSE(hyperscan.ok());
+}
+#endif // USE_HYPERSCAN
@@ -14,6 +14,9 @@
 #include "buffer.h"
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
 
 using namespace std;
 
@@ -104,10 +107,7 @@ Buffer::operator=(Buffer &&buf)
 bool
 Buffer::contains(char ch) const
 {
-    for (const auto &iter : *this) {
-        if (iter == ch) return true;
-    }
-    return false;
+    return findFirstOf(ch).ok();
 }
 
 uint
@@ -120,7 +120,7 @@ void
 Buffer::operator+=(const Buffer &other)
 {
     if (other.len == 0) return;
-    segs.insert(segs.end(), other.segs.begin(), other.segs.end());
+    segs.append(other.segs.begin(), other.segs.end());
     len += other.len;
 
     // If the buffer was originally empty (and had no segments), fast path needs to be evaluated.
@@ -133,8 +133,8 @@ Buffer::operator+(const Buffer &other) const
 {
     Buffer res;
     res.segs.reserve(segmentsNumber() + other.segmentsNumber());
-    res.segs.insert(res.segs.end(), segs.begin(), segs.end());
-    res.segs.insert(res.segs.end(), other.segs.begin(), other.segs.end());
+    res.segs.append(segs.begin(), segs.end());
+    res.segs.append(other.segs.begin(), other.segs.end());
     res.len = len + other.len;
     res.evalFastPath();
 
@@ -184,24 +184,150 @@ Buffer::findFirstOf(char ch, uint start) const
             << "Buffer::findFirstOf() returned: Cannot set a start point after buffer's end";
         return genError("Cannot set a start point after buffer's end");
     }
-    for (; start < len; ++start) {
-        if ((*this)[start] == ch) return start;
+    uint seg_start = 0;
+    for (const auto &seg : segs) {
+        uint seg_end = seg_start + seg.size();
+        if (start < seg_end) {
+            uint from = start > seg_start ? start - seg_start : 0;
+            const u_char *data = seg.data();
+            auto found = memchr(data + from, ch, seg.size() - from);
+            if (found != nullptr) return seg_start + (static_cast<const u_char *>(found) - data);
+        }
+        seg_start = seg_end;
     }
     return genError("Not located");
 }
 
+static inline u_char
+toLowerCase(u_char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+}
+
 Maybe<uint>
 Buffer::findFirstOf(const Buffer &buf, uint start) const
+{
+    return findPattern(static_cast<string>(buf), start, false);
+}
+
+Maybe<uint>
+Buffer::find(const string &pattern, uint start) const
+{
+    return findPattern(pattern, start, false);
+}
+
+Maybe<uint>
+Buffer::caseInsensitiveFind(const string &pattern, uint start) const
+{
+    string lower_case_pattern(pattern);
+    for (auto &ch : lower_case_pattern) {
+        ch = toLowerCase(ch);
+    }
+    return findPattern(lower_case_pattern, start, true);
+}
+
+// The pattern of a case insensitive search is in lower case
+static bool
+isEqualPart(const u_char *data, const u_char *pattern, uint size, bool is_case_insensitive)
+{
+    if (!is_case_insensitive) return memcmp(data, pattern, size) == 0;
+    for (uint i = 0; i < size; i++) {
+        if (toLowerCase(data[i]) != pattern[i]) return false;
+    }
+    return true;
+}
+
+static const u_char *
+findCaseInsensitive(const u_char *data, uint size, const u_char *pattern, uint pattern_size)
+{
+    u_char first_lower = pattern[0];
+    u_char first_upper = (first_lower >= 'a' && first_lower <= 'z') ? first_lower - ('a' - 'A') : first_lower;
+    uint last_start = size - pattern_size;
+    uint curr = 0;
+
+#ifdef __SSE2__
+    // Look for both cases of the first byte, 16 bytes at a time, and only compare the rest on candidates
+    const __m128i lower = _mm_set1_epi8(first_lower);
+    const __m128i upper = _mm_set1_epi8(first_upper);
+    while (curr + 16 <= last_start + 1) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + curr));
+        uint candidates = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, lower), _mm_cmpeq_epi8(block, upper))
+        );
+        while (candidates != 0) {
+            uint candidate = curr + __builtin_ctz(candidates);
+            if (isEqualPart(data + candidate + 1, pattern + 1, pattern_size - 1, true)) return data + candidate;
+            candidates &= candidates - 1;
+        }
+        curr += 16;
+    }
+#endif // __SSE2__
+
+    for (; curr <= last_start; curr++) {
+        if (data[curr] != first_lower && data[curr] != first_upper) continue;
+        if (isEqualPart(data + curr + 1, pattern + 1, pattern_size - 1, true)) return data + curr;
+    }
+    return nullptr;
+}
+
+// Checks if the pattern starts at "offset" of the segment, and continues into the following segments
+static bool
+isPatternAt(
+    Buffer::SegIterator seg,
+    Buffer::SegIterator end,
+    uint offset,
+    const u_char *pattern,
+    uint pattern_size,
+    bool is_case_insensitive)
+{
+    for (uint matched = 0; matched < pattern_size; seg++, offset = 0) {
+        if (seg == end) return false;
+        uint part_size = min(seg->size() - offset, pattern_size - matched);
+        if (!isEqualPart(seg->data() + offset, pattern + matched, part_size, is_case_insensitive)) return false;
+        matched += part_size;
+    }
+    return true;
+}
+
+Maybe<uint>
+Buffer::findPattern(const string &pattern, uint start, bool is_case_insensitive) const
 {
     if (start > len) {
         dbgAssertOpt(start <= len)
             << alert
-            << "Buffer::findFirstOf() returned: Cannot set a start point after buffer's end";
+            << "Buffer::find() returned: Cannot set a start point after buffer's end";
         return genError("Cannot set a start point after buffer's end");
     }
-    for (; start + buf.size() <= len; ++start) {
-        auto sub_buffer = getSubBuffer(start, start + buf.size());
-        if (sub_buffer == buf) return start;
+    if (pattern.empty()) return start;
+    if (pattern.size() > len - start) return genError("Not located");
+
+    auto pattern_data = reinterpret_cast<const u_char *>(pattern.data());
+    uint pattern_size = pattern.size();
+    uint last_start = len - pattern_size;
+
+    uint seg_start = 0;
+    for (auto seg = segs.begin(); seg != segs.end() && seg_start <= last_start; seg_start += seg->size(), seg++) {
+        uint seg_size = seg->size();
+        if (seg_start + seg_size <= start) continue;
+
+        uint from = start > seg_start ? start - seg_start : 0;
+        const u_char *data = seg->data();
+
+        // Matches that are entirely within the segment
+        if (seg_size - from >= pattern_size) {
+            const u_char *found = is_case_insensitive ?
+                findCaseInsensitive(data + from, seg_size - from, pattern_data, pattern_size) :
+                static_cast<const u_char *>(memmem(data + from, seg_size - from, pattern_data, pattern_size));
+            if (found != nullptr) return seg_start + (found - data);
+        }
+
+        // Matches that start at the end of the segment and continue into the next ones
+        uint cross_from = max(from, seg_size >= pattern_size ? seg_size - pattern_size + 1 : 0);
+        for (uint offset = cross_from; offset < seg_size && seg_start + offset <= last_start; offset++) {
+            if (isPatternAt(seg, segs.end(), offset, pattern_data, pattern_size, is_case_insensitive)) {
+                return seg_start + offset;
+            }
+        }
     }
     return genError("Not located");
 }
@@ -414,8 +540,18 @@ Buffer::operator[](uint offset) const
 
 Buffer::operator string() const
 {
-    serialize();
-    return string(reinterpret_cast<const char *>(fast_path_ptr), fast_path_len);
+    if (segmentsNumber() < 2) {
+        serialize();
+        return string(reinterpret_cast<const char *>(fast_path_ptr), fast_path_len);
+    }
+
+    // The segments are copied one after the other, rather than making the buffer itself contiguous first
+    string res;
+    res.reserve(len);
+    for (const auto &seg : segs) {
+        res.append(reinterpret_cast<const char *>(seg.data()), seg.size());
+    }
+    return res;
 }
 
 Maybe<Buffer::InternalPtr<u_char>>
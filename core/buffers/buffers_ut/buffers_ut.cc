@@ -603,6 +603,26 @@ TEST_F(BuffersTest, serialization)
     EXPECT_EQ(buf, Buffer("aaabbc"));
 }
 
+TEST_F(BuffersTest, serialization_of_shared_memory)
+{
+    Buffer part("abc");
+    stringstream stream;
+    {
+        cereal::JSONOutputArchive ar(stream);
+        ar(part + part);
+    }
+    string output = stream.str();
+    EXPECT_EQ(output.find("\"data\""), output.rfind("\"data\""));
+
+    Buffer buf;
+    {
+        cereal::JSONInputArchive ar(stream);
+        ar(buf);
+    }
+    EXPECT_EQ(buf.segmentsNumber(), 2u);
+    EXPECT_EQ(buf, Buffer("abcabc"));
+}
+
 TEST_F (BuffersTest, find_first_of_ch)
 {
     Buffer b1("boundary=Heeelllo;extrastuff;");
@@ -657,6 +677,145 @@ TEST_F (BuffersTest, find_last_not_of)
     EXPECT_TRUE(b2 == b1.getSubBuffer(0, index.unpack()));
 }
 
+TEST_F(BuffersTest, find_first_of_ch_in_segments)
+{
+    auto buf = genBuf("key=", "va;lue", ";end");
+    EXPECT_THAT(buf.findFirstOf(';'), IsValue(6u));
+    EXPECT_THAT(buf.findFirstOf(';', 7), IsValue(10u));
+    EXPECT_THAT(buf.findFirstOf('x'), IsError("Not located"));
+    EXPECT_TRUE(buf.contains('='));
+    EXPECT_FALSE(buf.contains('x'));
+    EXPECT_EQ(buf.segmentsNumber(), 3u);
+}
+
+TEST_F(BuffersTest, find)
+{
+    auto buf = genBuf("Content-Ty", "p", "e: text/html; Type");
+    EXPECT_THAT(buf.find("Type"), IsValue(8u));
+    EXPECT_THAT(buf.find("Type", 9), IsValue(25u));
+    EXPECT_THAT(buf.find("Content"), IsValue(0u));
+    EXPECT_THAT(buf.find("html"), IsValue(19u));
+    EXPECT_THAT(buf.find("type"), IsError("Not located"));
+    EXPECT_THAT(buf.find("Typee"), IsError("Not located"));
+    EXPECT_THAT(buf.find(""), IsValue(0u));
+    EXPECT_TRUE(buf.contains("-Type: "));
+    EXPECT_FALSE(buf.contains("Content-Type: text/html; Type;"));
+    EXPECT_THAT(buf.findFirstOf(Buffer("pe:")), IsValue(10u));
+    EXPECT_EQ(buf.segmentsNumber(), 3u);
+}
+
+TEST_F(BuffersTest, case_insensitive_find)
+{
+    string long_data = string(40, 'x') + "Set-COOKIE: a=1";
+    auto buf = genBuf(long_data, "; Set-Coo", "kie: b=2");
+    EXPECT_THAT(buf.caseInsensitiveFind("set-cookie"), IsValue(40u));
+    EXPECT_THAT(buf.caseInsensitiveFind("SET-cookie", 41), IsValue(57u));
+    EXPECT_THAT(buf.caseInsensitiveFind("set-cookie: c"), IsError("Not located"));
+    EXPECT_THAT(buf.caseInsensitiveFind("X"), IsValue(0u));
+    EXPECT_THAT(buf.find("set-cookie"), IsError("Not located"));
+    EXPECT_EQ(buf.segmentsNumber(), 3u);
+}
+
+TEST_F(BuffersTest, string_conversion_keeps_segments)
+{
+    auto buf = genBuf("12", "3456", "789");
+    EXPECT_EQ(static_cast<string>(buf), "123456789");
+    EXPECT_EQ(buf.segmentsNumber(), 3u);
+}
+
+class BufferAllocationsTest : public Test
+{
+public:
+    BufferAllocationsTest()
+    {
+        // The first buffers of a thread are allocated from the heap, and their memory is kept for the next ones
+        vector<Buffer> warm_up;
+        for (uint i = 0; i < 8; i++) {
+            warm_up.emplace_back(small_data.data(), small_data.size(), Buffer::MemoryType::OWNED);
+        }
+    }
+
+    void startCounting() { allocations_at_start = BufferPool::getHeapAllocations(); }
+    uint64_t getAllocations() const { return BufferPool::getHeapAllocations() - allocations_at_start; }
+
+    string small_data = "Content-Type";
+    string large_data = string(100, 'x');
+
+private:
+    uint64_t allocations_at_start = 0;
+};
+
+TEST_F(BufferAllocationsTest, small_buffer)
+{
+    startCounting();
+    {
+        Buffer buf(small_data.data(), small_data.size(), Buffer::MemoryType::OWNED);
+        Buffer copy(buf);
+        Buffer sub_buffer = buf.getSubBuffer(0, 7);
+        Buffer moved(move(copy));
+    }
+    EXPECT_EQ(getAllocations(), 0u);
+}
+
+TEST_F(BufferAllocationsTest, static_buffer)
+{
+    startCounting();
+    {
+        Buffer buf(large_data.data(), large_data.size(), Buffer::MemoryType::STATIC);
+        Buffer copy(buf);
+    }
+    EXPECT_EQ(getAllocations(), 0u);
+}
+
+TEST_F(BufferAllocationsTest, moving_a_volatile_buffer_keeps_it_primary)
+{
+    Buffer copy;
+    startCounting();
+    {
+        Buffer buf(large_data.data(), large_data.size(), Buffer::MemoryType::VOLATILE);
+        Buffer moved(move(buf));
+        copy = moved;
+        large_data[0] = 'y';
+        EXPECT_EQ(copy.data()[0], 'y');
+    }
+    large_data[0] = 'z';
+
+    EXPECT_EQ(getAllocations(), 0u);
+    EXPECT_EQ(copy, Buffer("y" + string(99, 'x')));
+}
+
+TEST_F(BufferAllocationsTest, small_volatile_buffer_is_copied_in_place)
+{
+    Buffer copy;
+    startCounting();
+    {
+        Buffer buf(small_data.data(), small_data.size(), Buffer::MemoryType::VOLATILE);
+        copy = buf;
+    }
+    uint64_t allocations = getAllocations();
+    small_data[0] = 'c';
+
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_EQ(copy, Buffer("Content-Type"));
+}
+
+TEST_F(BufferAllocationsTest, concatenation_allocates_the_segments)
+{
+    Buffer first(small_data.data(), small_data.size(), Buffer::MemoryType::OWNED);
+    Buffer second(small_data.data(), small_data.size(), Buffer::MemoryType::OWNED);
+
+    startCounting();
+    {
+        Buffer sum = first + second;
+    }
+    EXPECT_EQ(getAllocations(), 1u);
+
+    startCounting();
+    first += second;
+    EXPECT_EQ(getAllocations(), 1u);
+    EXPECT_EQ(first, Buffer("Content-TypeContent-Type"));
+}
+
 class SegmentsTest: public Test
 {
 public:
@@ -26,10 +26,21 @@ Buffer::DataContainer::DataContainer(const u_char *_ptr, uint _len, MemoryType _
     len(_len)
 {
     if (_type == MemoryType::OWNED) {
-        vec = std::vector<u_char>(_ptr, _ptr + len);
-        ptr = vec.data();
+        copyIn(_ptr);
     } else {
         ptr = _ptr;
         is_owned = false;
     }
 }
+
+void
+Buffer::DataContainer::copyIn(const u_char *_ptr)
+{
+    if (len <= small_data_size) {
+        std::copy(_ptr, _ptr + len, small_data);
+        ptr = small_data;
+        return;
+    }
+    vec = std::vector<u_char>(_ptr, _ptr + len);
+    ptr = vec.data();
+}
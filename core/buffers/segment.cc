@@ -66,6 +66,22 @@ Buffer::Segment::Segment(Segment &&seg)
     seg.is_owned = nullptr;
 }
 
+void
+Buffer::Segment::relocate(Segment *to, Segment &from)
+{
+    // Unlike the move constructor, the volatility of the segment is kept - a PRIMARY segment stays the PRIMARY one.
+    auto seg = new (to) Segment();
+    seg->data_container = move(from.data_container);
+    seg->offset = from.offset;
+    seg->len = from.len;
+    seg->type = from.type;
+    seg->is_owned = from.is_owned;
+    seg->ptr = from.ptr;
+
+    from.type = Volatility::NONE;
+    from.~Segment();
+}
+
 Buffer::Segment &
 Buffer::Segment::operator=(const Buffer::Segment &seg)
 {
@@ -126,7 +142,7 @@ Buffer::Segment::operator=(Segment &&seg)
 
 Buffer::Segment::Segment(vector<u_char> &&_vec)
         :
-    data_container(make_shared<DataContainer>(move(_vec))),
+    data_container(DataContainerPtr::make(move(_vec))),
     offset(0),
     len(data_container->size()),
     is_owned(nullptr)
@@ -137,7 +153,7 @@ Buffer::Segment::Segment(vector<u_char> &&_vec)
 
 Buffer::Segment::Segment(const u_char *_ptr, uint _len, Buffer::MemoryType _type)
         :
-    data_container(make_shared<DataContainer>(_ptr, _len, _type)),
+    data_container(DataContainerPtr::make(_ptr, _len, _type)),
     offset(0),
     len(_len),
     is_owned(nullptr)
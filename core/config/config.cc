@@ -16,6 +16,7 @@
 
 #include <dirent.h>
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <cctype>
@@ -39,6 +40,14 @@ USE_DEBUG_FLAG(D_CONFIG);
 
 static const string not_found = "";
 
+// Unique among all the config components, since the memo of the rulebase configurations is kept per thread
+static uint64_t
+getNextNodesGeneration()
+{
+    static atomic<uint64_t> next_generation{0};
+    return ++next_generation;
+}
+
 AgentProfileSettings AgentProfileSettings::default_profile_settings = AgentProfileSettings();
 
 class registerExpectedConfigUpdates : public ClientRest
@@ -159,12 +168,23 @@ public:
     // Cache statistics interface implementation
     uint64_t getCacheHits() const override;
     uint64_t getCacheMisses() const override;
+    uint64_t getRulebaseMemoHits() const override;
+    uint64_t getRulebaseMemoMisses() const override;
     void resetCacheStats() override;
     void enableCacheTracking() override;
     void disableCacheTracking() override;
     bool isCacheTrackingEnabled() const override;
 
 private:
+    // The last resolution of a rulebase configuration, and the revisions of the contexts it was resolved under
+    struct MemoizedConfiguration
+    {
+        uint64_t nodes_generation = 0;
+        vector<uint64_t> context_revisions;
+        const TypeWrapper *value = nullptr;
+    };
+
+    const TypeWrapper & resolveConfiguration(const vector<string> &paths) const;
     bool areTenantAndProfileActive(const TenantProfilePair &tenant_profile) const;
     void periodicRegistrationRefresh();
 
@@ -368,6 +388,9 @@ private:
     size_t policy_load_count = 0;
     string policy_load_id = "";
     bool is_cache_enabled = false;
+    // The memo of the rulebase configurations holds pointers into configuration_nodes, so it is valid only for the
+    // generation of the nodes it was filled under
+    atomic<uint64_t> nodes_generation{getNextNodesGeneration()};
 
     TypeWrapper empty;
 };
@@ -423,8 +446,39 @@ checkContext(const shared_ptr<EnvironmentEvaluator<bool>> &ctx)
     return res.ok() && *res;
 }
 
+// Resolving a rulebase configuration evaluates the context of every rule against the environment. During a
+// transaction several components resolve the same rules under the same contexts, so the last result is kept for
+// as long as the active contexts hold the same values.
 const TypeWrapper &
 ConfigComponent::Impl::getConfiguration(const vector<string> &paths) const
+{
+    if (paths.empty() || paths.front() != "rulebase") return resolveConfiguration(paths);
+
+    // Every thread keeps a memo of its own, so no lock is taken
+    thread_local map<vector<string>, MemoizedConfiguration> rulebase_memo;
+
+    auto environment = Singleton::Consume<I_Environment>::by<ConfigComponent>();
+    auto &memo = rulebase_memo[paths];
+    uint64_t curr_nodes_generation = nodes_generation.load(memory_order_relaxed);
+    if (
+        memo.value != nullptr &&
+        memo.nodes_generation == curr_nodes_generation &&
+        environment->areContextRevisionsActive(memo.context_revisions)
+    ) {
+        CacheStats::recordRulebaseMemoHit();
+        return *memo.value;
+    }
+
+    CacheStats::recordRulebaseMemoMiss();
+    const TypeWrapper &value = resolveConfiguration(paths);
+    bool is_memoizable = environment->getContextRevisions(memo.context_revisions);
+    memo.value = is_memoizable ? &value : nullptr;
+    memo.nodes_generation = curr_nodes_generation;
+    return value;
+}
+
+const TypeWrapper &
+ConfigComponent::Impl::resolveConfiguration(const vector<string> &paths) const
 {
     auto curr_configs = configuration_nodes.find(TenantProfilePair(getActiveTenant(), getActiveProfile()));
 
@@ -571,6 +625,7 @@ ConfigComponent::Impl::getPolicyConfigPath(
 bool
 ConfigComponent::Impl::setConfiguration(TypeWrapper &&value, const vector<string> &paths)
 {
+    nodes_generation = getNextNodesGeneration();
     for (auto &tenant : configuration_nodes) {
         tenant.second.erase(paths);
     }
@@ -734,6 +789,7 @@ ConfigComponent::Impl::registerConfigAbortCb(ConfigCb cb)
 void
 ConfigComponent::Impl::clearOldTenants()
 {
+    nodes_generation = getNextNodesGeneration();
     for (
         auto iter = configuration_nodes.begin();
         iter != configuration_nodes.end();
@@ -851,6 +907,7 @@ ConfigComponent::Impl::commitSuccess()
 {
     new_resource_nodes.clear();
     configuration_nodes = move(new_configuration_nodes);
+    nodes_generation = getNextNodesGeneration();
     settings_nodes = move(new_settings_nodes);
 
     reloadFileSystemPaths();
@@ -1082,6 +1139,18 @@ ConfigComponent::Impl::getCacheMisses() const
     return CacheStats::getMisses();
 }
 
+uint64_t
+ConfigComponent::Impl::getRulebaseMemoHits() const
+{
+    return CacheStats::getRulebaseMemoHits();
+}
+
+uint64_t
+ConfigComponent::Impl::getRulebaseMemoMisses() const
+{
+    return CacheStats::getRulebaseMemoMisses();
+}
+
 void
 ConfigComponent::Impl::resetCacheStats()
 {
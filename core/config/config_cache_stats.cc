@@ -4,10 +4,14 @@
 struct CacheStats {
     static std::atomic<uint64_t> hits;
     static std::atomic<uint64_t> misses;
+    static std::atomic<uint64_t> rulebase_memo_hits;
+    static std::atomic<uint64_t> rulebase_memo_misses;
     static bool tracking_enabled;
 };
 
 // Define static members for cache statistics
 std::atomic<uint64_t> CacheStats::hits{0};
 std::atomic<uint64_t> CacheStats::misses{0};
+std::atomic<uint64_t> CacheStats::rulebase_memo_hits{0};
+std::atomic<uint64_t> CacheStats::rulebase_memo_misses{0};
 bool CacheStats::tracking_enabled = false;
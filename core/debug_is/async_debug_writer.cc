@@ -0,0 +1,278 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "async_debug_writer.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <iostream>
+
+using namespace std;
+
+constexpr chrono::milliseconds AsyncDebugWriter::default_write_interval;
+
+static const uint max_write_retries = 3;
+
+class AsyncDebugWriter::Ring
+{
+public:
+    Ring(uint size) : lines(size) {}
+
+    // Called only by the thread that owns the ring
+    bool
+    push(string &&line)
+    {
+        auto tail_pos = tail.load(memory_order_relaxed);
+        if (tail_pos - head.load(memory_order_acquire) == lines.size()) return false;
+
+        lines[tail_pos % lines.size()] = move(line);
+        tail.store(tail_pos + 1, memory_order_release);
+        return true;
+    }
+
+    // Called only while holding the write lock of the writer
+    void
+    popAll(vector<string> &popped_lines)
+    {
+        auto head_pos = head.load(memory_order_relaxed);
+        auto tail_pos = tail.load(memory_order_acquire);
+        for (; head_pos != tail_pos; head_pos++) {
+            popped_lines.push_back(move(lines[head_pos % lines.size()]));
+        }
+        head.store(head_pos, memory_order_release);
+    }
+
+    // Called by the thread that owns the ring when it exits, after which nothing is pushed to the ring
+    void release() { is_released.store(true, memory_order_release); }
+    bool isReleased() const { return is_released.load(memory_order_acquire); }
+
+    // Used only by the thread that owns the ring
+    ostringstream message;
+
+private:
+    vector<string> lines;
+    atomic<uint64_t> head{0};
+    atomic<uint64_t> tail{0};
+    atomic<bool> is_released{false};
+};
+
+// The rings of the current thread, by the ids of their writers. They are released when the thread exits.
+class AsyncDebugWriter::ThreadRings
+{
+public:
+    ~ThreadRings()
+    {
+        for (auto &thread_ring : rings) {
+            auto ring = thread_ring.second.lock();
+            if (ring != nullptr) ring->release();
+        }
+    }
+
+    vector<pair<uint64_t, weak_ptr<Ring>>> rings;
+};
+
+static uint64_t
+getNextWriterId()
+{
+    static atomic<uint64_t> next_id{0};
+    return ++next_id;
+}
+
+AsyncDebugWriter::AsyncDebugWriter(const string &_file_name, uint _ring_size, chrono::milliseconds _write_interval)
+        :
+    id(getNextWriterId()),
+    file_name(_file_name),
+    ring_size(_ring_size == 0 ? default_ring_size : _ring_size),
+    write_interval(_write_interval)
+{
+    openFile();
+    writer = thread(&AsyncDebugWriter::run, this);
+}
+
+AsyncDebugWriter::~AsyncDebugWriter()
+{
+    {
+        lock_guard<mutex> guard(stop_lock);
+        is_stopping = true;
+    }
+    stop_signal.notify_one();
+    writer.join();
+
+    writeLines();
+    closeFile();
+}
+
+void
+AsyncDebugWriter::push(string &&line)
+{
+    if (!getRing().push(move(line))) dropped_lines++;
+}
+
+ostream &
+AsyncDebugWriter::getMessageStream()
+{
+    return getRing().message;
+}
+
+void
+AsyncDebugWriter::pushMessage()
+{
+    auto &ring = getRing();
+    ring.message << '\n';
+    if (!ring.push(ring.message.str())) dropped_lines++;
+    ring.message.str("");
+}
+
+void
+AsyncDebugWriter::flush()
+{
+    writeLines();
+}
+
+AsyncDebugWriter::Ring &
+AsyncDebugWriter::getRing()
+{
+    // Writers are told apart by their ids rather than their addresses, since a new writer may reuse an address
+    thread_local ThreadRings thread_rings;
+
+    for (auto thread_ring = thread_rings.rings.begin(); thread_ring != thread_rings.rings.end();) {
+        if (thread_ring->second.expired()) {
+            thread_ring = thread_rings.rings.erase(thread_ring);
+            continue;
+        }
+        // The writer holds the ring for as long as the writer exists
+        if (thread_ring->first == id) return *thread_ring->second.lock();
+        thread_ring++;
+    }
+
+    auto ring = make_shared<Ring>(ring_size);
+    {
+        lock_guard<mutex> guard(rings_lock);
+        rings.push_back(ring);
+    }
+    thread_rings.rings.emplace_back(id, ring);
+    return *ring;
+}
+
+void
+AsyncDebugWriter::run()
+{
+    unique_lock<mutex> guard(stop_lock);
+    while (!is_stopping) {
+        stop_signal.wait_for(guard, write_interval, [this] () { return is_stopping; });
+        guard.unlock();
+        writeLines();
+        guard.lock();
+    }
+}
+
+void
+AsyncDebugWriter::writeLines()
+{
+    lock_guard<mutex> guard(write_lock);
+    {
+        lock_guard<mutex> rings_guard(rings_lock);
+        for (auto ring = rings.begin(); ring != rings.end();) {
+            // A released ring gets no more lines, so once the lines it has are taken it is no longer needed
+            bool is_released = (*ring)->isReleased();
+            (*ring)->popAll(pending_lines);
+            if (is_released) {
+                ring = rings.erase(ring);
+                continue;
+            }
+            ring++;
+        }
+    }
+
+    uint64_t curr_dropped_lines = dropped_lines;
+    if (curr_dropped_lines != reported_dropped_lines) {
+        pending_lines.push_back(
+            "Debug buffer is full, " +
+            to_string(curr_dropped_lines - reported_dropped_lines) +
+            " debug messages were dropped\n"
+        );
+        reported_dropped_lines = curr_dropped_lines;
+    }
+
+    if (!pending_lines.empty()) writePendingLines();
+    pending_lines.clear();
+}
+
+void
+AsyncDebugWriter::writePendingLines()
+{
+    pending_iov.clear();
+    for (auto &line : pending_lines) {
+        pending_iov.push_back({ const_cast<char *>(line.data()), line.size() });
+    }
+
+    uint curr_iov = 0;
+    uint num_retries = 0;
+    while (curr_iov < pending_iov.size()) {
+        auto num_iov = min<size_t>(pending_iov.size() - curr_iov, IOV_MAX);
+        ssize_t written = fd < 0 ? -1 : writev(fd, pending_iov.data() + curr_iov, num_iov);
+        if (written < 0) {
+            if (fd >= 0 && errno == EINTR) continue;
+            if (num_retries++ == max_write_retries) break;
+
+            cerr
+                << "Failed to write debug messages to file, re-opening debug file and retrying to write. File path: "
+                << file_name
+                << endl;
+            closeFile();
+            openFile();
+            continue;
+        }
+
+        while (curr_iov < pending_iov.size() && static_cast<size_t>(written) >= pending_iov[curr_iov].iov_len) {
+            written -= pending_iov[curr_iov].iov_len;
+            curr_iov++;
+        }
+        if (written > 0) {
+            auto &partly_written = pending_iov[curr_iov];
+            partly_written.iov_base = static_cast<char *>(partly_written.iov_base) + written;
+            partly_written.iov_len -= written;
+        }
+    }
+
+    // Lines that could not be written are reported along with the lines that did not fit in the rings
+    dropped_lines += pending_iov.size() - curr_iov;
+}
+
+void
+AsyncDebugWriter::openFile()
+{
+    cerr << "Opening debug file. File path: " << file_name << endl;
+    fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        cerr << "Failed to open debug file. File path: " << file_name << endl;
+        return;
+    }
+
+    cerr << "Successfully opened debug file. File path: " << file_name << endl;
+}
+
+void
+AsyncDebugWriter::closeFile()
+{
+    if (fd < 0) return;
+
+    if (close(fd) != 0) {
+        cerr << "Failed in closing debug file. File path: " << file_name << endl;
+    } else {
+        cerr << "Successfully closed debug file at path: " << file_name << endl;
+    }
+    fd = -1;
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __ASYNC_DEBUG_WRITER_H__
+#define __ASYNC_DEBUG_WRITER_H__
+
+#include <sys/uio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes formatted debug lines to a file from a background thread.
+// Every thread that pushes lines gets a ring of its own, so pushing a line never takes a lock. When the ring of a
+// thread is full the line is dropped, and the number of dropped lines is written to the file with the next batch.
+// The ring of a thread that exited is removed once the lines left in it are written.
+class AsyncDebugWriter
+{
+public:
+    AsyncDebugWriter(
+        const std::string &_file_name,
+        uint _ring_size = default_ring_size,
+        std::chrono::milliseconds _write_interval = default_write_interval
+    );
+    ~AsyncDebugWriter();
+
+    AsyncDebugWriter(const AsyncDebugWriter &) = delete;
+    AsyncDebugWriter & operator=(const AsyncDebugWriter &) = delete;
+
+    void push(std::string &&line);
+    // Every thread formats its message in a stream of its own, and pushes it once the message is complete
+    std::ostream & getMessageStream();
+    void pushMessage();
+    // Writes every line that was pushed before the call
+    void flush();
+
+    uint64_t getDroppedLines() const { return dropped_lines; }
+
+    static const uint default_ring_size = 4096;
+    static constexpr std::chrono::milliseconds default_write_interval{20};
+
+private:
+    class Ring;
+    class ThreadRings;
+
+    Ring & getRing();
+    void run();
+    void writeLines();
+    void writePendingLines();
+    void openFile();
+    void closeFile();
+
+    const uint64_t id;
+    std::string file_name;
+    uint ring_size;
+    std::chrono::milliseconds write_interval;
+    int fd = -1;
+
+    std::mutex rings_lock;
+    std::vector<std::shared_ptr<Ring>> rings;
+
+    // Only one thread at a time takes lines out of the rings and writes them
+    std::mutex write_lock;
+    std::vector<std::string> pending_lines;
+    std::vector<iovec> pending_iov;
+    std::atomic<uint64_t> dropped_lines{0};
+    uint64_t reported_dropped_lines = 0;
+
+    std::mutex stop_lock;
+    std::condition_variable stop_signal;
+    bool is_stopping = false;
+    std::thread writer;
+};
+
+#endif // __ASYNC_DEBUG_WRITER_H__
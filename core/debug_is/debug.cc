@@ -28,6 +28,7 @@
 #include "i_signal_handler.h"
 #include "hash_combine.h"
 #include "version.h"
+#include "cereal/types/map.hpp"
 
 using namespace std;
 
@@ -124,6 +125,16 @@ public:
         if (stream_name != "FOG" && stream_name != "STDOUT" && stream_name.front() != '/') {
             stream_name = getLogFilesPathConfig() + "/" + stream_name;
         }
+        try {
+            ar(cereal::make_nvp("Asynchronous", is_async));
+        } catch (cereal::Exception &) {
+            ar.setNextName(nullptr);
+        }
+        try {
+            ar(cereal::make_nvp("Binary", is_binary));
+        } catch (cereal::Exception &) {
+            ar.setNextName(nullptr);
+        }
 #define DEFINE_FLAG(flag_name, parent_name)                                                              \
         try {                                                                                            \
             string level;                                                                                \
@@ -155,6 +166,8 @@ DEFINE_FLAG(D_ALL, D_ALL)
 
     FlagsArray flag_values;
     string stream_name;
+    bool is_async = false;
+    bool is_binary = false;
 
 private:
     Debug::DebugLevel
@@ -177,7 +190,7 @@ private:
 
         if (preparing_streams.count(stream_name) > 0) return;
 
-        if (active_streams.count(stream_name) > 0) {
+        if (active_streams.count(stream_name) > 0 && isSameStreamKind(active_streams[stream_name])) {
             preparing_streams[stream_name] = active_streams[stream_name];
             return;
         }
@@ -196,9 +209,20 @@ private:
 
         auto inst_aware =
             Singleton::exists<I_InstanceAwareness>() ? Singleton::Consume<I_InstanceAwareness>::by<Debug>() : nullptr;
-        preparing_streams[stream_name] = make_shared<DebugFileStream>(
-            stream_name + (inst_aware ? inst_aware->getUniqueID("") : "")
-        );
+        string file_name = stream_name + (inst_aware ? inst_aware->getUniqueID("") : "");
+        if (is_binary) {
+            preparing_streams[stream_name] = make_shared<DebugBinaryTraceStream>(file_name);
+            return;
+        }
+        preparing_streams[stream_name] = make_shared<DebugFileStream>(file_name, is_async);
+    }
+
+    bool
+    isSameStreamKind(const shared_ptr<Debug::DebugStream> &stream) const
+    {
+        auto file_stream = dynamic_pointer_cast<DebugFileStream>(stream);
+        if (file_stream != nullptr) return !is_binary && file_stream->isAsync() == is_async;
+        return is_binary == (dynamic_pointer_cast<DebugBinaryTraceStream>(stream) != nullptr);
     }
 
     bool
@@ -294,6 +318,26 @@ private:
     S2C_PARAM(string, output);
 };
 
+class ShowDebugDroppedLines : public ServerRest
+{
+public:
+    void
+    doCall() override
+    {
+        map<string, uint64_t> dropped_lines_by_stream;
+        for (const auto &active_stream : active_streams) {
+            auto file_stream = dynamic_pointer_cast<DebugFileStream>(active_stream.second);
+            if (file_stream == nullptr || !file_stream->isAsync()) continue;
+            dropped_lines_by_stream[active_stream.first] = file_stream->getDroppedLines();
+        }
+        dropped_lines = dropped_lines_by_stream;
+    }
+
+private:
+    using DroppedLines = map<string, uint64_t>;
+    S2C_LABEL_PARAM(DroppedLines, dropped_lines, "droppedLines");
+};
+
 void
 AlertInfo::evalParams()
 {
@@ -561,6 +605,10 @@ Debug::init()
             RestAction::SET,
             "change-debug-config"
         );
+        Singleton::Consume<I_RestApi>::by<Debug>()->addRestCall<ShowDebugDroppedLines>(
+            RestAction::SHOW,
+            "debug-dropped-lines"
+        );
     }
 }
 
@@ -861,7 +909,12 @@ Debug::startStreams(
 {
     for (auto &added_stream : current_active_streams) {
         added_stream->printHeader(time, env, mainloop, level, file_name, func_name, line);
-        stream.addStream(added_stream->getStream());
+        auto trace_record = added_stream->getTraceRecord();
+        if (trace_record != nullptr) {
+            stream.addTraceRecord(trace_record);
+        } else {
+            stream.addStream(added_stream->getStream());
+        }
     }
 
     is_debug_running = true;
@@ -17,7 +17,13 @@
 #include "debug.h"
 
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <tuple>
 
+#include "async_debug_writer.h"
 #include "report/report.h"
 #include "i_agent_details.h"
 #include "i_environment.h"
@@ -56,8 +62,10 @@ public:
 
     virtual void finishMessage() { *stream << std::endl; }
     virtual void sendAlert(const AlertInfo &) {}
+    // Streams that record the raw values of the messages return the record to fill instead of using an ostream
+    virtual Debug::TraceRecord * getTraceRecord() { return nullptr; }
 
-    std::ostream * getStream() const { return stream; }
+    virtual std::ostream * getStream() const { return stream; }
 
 private:
     std::ostream *stream;
@@ -66,7 +74,7 @@ private:
 class DebugFileStream : public Debug::DebugStream
 {
 public:
-    DebugFileStream(const std::string &_file_name);
+    DebugFileStream(const std::string &_file_name, bool _is_async = false);
     ~DebugFileStream();
 
     void
@@ -81,6 +89,10 @@ public:
     ) override;
 
     void finishMessage() override;
+    std::ostream * getStream() const override;
+
+    bool isAsync() const { return async_writer != nullptr; }
+    uint64_t getDroppedLines() const { return isAsync() ? async_writer->getDroppedLines() : 0; }
 
 private:
     void openDebugFile();
@@ -89,6 +101,49 @@ private:
 
     std::string   file_name;
     std::ofstream file;
+    std::unique_ptr<AsyncDebugWriter> async_writer;
+};
+
+// Records messages as call site ids and raw argument values in a ring that is mapped to a file.
+// The file is decoded offline by cpnano_debug.
+class DebugBinaryTraceStream : public Debug::DebugStream
+{
+public:
+    DebugBinaryTraceStream(const std::string &_file_name, uint64_t _capacity = default_capacity);
+    ~DebugBinaryTraceStream();
+
+    void
+    printHeader(
+        I_TimeGet *time,
+        I_Environment *env,
+        I_MainLoop *mainloop,
+        Debug::DebugLevel curr_level,
+        const std::string &file_name,
+        const std::string &func_name,
+        uint line
+    ) override;
+
+    void finishMessage() override;
+    Debug::TraceRecord * getTraceRecord() override { return &getThreadRecord(); }
+
+    static const uint64_t default_capacity = 16 * 1024 * 1024;
+
+private:
+    void openTraceFile(uint64_t capacity);
+    void keepPreviousTrace();
+    void closeTraceFile();
+    uint32_t getCallSite(Debug::DebugLevel level, const std::string &func_name, const std::string &file, uint line);
+    // Every thread fills a record of its own, and reserves room for it in the ring atomically
+    Debug::TraceRecord & getThreadRecord();
+    void writeRecord(const std::string &data);
+
+    const uint64_t id;
+    std::string file_name;
+    char *mapping = nullptr;
+    size_t mapping_size = 0;
+    std::mutex call_sites_lock;
+    std::ofstream call_sites_file;
+    std::map<std::tuple<std::string, uint, Debug::DebugLevel>, uint32_t> call_sites;
 };
 
 class DebugFogStream
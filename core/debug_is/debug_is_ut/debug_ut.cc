@@ -4,6 +4,7 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <thread>
 
 #include "cptest.h"
 #include "config.h"
@@ -16,6 +17,9 @@
 #include "mock/mock_environment.h"
 #include "mock/mock_rest_api.h"
 #include "mock/mock_instance_awareness.h"
+#include "async_debug_writer.h"
+#include "debug_ex.h"
+#include "debug_binary_trace.h"
 
 using namespace std;
 using namespace testing;
@@ -37,6 +41,13 @@ void doFWTrace() { dbgTrace(D_FW) << "FW trace message"; line = to_string(__LINE
 void doPMTrace() { dbgTrace(D_PM) << "PM trace message"; line = to_string(__LINE__); }
 void doPMExecTrace() { dbgTrace(D_PM_EXEC) << "PM_EXEC trace message"; line = to_string(__LINE__); }
 
+void
+doPMTraceValues()
+{
+    dbgTrace(D_PM) << "values " << 5 << ' ' << -3 << ' ' << true << ' ' << 2.5 << ' ' << string("str");
+    line = to_string(__LINE__ - 1);
+}
+
 template <typename ...Args> void doManyFlags(Args ...args) { dbgDebug(args...) << "stab"; line = to_string(__LINE__); }
 
 TEST(DebugBaseTest, alert_obkect)
@@ -735,6 +746,248 @@ TEST_F(DebugConfigTest, file_steam_instance_awareness)
         "[doPMTrace@debug_ut.cc:" + line + "                                     | >>>] PM trace message\n");
 }
 
+TEST_F(DebugConfigTest, asynchronous_file_stream)
+{
+    CPTestTempfile debug_file;
+
+    loadConfiguration("{\"Output\": \"" + debug_file.fname + "\", \"D_PM\": \"Trace\", \"Asynchronous\": true}");
+
+    doPMTrace();
+    string trace_line = line;
+    doFWWarning();
+    string warning_line = line;
+
+    // Replacing the stream writes whatever it still holds
+    loadConfiguration("{\"Output\": \"STDOUT\"}");
+    EXPECT_EQ(
+        debug_file.readFile(),
+        "[doPMTrace@debug_ut.cc:" + trace_line + "                                     | >>>] PM trace message\n"
+        "[doFWWarning@debug_ut.cc:" + warning_line + "                                   | ###] FW warning message\n"
+    );
+}
+
+TEST_F(DebugConfigTest, binary_trace_stream)
+{
+    CPTestTempfile trace_file;
+    loadConfiguration("{\"Output\": \"" + trace_file.fname + "\", \"D_PM\": \"Trace\", \"Binary\": true}");
+
+    doPMTrace();
+    string trace_line = line;
+    doPMTraceValues();
+    string values_line = line;
+    doPMTrace();
+    doFWTrace();
+
+    stringstream decoded;
+    DebugBinaryTrace::Decoder decoder;
+    EXPECT_TRUE(decoder.decode(trace_file.fname, decoded)) << decoder.getError();
+    EXPECT_EQ(
+        decoded.str(),
+        "[doPMTrace@debug_ut.cc:" + trace_line + "                                     | >>>] PM trace message\n"
+        "[doPMTraceValues@debug_ut.cc:" + values_line + "                               | >>>] values 5 -3 1 2.5 str\n"
+        "[doPMTrace@debug_ut.cc:" + trace_line + "                                     | >>>] PM trace message\n"
+    );
+
+    remove((trace_file.fname + DebugBinaryTrace::call_sites_suffix).c_str());
+}
+
+class DebugBinaryTraceTest : public Test
+{
+public:
+    ~DebugBinaryTraceTest()
+    {
+        string previous_trace_file = trace_file.fname + DebugBinaryTrace::previous_trace_suffix;
+        remove((trace_file.fname + DebugBinaryTrace::call_sites_suffix).c_str());
+        remove(previous_trace_file.c_str());
+        remove((previous_trace_file + DebugBinaryTrace::call_sites_suffix).c_str());
+    }
+
+    void
+    trace(const string &message, int id)
+    {
+        stream.printHeader(nullptr, nullptr, nullptr, Debug::DebugLevel::DEBUG, "file.cc", "func", 10);
+        stream.getTraceRecord()->add(message);
+        stream.getTraceRecord()->add(id);
+        stream.finishMessage();
+    }
+
+    string
+    decode(const string &suffix = "")
+    {
+        stringstream decoded;
+        DebugBinaryTrace::Decoder decoder;
+        EXPECT_TRUE(decoder.decode(trace_file.fname + suffix, decoded)) << decoder.getError();
+        return decoded.str();
+    }
+
+    string
+    expectedLine(const string &message, int id)
+    {
+        return "[func@file.cc:10" + string(45, ' ') + " | @@@] " + message + to_string(id) + "\n";
+    }
+
+    CPTestTempfile trace_file;
+    // Room for five short messages
+    DebugBinaryTraceStream stream{trace_file.fname, 256};
+};
+
+TEST_F(DebugBinaryTraceTest, ring_keeps_the_newest_messages)
+{
+    for (int id = 0; id < 5; id++) {
+        trace("message ", id);
+    }
+    EXPECT_EQ(
+        decode(),
+        expectedLine("message ", 0) +
+        expectedLine("message ", 1) +
+        expectedLine("message ", 2) +
+        expectedLine("message ", 3) +
+        expectedLine("message ", 4)
+    );
+
+    // Doesn't fit at the end of the ring, so it overwrites the three oldest messages
+    string long_message(100, 'x');
+    trace(long_message, 5);
+    EXPECT_EQ(decode(), expectedLine("message ", 3) + expectedLine("message ", 4) + expectedLine(long_message, 5));
+
+    trace("message ", 6);
+    EXPECT_EQ(decode(), expectedLine("message ", 4) + expectedLine(long_message, 5) + expectedLine("message ", 6));
+
+    // Larger than the whole ring
+    trace(string(300, 'x'), 7);
+    EXPECT_THAT(decode(), EndsWith("1 debug messages were too large for the trace\n"));
+}
+
+TEST_F(DebugBinaryTraceTest, partly_overwritten_message_is_skipped)
+{
+    trace(string(40, 'x'), 0);
+    for (int id = 1; id < 5; id++) {
+        trace("message ", id);
+    }
+
+    // Each of these ends in the middle of an older message, which can no longer be decoded
+    trace("message ", 5);
+    trace("message ", 6);
+    EXPECT_EQ(
+        decode(),
+        expectedLine("message ", 3) +
+        expectedLine("message ", 4) +
+        expectedLine("message ", 5) +
+        expectedLine("message ", 6)
+    );
+}
+
+TEST_F(DebugBinaryTraceTest, corrupted_message_is_skipped)
+{
+    trace("first ", 0);
+    trace("second ", 1);
+    trace("third ", 2);
+
+    fstream trace_stream(trace_file.fname, ios::in | ios::out | ios::binary);
+    string content((istreambuf_iterator<char>(trace_stream)), istreambuf_iterator<char>());
+    auto corrupted_pos = content.find("second");
+    ASSERT_NE(corrupted_pos, string::npos);
+    trace_stream.seekp(corrupted_pos);
+    trace_stream.put('S');
+    trace_stream.close();
+
+    EXPECT_EQ(decode(), expectedLine("first ", 0) + expectedLine("third ", 2));
+}
+
+TEST_F(DebugBinaryTraceTest, null_string_is_traced)
+{
+    stream.printHeader(nullptr, nullptr, nullptr, Debug::DebugLevel::DEBUG, "file.cc", "func", 10);
+    stream.getTraceRecord()->add(static_cast<const char *>(nullptr));
+    stream.getTraceRecord()->add(0);
+    stream.finishMessage();
+
+    EXPECT_EQ(decode(), expectedLine("(null)", 0));
+}
+
+TEST_F(DebugBinaryTraceTest, previous_trace_is_kept)
+{
+    trace("message ", 0);
+    DebugBinaryTraceStream next_stream(trace_file.fname, 256);
+
+    EXPECT_EQ(decode(DebugBinaryTrace::previous_trace_suffix), expectedLine("message ", 0));
+    EXPECT_EQ(decode(), "");
+}
+
+TEST(AsyncDebugWriterTest, full_ring_drops_lines)
+{
+    CPTestTempfile debug_file;
+    AsyncDebugWriter writer(debug_file.fname, 4, chrono::hours(1));
+
+    for (uint i = 0; i < 6; i++) {
+        writer.push("line " + to_string(i) + "\n");
+    }
+    EXPECT_EQ(writer.getDroppedLines(), 2u);
+
+    writer.flush();
+    EXPECT_EQ(
+        debug_file.readFile(),
+        "line 0\nline 1\nline 2\nline 3\nDebug buffer is full, 2 debug messages were dropped\n"
+    );
+
+    // The ring has room again once it is written, and the drop is reported only once
+    writer.push("line 6\n");
+    writer.flush();
+    EXPECT_THAT(debug_file.readFile(), EndsWith("were dropped\nline 6\n"));
+    EXPECT_EQ(writer.getDroppedLines(), 2u);
+}
+
+TEST(AsyncDebugWriterTest, every_thread_has_its_own_ring)
+{
+    CPTestTempfile debug_file;
+    {
+        AsyncDebugWriter writer(debug_file.fname, 2, chrono::hours(1));
+        writer.push("main thread\n");
+        writer.push("main thread\n");
+
+        thread other_thread([&writer] () { writer.push("other thread\n"); });
+        other_thread.join();
+
+        EXPECT_EQ(writer.getDroppedLines(), 0u);
+    }
+
+    // Destroying the writer writes the remaining lines
+    EXPECT_EQ(debug_file.readFile(), "main thread\nmain thread\nother thread\n");
+}
+
+TEST(AsyncDebugWriterTest, every_thread_formats_its_own_message)
+{
+    CPTestTempfile debug_file;
+    AsyncDebugWriter writer(debug_file.fname, 4, chrono::hours(1));
+    writer.getMessageStream() << "main ";
+
+    thread other_thread(
+        [&writer] ()
+        {
+            writer.getMessageStream() << "other " << 1;
+            writer.pushMessage();
+        }
+    );
+    other_thread.join();
+
+    writer.getMessageStream() << "thread";
+    writer.pushMessage();
+    writer.flush();
+    // The lines are written ring by ring, and the ring of the thread that exited is no longer held
+    EXPECT_EQ(debug_file.readFile(), "main thread\nother 1\n");
+}
+
+TEST(AsyncDebugWriterTest, lines_are_written_in_the_background)
+{
+    CPTestTempfile debug_file;
+    AsyncDebugWriter writer(debug_file.fname, 16, chrono::milliseconds(1));
+    writer.push("background\n");
+
+    for (uint i = 0; i < 1000 && debug_file.readFile().empty(); i++) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    EXPECT_EQ(debug_file.readFile(), "background\n");
+}
+
 TEST_F(DebugConfigTest, override_configuration)
 {
     conf.preload();
@@ -837,6 +1090,7 @@ TEST_F(DebugConfigTest, testSetConfig)
     EXPECT_CALL(mock_rest, mockRestCall(RestAction::SET, "change-debug-config", _))
         .WillOnce(WithArg<2>(Invoke(this, &DebugConfigTest::setDebugConfig))
     );
+    EXPECT_CALL(mock_rest, mockRestCall(RestAction::SHOW, "debug-dropped-lines", _)).WillOnce(Return(true));
     Maybe<I_MainLoop::RoutineID> error_id = genError("no id");
     EXPECT_CALL(mock_mainloop, getCurrentRoutineId()).WillRepeatedly(Return(error_id));
     EXPECT_CALL(mock_time, getWalltimeStr()).WillRepeatedly(Return(string("")));
@@ -1043,7 +1297,7 @@ TEST(DebugFogTest, fog_stream)
         "                    \"agentId\": \"Unknown\",\n"
         "                    \"issuingFunction\": \"handleThresholdReach\",\n"
         "                    \"issuingFile\": \"debug_streams.cc\",\n"
-        "                    \"issuingLine\": 364,\n"
+        "                    \"issuingLine\": 393,\n"
         "                    \"eventTraceId\": \"\",\n"
         "                    \"eventSpanId\": \"\",\n"
         "                    \"issuingEngineVersion\": \"\",\n"
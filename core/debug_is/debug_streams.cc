@@ -13,6 +13,13 @@
 
 #include "debug_ex.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstddef>
+
+#include "debug_binary_trace.h"
 #include "i_time_get.h"
 #include "config.h"
 #include "i_messaging.h"
@@ -88,15 +95,23 @@ Debug::DebugStream::printHeader(
     (*getStream()) << location.str() << prompt.at(curr_level) << "] ";
 }
 
-DebugFileStream::DebugFileStream(const string &_file_name)
+DebugFileStream::DebugFileStream(const string &_file_name, bool _is_async)
         :
     Debug::DebugStream(&file),
     file_name(_file_name)
 {
+    if (_is_async) {
+        async_writer = make_unique<AsyncDebugWriter>(file_name);
+        return;
+    }
     openDebugFile();
 }
 
-DebugFileStream::~DebugFileStream() { closeDebugFile(); }
+DebugFileStream::~DebugFileStream()
+{
+    if (isAsync()) return;
+    closeDebugFile();
+}
 
 void
 DebugFileStream::printHeader(
@@ -108,8 +123,9 @@ DebugFileStream::printHeader(
     const string &func_name,
     uint line)
 {
-    (*Debug::DebugStream::getStream()) << "[";
-    if (time != nullptr) (*Debug::DebugStream::getStream()) << time->getWalltimeStr() << ": ";
+    ostream &message = *getStream();
+    message << "[";
+    if (time != nullptr) message << time->getWalltimeStr() << ": ";
     stringstream os;
     if (env != nullptr) os << getTracingHeader(env);
     if (mainloop != nullptr) os << getCurrentRoutineHeader(mainloop);
@@ -118,13 +134,18 @@ DebugFileStream::printHeader(
     stringstream location;
     location.width(minimal_location_info_length);
     location << left << os.str() <<  " | ";
-    (*Debug::DebugStream::getStream()) << location.str();
-    (*Debug::DebugStream::getStream()) << prompt.at(curr_level) << "] ";
+    message << location.str();
+    message << prompt.at(curr_level) << "] ";
 }
 
 void
 DebugFileStream::finishMessage()
 {
+    if (isAsync()) {
+        async_writer->pushMessage();
+        return;
+    }
+
     file << endl;
     if (file.good()) return;
 
@@ -144,6 +165,14 @@ DebugFileStream::finishMessage()
     }
 }
 
+// In asynchronous mode, every thread formats its messages in a stream of its own
+ostream *
+DebugFileStream::getStream() const
+{
+    if (isAsync()) return &async_writer->getMessageStream();
+    return Debug::DebugStream::getStream();
+}
+
 void
 DebugFileStream::openDebugFile()
 {
@@ -412,3 +441,265 @@ DebugFogStream::getLogLevel() const
 
     return LogLevel::INFO;
 }
+
+static void
+appendTraceValue(string &data, DebugBinaryTrace::ArgType type, const void *value, size_t size)
+{
+    data.push_back(static_cast<char>(type));
+    data.append(static_cast<const char *>(value), size);
+}
+
+void
+Debug::TraceRecord::start(uint32_t call_site, uint64_t timestamp)
+{
+    DebugBinaryTrace::RecordHeader header = { DebugBinaryTrace::record_sync, 0, call_site, 0, timestamp };
+    data.assign(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void
+Debug::TraceRecord::finish()
+{
+    static const uint32_t alignment = DebugBinaryTrace::record_alignment;
+    data.resize((data.size() + alignment - 1) / alignment * alignment, '\0');
+    uint32_t size = data.size();
+    memcpy(&data[offsetof(DebugBinaryTrace::RecordHeader, size)], &size, sizeof(size));
+    uint32_t checksum = DebugBinaryTrace::getChecksum(data.data(), size);
+    memcpy(&data[offsetof(DebugBinaryTrace::RecordHeader, checksum)], &checksum, sizeof(checksum));
+}
+
+void
+Debug::TraceRecord::add(bool value)
+{
+    uint8_t raw_value = value;
+    appendTraceValue(data, DebugBinaryTrace::ArgType::BOOL, &raw_value, sizeof(raw_value));
+}
+
+void
+Debug::TraceRecord::add(char value)
+{
+    appendTraceValue(data, DebugBinaryTrace::ArgType::CHAR, &value, sizeof(value));
+}
+
+void
+Debug::TraceRecord::add(double value)
+{
+    appendTraceValue(data, DebugBinaryTrace::ArgType::DOUBLE, &value, sizeof(value));
+}
+
+void
+Debug::TraceRecord::add(const void *value)
+{
+    uint64_t raw_value = reinterpret_cast<uintptr_t>(value);
+    appendTraceValue(data, DebugBinaryTrace::ArgType::POINTER, &raw_value, sizeof(raw_value));
+}
+
+void
+Debug::TraceRecord::add(const char *value)
+{
+    if (value == nullptr) {
+        data.push_back(static_cast<char>(DebugBinaryTrace::ArgType::NULL_STRING));
+        return;
+    }
+    addString(value, strlen(value));
+}
+
+void
+Debug::TraceRecord::addString(const char *value, size_t size)
+{
+    uint32_t length = size;
+    appendTraceValue(data, DebugBinaryTrace::ArgType::STRING, &length, sizeof(length));
+    data.append(value, length);
+}
+
+void
+Debug::TraceRecord::addInteger(int64_t value)
+{
+    appendTraceValue(data, DebugBinaryTrace::ArgType::INTEGER, &value, sizeof(value));
+}
+
+void
+Debug::TraceRecord::addUnsigned(uint64_t value)
+{
+    appendTraceValue(data, DebugBinaryTrace::ArgType::UNSIGNED, &value, sizeof(value));
+}
+
+static uint64_t
+getNextTraceStreamId()
+{
+    static atomic<uint64_t> next_id{0};
+    return ++next_id;
+}
+
+DebugBinaryTraceStream::DebugBinaryTraceStream(const string &_file_name, uint64_t _capacity)
+        :
+    Debug::DebugStream(nullptr),
+    id(getNextTraceStreamId()),
+    file_name(_file_name)
+{
+    openTraceFile(_capacity);
+}
+
+DebugBinaryTraceStream::~DebugBinaryTraceStream() { closeTraceFile(); }
+
+void
+DebugBinaryTraceStream::printHeader(
+    I_TimeGet *time,
+    I_Environment *,
+    I_MainLoop *,
+    Debug::DebugLevel curr_level,
+    const string &curr_file_name,
+    const string &curr_func_name,
+    uint curr_line)
+{
+    uint64_t timestamp = time != nullptr ? time->getWalltime().count() : 0;
+    getThreadRecord().start(getCallSite(curr_level, curr_func_name, curr_file_name, curr_line), timestamp);
+}
+
+void
+DebugBinaryTraceStream::finishMessage()
+{
+    auto &record = getThreadRecord();
+    record.finish();
+    writeRecord(record.getData());
+}
+
+Debug::TraceRecord &
+DebugBinaryTraceStream::getThreadRecord()
+{
+    // Streams are told apart by their ids rather than their addresses, since a new stream may reuse an address.
+    // A thread keeps the records of streams that were replaced, which are few as streams are replaced only when
+    // the debug configuration changes.
+    thread_local map<uint64_t, Debug::TraceRecord> thread_records;
+    return thread_records[id];
+}
+
+void
+DebugBinaryTraceStream::openTraceFile(uint64_t capacity)
+{
+    capacity = min<uint64_t>(capacity, UINT32_MAX) / DebugBinaryTrace::record_alignment;
+    capacity *= DebugBinaryTrace::record_alignment;
+    mapping_size = sizeof(DebugBinaryTrace::FileHeader) + capacity;
+
+    keepPreviousTrace();
+    int fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        cerr << "Failed to open binary trace file. File path: " << file_name << endl;
+        return;
+    }
+
+    void *trace_mapping = MAP_FAILED;
+    if (ftruncate(fd, mapping_size) == 0) {
+        trace_mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (trace_mapping == MAP_FAILED) {
+        cerr << "Failed to map binary trace file. File path: " << file_name << endl;
+        return;
+    }
+    mapping = static_cast<char *>(trace_mapping);
+
+    auto header = reinterpret_cast<DebugBinaryTrace::FileHeader *>(mapping);
+    memcpy(header->magic, DebugBinaryTrace::file_magic, sizeof(header->magic));
+    header->version = DebugBinaryTrace::file_version;
+    header->header_size = sizeof(DebugBinaryTrace::FileHeader);
+    header->capacity = capacity;
+    header->written = 0;
+    header->dropped = 0;
+
+    call_sites_file.open(file_name + DebugBinaryTrace::call_sites_suffix, ofstream::trunc);
+    if (!call_sites_file.good()) cerr << "Failed to open trace call sites file. File path: " << file_name << endl;
+}
+
+// The trace of a process that crashed is usually what is looked for after it restarts
+void
+DebugBinaryTraceStream::keepPreviousTrace()
+{
+    struct stat trace_stat;
+    if (stat(file_name.c_str(), &trace_stat) != 0 || trace_stat.st_size == 0) return;
+
+    string previous_file_name = file_name + DebugBinaryTrace::previous_trace_suffix;
+    string call_sites_file_name = file_name + DebugBinaryTrace::call_sites_suffix;
+    string previous_call_sites_file_name = previous_file_name + DebugBinaryTrace::call_sites_suffix;
+    if (rename(file_name.c_str(), previous_file_name.c_str()) != 0) {
+        cerr << "Failed to keep the previous binary trace file. File path: " << file_name << endl;
+        return;
+    }
+    rename(call_sites_file_name.c_str(), previous_call_sites_file_name.c_str());
+}
+
+void
+DebugBinaryTraceStream::closeTraceFile()
+{
+    if (mapping == nullptr) return;
+    munmap(mapping, mapping_size);
+    mapping = nullptr;
+}
+
+uint32_t
+DebugBinaryTraceStream::getCallSite(
+    Debug::DebugLevel level,
+    const string &func_name,
+    const string &file,
+    uint line)
+{
+    auto key = make_tuple(file, line, level);
+    lock_guard<mutex> guard(call_sites_lock);
+    auto call_site = call_sites.find(key);
+    if (call_site != call_sites.end()) return call_site->second;
+
+    uint32_t id = call_sites.size() + 1;
+    call_sites.emplace(key, id);
+    call_sites_file << id << '\t' << prompt.at(level) << '\t' << func_name << '\t' << file << '\t' << line << endl;
+    return id;
+}
+
+void
+DebugBinaryTraceStream::writeRecord(const string &data)
+{
+    if (mapping == nullptr) return;
+
+    auto header = reinterpret_cast<DebugBinaryTrace::FileHeader *>(mapping);
+    char *ring = mapping + header->header_size;
+    if (data.size() > header->capacity) {
+        __atomic_fetch_add(&header->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // Records never wrap around, so a record that doesn't fit at the end of the ring reserves the rest of the ring
+    // as well, and starts from the beginning
+    uint64_t written = __atomic_load_n(&header->written, __ATOMIC_RELAXED);
+    uint64_t offset;
+    uint64_t left;
+    do {
+        offset = written % header->capacity;
+        left = header->capacity - offset;
+    } while (
+        !__atomic_compare_exchange_n(
+            &header->written,
+            &written,
+            written + (data.size() > left ? left : 0) + data.size(),
+            true,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_RELAXED
+        )
+    );
+
+    if (data.size() > left) {
+        // The rest of the ring is skipped by the decoder
+        if (left >= sizeof(DebugBinaryTrace::RecordHeader)) {
+            DebugBinaryTrace::RecordHeader padding = {
+                DebugBinaryTrace::record_sync,
+                static_cast<uint32_t>(left),
+                DebugBinaryTrace::padding_call_site,
+                0,
+                0
+            };
+            memcpy(ring + offset, &padding, sizeof(padding));
+            uint32_t checksum = DebugBinaryTrace::getChecksum(ring + offset, left);
+            memcpy(ring + offset + offsetof(DebugBinaryTrace::RecordHeader, checksum), &checksum, sizeof(checksum));
+        }
+        offset = 0;
+    }
+
+    memcpy(ring + offset, data.data(), data.size());
+}
@@ -12,11 +12,91 @@
 // limitations under the License.
 
 #include "context.h"
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
 #include "i_environment.h"
 #include "singleton.h"
 
 using namespace std;
 
+class InternedKeys
+{
+public:
+    uint
+    getId(const string &name, const type_index &type)
+    {
+        auto &types = ids[name];
+        for (auto &entry : types) {
+            if (entry.first == type) return entry.second;
+        }
+        uint id = names.size();
+        names.push_back(name);
+        types.emplace_back(type, id);
+        return id;
+    }
+
+    uint
+    findId(const string &name, const type_index &type) const
+    {
+        auto types = ids.find(name);
+        if (types == ids.end()) return Context::unknown_key_id;
+        for (auto &entry : types->second) {
+            if (entry.first == type) return entry.second;
+        }
+        return Context::unknown_key_id;
+    }
+
+    const string & getName(uint id) const { return names[id]; }
+
+private:
+    unordered_map<string, vector<pair<type_index, uint>>> ids;
+    // A deque keeps references to the names stable as new keys are added
+    deque<string> names;
+};
+
+static InternedKeys &
+getInternedKeys()
+{
+    static InternedKeys interned_keys;
+    return interned_keys;
+}
+
+uint
+Context::getKeyId(const string &name, const type_index &type)
+{
+    return getInternedKeys().getId(name, type);
+}
+
+uint
+Context::findKeyId(const string &name, const type_index &type)
+{
+    return getInternedKeys().findId(name, type);
+}
+
+const string &
+Context::getKeyName(uint id)
+{
+    return getInternedKeys().getName(id);
+}
+
+uint64_t
+Context::getNextRevision()
+{
+    static uint64_t next_revision = 0;
+    return ++next_revision;
+}
+
+void
+Context::setFunctionKey(uint id, bool is_function)
+{
+    auto function_key = find(function_key_ids.begin(), function_key_ids.end(), id);
+    if (is_function && function_key == function_key_ids.end()) function_key_ids.push_back(id);
+    if (!is_function && function_key != function_key_ids.end()) function_key_ids.erase(function_key);
+}
+
 void
 Context::activate()
 {
@@ -36,7 +116,7 @@ Context::getAllStrings(const EnvKeyAttr::ParamAttr &param) const
     for (auto &entry : values) {
         if (entry.first.doesMatch(param)) {
             auto entry_value = entry.second->getString();
-            if (entry_value.ok()) result[entry.first.first] = *entry_value;
+            if (entry_value.ok()) result[entry.first.getName()] = *entry_value;
         }
     }
     return result;
@@ -74,7 +154,7 @@ Context::getAllUints(const EnvKeyAttr::ParamAttr &param) const
     for (auto &entry : values) {
         if (entry.first.doesMatch(param)) {
             auto entry_value = entry.second->getUint();
-            if (entry_value.ok()) result[entry.first.first] = *entry_value;
+            if (entry_value.ok()) result[entry.first.getName()] = *entry_value;
         }
     }
     return result;
@@ -87,7 +167,7 @@ Context::getAllBools(const EnvKeyAttr::ParamAttr &param) const
     for (auto &entry : values) {
         if (entry.first.doesMatch(param)) {
             auto entry_value = entry.second->getBool();
-            if (entry_value.ok()) result[entry.first.first] = *entry_value;
+            if (entry_value.ok()) result[entry.first.getName()] = *entry_value;
         }
     }
     return result;
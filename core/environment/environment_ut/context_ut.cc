@@ -200,6 +200,182 @@ TEST_F(ContextTest, unregister_key_of_func)
     EXPECT_THAT(ctx.get<int>("new_func_key"), IsError(Context::Error::NO_VALUE));
 }
 
+TEST_F(ContextTest, get_by_interned_key)
+{
+    EnvKey<int> int_key("interned_key");
+    EnvKey<string> str_key("interned_key");
+    EXPECT_NE(int_key.getId(), str_key.getId());
+    EXPECT_EQ(EnvKey<int>("interned_key").getId(), int_key.getId());
+    EXPECT_EQ(int_key.getName(), "interned_key");
+
+    EXPECT_THAT(ctx.get(int_key), IsError(Context::Error::NO_VALUE));
+    ctx.registerValue("interned_key", 5);
+    EXPECT_THAT(ctx.get(int_key), IsValue(5));
+    EXPECT_THAT(ctx.get(str_key), IsError(Context::Error::NO_VALUE));
+
+    ctx.unregisterKey<int>("interned_key");
+    EXPECT_THAT(ctx.get(int_key), IsError(Context::Error::NO_VALUE));
+}
+
+TEST_F(ContextTest, quick_access_value_takes_precedence)
+{
+    ctx.registerValue("quick_key", 1);
+    ctx.registerQuickAccessValue("quick_key", 2);
+    EXPECT_THAT(ctx.get<int>("quick_key"), IsValue(2));
+    EXPECT_THAT(ctx.get(EnvKey<int>("quick_key")), IsValue(2));
+
+    ctx.unregisterKey<int>("quick_key");
+    EXPECT_THAT(ctx.get<int>("quick_key"), IsError(Context::Error::NO_VALUE));
+}
+
+TEST_F(ContextTest, get_by_interned_key_from_environment)
+{
+    ConfigComponent conf;
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_timer;
+    ::Environment env;
+    auto i_env = Singleton::Consume<I_Environment>::from(env);
+    EnvKey<int> key("env_interned_key");
+
+    ctx.registerValue("env_interned_key", 1);
+    ctx.activate();
+    Context another_ctx;
+    another_ctx.registerValue("other_key", 2);
+    another_ctx.activate();
+    EXPECT_THAT(i_env->get(key), IsValue(1));
+    EXPECT_THAT(i_env->get<int>("env_interned_key"), IsValue(1));
+
+    another_ctx.registerValue("env_interned_key", 3);
+    EXPECT_THAT(i_env->get(key), IsValue(3));
+    another_ctx.deactivate();
+    ctx.deactivate();
+    EXPECT_THAT(i_env->get(key), IsError(Context::Error::NO_VALUE));
+}
+
+TEST_F(ContextTest, getter_deactivating_contexts)
+{
+    ConfigComponent conf;
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_timer;
+    ::Environment env;
+    auto i_env = Singleton::Consume<I_Environment>::from(env);
+
+    ctx.registerValue("deactivating_key", 1);
+    ctx.activate();
+    Context middle_ctx;
+    middle_ctx.activate();
+    Context top_ctx;
+    top_ctx.registerFunc<int>(
+        "deactivating_key",
+        [&] () -> Context::Return<int>
+        {
+            top_ctx.deactivate();
+            middle_ctx.deactivate();
+            return genError(Context::Error::NO_VALUE);
+        }
+    );
+    top_ctx.activate();
+
+    EXPECT_THAT(i_env->get(EnvKey<int>("deactivating_key")), IsValue(1));
+    ctx.deactivate();
+}
+
+TEST_F(ContextTest, revision_changes_with_values)
+{
+    Context other_ctx;
+    EXPECT_NE(ctx.getRevision(), other_ctx.getRevision());
+
+    auto revision = ctx.getRevision();
+    ctx.registerValue("revision_key", 1);
+    EXPECT_NE(ctx.getRevision(), revision);
+
+    revision = ctx.getRevision();
+    ctx.get<int>("revision_key");
+    EXPECT_EQ(ctx.getRevision(), revision);
+
+    ctx.unregisterKey<int>("revision_key");
+    EXPECT_NE(ctx.getRevision(), revision);
+}
+
+TEST_F(ContextTest, function_values_are_tracked)
+{
+    ctx.registerValue("plain_key", 1);
+    EXPECT_FALSE(ctx.hasFunctionValues());
+
+    ctx.registerFunc<int>("func_key", [] () { return 2; });
+    EXPECT_TRUE(ctx.hasFunctionValues());
+
+    // A value that replaces a function is still considered one, until it is unregistered
+    ctx.registerValue("func_key", 3);
+    EXPECT_TRUE(ctx.hasFunctionValues());
+    ctx.unregisterKey<int>("func_key");
+    EXPECT_FALSE(ctx.hasFunctionValues());
+}
+
+TEST_F(ContextTest, rulebase_configuration_is_memoized)
+{
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_timer;
+    ConfigComponent conf;
+    ::Environment env;
+    env.preload();
+    env.init();
+    auto i_config = Singleton::Consume<Config::I_Config>::from(conf);
+    registerExpectedConfiguration<int>("rulebase", "memoized");
+    registerExpectedConfiguration<int>("other", "notMemoized");
+
+    string config_json =
+        "{"
+        "    \"rulebase\": {"
+        "        \"memoized\": ["
+        "            { \"context\": \"Not(All())\", \"value\": 1 },"
+        "            { \"context\": \"All()\", \"value\": 2 }"
+        "        ]"
+        "    },"
+        "    \"other\": {"
+        "        \"notMemoized\": [ { \"context\": \"All()\", \"value\": 3 } ]"
+        "    }"
+        "}";
+    istringstream config_stream(config_json);
+    EXPECT_TRUE(i_config->loadConfiguration(config_stream));
+    i_config->enableCacheTracking();
+    i_config->resetCacheStats();
+
+    ctx.activate();
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(2));
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(2));
+    EXPECT_THAT(getConfiguration<int>("other", "notMemoized"), IsValue(3));
+    EXPECT_EQ(i_config->getRulebaseMemoMisses(), 1u);
+    EXPECT_EQ(i_config->getRulebaseMemoHits(), 1u);
+
+    // A change to the active contexts may change which rule matches
+    ctx.registerValue("memo_key", 1);
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(2));
+    Context another_ctx;
+    another_ctx.activate();
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(2));
+    EXPECT_EQ(i_config->getRulebaseMemoMisses(), 3u);
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(2));
+    EXPECT_EQ(i_config->getRulebaseMemoHits(), 2u);
+    another_ctx.deactivate();
+
+    // Loading a new policy invalidates the memo
+    setConfiguration<int>(4, "rulebase", "memoized");
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(4));
+    EXPECT_EQ(i_config->getRulebaseMemoMisses(), 4u);
+
+    // A function may return a different value on every call, so nothing is memoized while it is active
+    ctx.registerFunc<int>("memo_func", [] () { return 5; });
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(4));
+    EXPECT_THAT(getConfiguration<int>("rulebase", "memoized"), IsValue(4));
+    EXPECT_EQ(i_config->getRulebaseMemoMisses(), 6u);
+    EXPECT_EQ(i_config->getRulebaseMemoHits(), 2u);
+    ctx.deactivate();
+
+    i_config->disableCacheTracking();
+    env.fini();
+}
+
 TEST(ParamTest, matching)
 {
     using namespace EnvKeyAttr;
@@ -75,6 +75,27 @@ public:
     string r;
 };
 
+class InactiveListener : public Listener<IntEventReturnInt>
+{
+public:
+    string getListenerName() const override { return "InactiveListener"; }
+    bool isActiveForAsset() const override { return false; }
+
+    int respond(const IntEventReturnInt &) override { responded = true; return 0; }
+
+    bool responded = false;
+};
+
+class PrioritizedListener : public IntEventReturnIntListener
+{
+public:
+    PrioritizedListener(int _r, uint _priority) : IntEventReturnIntListener(_r), priority(_priority) {}
+
+    uint getDispatchPriority() const override { return priority; }
+
+    uint priority;
+};
+
 class StringEventListener : public Listener<StringEvent>
 {
 public:
@@ -240,3 +261,56 @@ TEST(Event, dual_listener)
     EXPECT_THAT(event1.query(), ElementsAre());
     EXPECT_THAT(event2.performNamedQuery(), ElementsAre());
 }
+
+TEST(Event, dispatch)
+{
+    IntEventReturnIntListener listen1(2);
+    listen1.registerListener();
+    InactiveListener listen2;
+    listen2.registerListener();
+
+    vector<ListenerResponse<int>> responses;
+    IntEventReturnInt(8).dispatch(responses);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].getListenerName(), "IntEventReturnIntListener");
+    EXPECT_EQ(responses[0].getResponse(), 2);
+    EXPECT_EQ(listen1.j, 8);
+    EXPECT_FALSE(listen2.responded);
+
+    IntEventReturnIntListener listen3(75);
+    listen3.registerListener();
+    IntEventReturnInt(9).dispatch(responses);
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_EQ(responses[0].getResponse() + responses[1].getResponse(), 77);
+    EXPECT_EQ(listen3.j, 9);
+
+    listen1.unregisterListener();
+    listen3.unregisterListener();
+    IntEventReturnInt(10).dispatch(responses);
+    EXPECT_TRUE(responses.empty());
+    EXPECT_EQ(listen1.j, 9);
+}
+
+TEST(Event, dispatch_by_priority)
+{
+    PrioritizedListener listen1(1, 30);
+    listen1.registerListener();
+    PrioritizedListener listen2(2, 10);
+    listen2.registerListener();
+    PrioritizedListener listen3(3, 20);
+    listen3.registerListener();
+
+    vector<ListenerResponse<int>> responses;
+    IntEventReturnInt(8).dispatch(responses);
+    vector<int> values;
+    for (const auto &response : responses) {
+        values.push_back(response.getResponse());
+    }
+    EXPECT_THAT(values, ElementsAre(2, 3, 1));
+
+    IntEventReturnInt(9).dispatch(responses, [] (int value) { return value == 3; });
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_EQ(responses.back().getResponse(), 3);
+    EXPECT_EQ(listen3.j, 9);
+    EXPECT_EQ(listen1.j, 8);
+}
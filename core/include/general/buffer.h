@@ -23,6 +23,7 @@
 
 #include "maybe_res.h"
 #include "debug.h"
+#include "buffer/seg_vector.h"
 
 class Buffer final
 {
@@ -55,6 +56,8 @@ private:
     // The "DataContainer" class represent a shared piece of memory - so if two idifferent buffers buffers
     // can both reference the same memory segement without copying it.
     class DataContainer;
+    // The "DataContainerPtr" class is the reference counted pointer through which segments share a "DataContainer".
+    class DataContainerPtr;
 
 public:
     // The "Segment" class represent a countinuous part of the buffer. Unlike the "DataContainer" class, it is not
@@ -62,9 +65,12 @@ public:
     // also has additional capabilities of scoping, compairson, and handling copying-in of the memory.
     class Segment;
 
+    // Most buffers have a single segment, which is kept inside the buffer itself rather than on the heap.
+    using SegVector = BufferSegVector<Segment, 40>;
+
     // The "SegIterator" class allow iterating over the different segments of the buffer (for specifc part of the code
     // that require very high performance). The "SegRange" class is used for the `for ( : )` syntax.
-    using SegIterator = std::vector<Segment>::const_iterator;
+    using SegIterator = SegVector::const_iterator;
     class SegRange final
     {
     public:
@@ -116,6 +122,11 @@ public:
 
     Maybe<uint> findFirstOf(char ch, uint start = 0) const;
     Maybe<uint> findFirstOf(const Buffer &buf, uint start = 0) const;
+    // The "find" methods search each segment in place (including matches that cross between segments), so they
+    // don't make the buffer contiguous. The "caseInsensitiveFind" method compares the ASCII letters without case.
+    Maybe<uint> find(const std::string &pattern, uint start = 0) const;
+    Maybe<uint> caseInsensitiveFind(const std::string &pattern, uint start = 0) const;
+    bool contains(const std::string &pattern) const { return find(pattern).ok(); }
     Maybe<uint> findFirstNotOf(char ch, uint start = 0) const;
     Maybe<uint> findLastOf(char ch) const { return findLastOf(ch, len); }
     Maybe<uint> findLastOf(char ch, uint start) const;
@@ -155,7 +166,8 @@ public:
 
 private:
     void evalFastPath() const;
-    std::vector<Segment> segs;
+    Maybe<uint> findPattern(const std::string &pattern, uint start, bool is_case_insensitive) const;
+    SegVector segs;
     uint len = 0;
     // The "fast_path_ptr" and "fast_path_len" are used to allow a direct fast access to the beginning of the buffer
     // (the first segment), which is the typical case.
@@ -34,7 +34,7 @@ private:
     friend class Buffer;
     CharIterator(const SegIterator &_cur, const SegIterator &_end, uint _offset);
     CharIterator(const SegIterator &_end);
-    SegIterator cur_seg, end_seg;
+    SegIterator cur_seg = nullptr, end_seg = nullptr;
     const u_char *ptr = nullptr;
     uint offset = 0, size = 0;
 };
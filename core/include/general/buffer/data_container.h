@@ -32,8 +32,7 @@ public:
     void
     takeOwnership()
     {
-        vec = std::vector<u_char>(ptr, ptr + len);
-        ptr = vec.data();
+        copyIn(ptr);
         is_owned = true;
     }
 
@@ -41,7 +40,7 @@ public:
     void
     save(Archive &ar, uint32_t) const
     {
-        if (is_owned) {
+        if (is_owned && ptr == vec.data()) {
             ar(vec);
         } else {
             std::vector<u_char> data(ptr, ptr + len);
@@ -60,12 +59,138 @@ public:
     }
 
 private:
-    // If the memory is OWNED (not STATIC or VOLATILE), the "vec" member is holding it - otherwise it is empty.
+    friend class DataContainerPtr;
+
+    // Small memory is copied into "small_data" rather than to a separate allocation of "vec".
+    void copyIn(const u_char *_ptr);
+
+    static const uint small_data_size = 32;
+
+    // If the memory is OWNED (not STATIC or VOLATILE), the "vec" or "small_data" members are holding it - otherwise
+    // they are unused.
     std::vector<u_char> vec;
+    u_char small_data[small_data_size];
     // The "ptr" member points to the the beginning of the data, regardless of the type of memory.
     const u_char *ptr = nullptr;
     uint len = 0;
     bool is_owned = true;
+    // The number of "DataContainerPtr" instances that point to the container.
+    uint ref_count = 0;
+};
+
+// Buffers are only used by the thread of the mainloop, so the reference count of the "DataContainer" is a plain
+// counter rather than an atomic one (as it is in std::shared_ptr). The containers are taken from the pool allocator
+// of the thread.
+class Buffer::DataContainerPtr
+{
+public:
+    DataContainerPtr() {}
+    DataContainerPtr(const DataContainerPtr &other) : DataContainerPtr(other.ptr) {}
+    DataContainerPtr(DataContainerPtr &&other) : ptr(other.ptr) { other.ptr = nullptr; }
+    ~DataContainerPtr() { release(); }
+
+    DataContainerPtr &
+    operator=(const DataContainerPtr &other)
+    {
+        if (other.ptr != nullptr) other.ptr->ref_count++;
+        release();
+        ptr = other.ptr;
+        return *this;
+    }
+
+    DataContainerPtr &
+    operator=(DataContainerPtr &&other)
+    {
+        if (this == &other) return *this;
+        release();
+        ptr = other.ptr;
+        other.ptr = nullptr;
+        return *this;
+    }
+
+    template <typename ... Args>
+    static DataContainerPtr
+    make(Args && ... args)
+    {
+        BufferPoolAllocator<DataContainer> allocator;
+        DataContainer *container = allocator.allocate(1);
+        try {
+            new (container) DataContainer(std::forward<Args>(args)...);
+        } catch (...) {
+            allocator.deallocate(container, 1);
+            throw;
+        }
+        return DataContainerPtr(container);
+    }
+
+    DataContainer * operator->() const { return ptr; }
+    DataContainer & operator*() const { return *ptr; }
+    bool unique() const { return ptr != nullptr && ptr->ref_count == 1; }
+
+    // The pointer is serialized the same way as a std::shared_ptr is, so a container that several segments share is
+    // saved once, and is shared again when it is loaded.
+    template<class Archive>
+    void
+    save(Archive &ar) const
+    {
+        ar(cereal::make_nvp("ptr_wrapper", Wrapper(const_cast<DataContainerPtr &>(*this))));
+    }
+
+    template<class Archive>
+    void
+    load(Archive &ar)
+    {
+        ar(cereal::make_nvp("ptr_wrapper", Wrapper(*this)));
+    }
+
+private:
+    class Wrapper
+    {
+    public:
+        Wrapper(DataContainerPtr &_ref) : ref(_ref) {}
+
+        template<class Archive>
+        void
+        save(Archive &ar) const
+        {
+            uint32_t id = ar.registerSharedPointer(ref.ptr);
+            ar(cereal::make_nvp("id", id));
+            if (id & cereal::detail::msb_32bit) ar(cereal::make_nvp("data", *ref.ptr));
+        }
+
+        template<class Archive>
+        void
+        load(Archive &ar)
+        {
+            uint32_t id;
+            ar(cereal::make_nvp("id", id));
+            if (id & cereal::detail::msb_32bit) {
+                auto loaded = make();
+                // The archive keeps a reference to the container, for the later segments that share it
+                ar.registerSharedPointer(id, std::shared_ptr<void>(loaded.ptr, [loaded] (void *) {}));
+                ar(cereal::make_nvp("data", *loaded));
+                ref = std::move(loaded);
+            } else {
+                ref = DataContainerPtr(static_cast<DataContainer *>(ar.getSharedPointer(id).get()));
+            }
+        }
+
+    private:
+        DataContainerPtr &ref;
+    };
+
+    explicit DataContainerPtr(DataContainer *_ptr) : ptr(_ptr) { if (ptr != nullptr) ptr->ref_count++; }
+
+    void
+    release()
+    {
+        if (ptr == nullptr || --ptr->ref_count != 0) return;
+        ptr->~DataContainer();
+        BufferPoolAllocator<DataContainer>().deallocate(ptr, 1);
+        ptr = nullptr;
+    }
+
+    DataContainer *ptr = nullptr;
 };
 
 #endif // __BUFFER_DATA_CONTAINER_H__
@@ -45,7 +45,7 @@ public:
 private:
     friend class Buffer;
 
-    InternalPtr(const T *_ptr, const std::shared_ptr<DataContainer> &data) : ptr(_ptr), ref(data) {}
+    InternalPtr(const T *_ptr, const DataContainerPtr &data) : ptr(_ptr), ref(data) {}
     template<typename O>
     InternalPtr(InternalPtr<O> &&other)
             :
@@ -54,7 +54,7 @@ private:
     {}
 
     const T *ptr;
-    std::shared_ptr<DataContainer> ref;
+    DataContainerPtr ref;
 };
 
 #endif // __BUFFER_INTERNAL_PTR_H__
@@ -0,0 +1,122 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __BUFFER_POOL_ALLOCATOR_H__
+#define __BUFFER_POOL_ALLOCATOR_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// The "BufferPool" class counts the allocations that the pools of the thread could not serve, and had to take from
+// the heap.
+class BufferPool
+{
+public:
+    static uint64_t getHeapAllocations() { return heapAllocations(); }
+
+private:
+    template <typename T> friend class BufferPoolAllocator;
+
+    static uint64_t &
+    heapAllocations()
+    {
+        static thread_local uint64_t heap_allocations = 0;
+        return heap_allocations;
+    }
+};
+
+// Buffers are mostly small and short lived, so the memory of their single segments and data containers is kept
+// after they are released, in a free list of the thread for every size of object. Allocating more than one object
+// at a time goes directly to the heap.
+template <std::size_t object_size>
+class BufferFreeList
+{
+public:
+    static void *
+    pop()
+    {
+        if (head == nullptr) return nullptr;
+        void *block = head;
+        head = *static_cast<void **>(block);
+        count--;
+        return block;
+    }
+
+    static bool
+    push(void *block)
+    {
+        static thread_local Cleanup cleanup;
+        if (count >= max_blocks) return false;
+        *static_cast<void **>(block) = head;
+        head = block;
+        count++;
+        return true;
+    }
+
+private:
+    static_assert(object_size >= sizeof(void *), "Blocks in the free list need to be able to hold a pointer");
+
+    // Releases the blocks when the thread ends. Blocks that are released later on go back to the heap.
+    class Cleanup
+    {
+    public:
+        ~Cleanup()
+        {
+            while (void *block = pop()) {
+                ::operator delete(block);
+            }
+            count = max_blocks;
+        }
+    };
+
+    static const std::size_t max_blocks = 1024;
+    static thread_local void *head;
+    static thread_local std::size_t count;
+};
+
+template <std::size_t object_size> thread_local void *BufferFreeList<object_size>::head = nullptr;
+template <std::size_t object_size> thread_local std::size_t BufferFreeList<object_size>::count = 0;
+
+template <typename T>
+class BufferPoolAllocator
+{
+public:
+    using value_type = T;
+
+    BufferPoolAllocator() = default;
+    template <typename U> BufferPoolAllocator(const BufferPoolAllocator<U> &) {}
+
+    T *
+    allocate(std::size_t n)
+    {
+        if (n == 1) {
+            void *block = BufferFreeList<sizeof(T)>::pop();
+            if (block != nullptr) return static_cast<T *>(block);
+        }
+        BufferPool::heapAllocations()++;
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *ptr, std::size_t n)
+    {
+        if (n == 1 && BufferFreeList<sizeof(T)>::push(ptr)) return;
+        ::operator delete(ptr);
+    }
+
+    template <typename U> bool operator==(const BufferPoolAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const BufferPoolAllocator<U> &) const { return false; }
+};
+
+#endif // __BUFFER_POOL_ALLOCATOR_H__
@@ -0,0 +1,220 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __BUFFER_SEG_VECTOR_H__
+#define __BUFFER_SEG_VECTOR_H__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "cereal/cereal.hpp"
+#include "buffer/pool_allocator.h"
+
+// The "BufferSegVector" class holds the segments of a buffer. Most buffers have a single segment, which is kept in
+// the "inline_storage" member (of "inline_size" bytes) rather than on the heap. Buffers with more segments keep them
+// in memory that comes from the pool allocator.
+// Segments are moved between places in memory through `T::relocate`, which, unlike the move constructor, keeps the
+// volatility of the segment as is. Moving the segments of a buffer doesn't end the life of the buffer, so a PRIMARY
+// segment that moves is still the PRIMARY one.
+template <typename T, std::size_t inline_size>
+class BufferSegVector
+{
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    BufferSegVector() {}
+    BufferSegVector(const BufferSegVector &other) { append(other.begin(), other.end()); }
+    BufferSegVector(BufferSegVector &&other) { takeFrom(other); }
+    ~BufferSegVector() { clear(); release(); }
+
+    BufferSegVector &
+    operator=(const BufferSegVector &other)
+    {
+        if (this == &other) return *this;
+        clear();
+        append(other.begin(), other.end());
+        return *this;
+    }
+
+    BufferSegVector &
+    operator=(BufferSegVector &&other)
+    {
+        if (this == &other) return *this;
+        clear();
+        release();
+        takeFrom(other);
+        return *this;
+    }
+
+    std::size_t size() const { return count; }
+
+    iterator begin() { return items(); }
+    iterator end() { return items() + count; }
+    const_iterator begin() const { return items(); }
+    const_iterator end() const { return items() + count; }
+
+    T & front() { return items()[0]; }
+    const T & front() const { return items()[0]; }
+    T & back() { return items()[count - 1]; }
+    const T & back() const { return items()[count - 1]; }
+
+    void
+    reserve(std::size_t new_capacity)
+    {
+        if (new_capacity <= capacity) return;
+
+        T *new_items = BufferPoolAllocator<T>().allocate(new_capacity);
+        T *old_items = items();
+        for (std::size_t index = 0; index < count; index++) {
+            T::relocate(new_items + index, old_items[index]);
+        }
+        release();
+        heap_items = new_items;
+        capacity = new_capacity;
+    }
+
+    template <typename ... Args>
+    void
+    emplace_back(Args && ... args)
+    {
+        grow(count + 1);
+        new (items() + count) T(std::forward<Args>(args)...);
+        count++;
+    }
+
+    void push_back(const T &item) { emplace_back(item); }
+    void push_back(T &&item) { emplace_back(std::move(item)); }
+
+    void
+    append(const_iterator first, const_iterator last)
+    {
+        std::size_t added = last - first;
+        // The items may be appended from the vector itself, so they are found again after it grows
+        bool is_own_item = first >= begin() && first < end();
+        std::size_t first_index = first - begin();
+        grow(count + added);
+        if (is_own_item) first = begin() + first_index;
+
+        for (std::size_t index = 0; index < added; index++) {
+            new (items() + count) T(first[index]);
+            count++;
+        }
+    }
+
+    iterator
+    erase(iterator pos)
+    {
+        pos->~T();
+        for (iterator next = pos + 1; next != end(); next++) {
+            T::relocate(next - 1, *next);
+        }
+        count--;
+        return pos;
+    }
+
+    void
+    pop_back()
+    {
+        back().~T();
+        count--;
+    }
+
+    void
+    clear()
+    {
+        for (auto &item : *this) {
+            item.~T();
+        }
+        count = 0;
+    }
+
+    // Serialized the same way as a std::vector is
+    template <class Archive>
+    void
+    save(Archive &ar) const
+    {
+        ar(cereal::make_size_tag(static_cast<cereal::size_type>(count)));
+        for (const auto &item : *this) {
+            ar(item);
+        }
+    }
+
+    template <class Archive>
+    void
+    load(Archive &ar)
+    {
+        cereal::size_type new_size;
+        ar(cereal::make_size_tag(new_size));
+        clear();
+        reserve(new_size);
+        for (cereal::size_type index = 0; index < new_size; index++) {
+            emplace_back();
+            ar(back());
+        }
+    }
+
+private:
+    T *
+    items()
+    {
+        static_assert(sizeof(T) <= inline_size, "The inline storage of the vector is too small for an item");
+        static_assert(
+            alignof(T) <= alignof(decltype(inline_storage)),
+            "The inline storage of the vector isn't aligned for an item"
+        );
+        return heap_items != nullptr ? heap_items : reinterpret_cast<T *>(&inline_storage);
+    }
+
+    const T * items() const { return const_cast<BufferSegVector *>(this)->items(); }
+
+    void
+    grow(std::size_t needed)
+    {
+        if (needed > capacity) reserve(needed > 2 * capacity ? needed : 2 * capacity);
+    }
+
+    void
+    release()
+    {
+        if (heap_items == nullptr) return;
+        BufferPoolAllocator<T>().deallocate(heap_items, capacity);
+        heap_items = nullptr;
+        capacity = 1;
+    }
+
+    void
+    takeFrom(BufferSegVector &other)
+    {
+        if (other.heap_items != nullptr) {
+            heap_items = other.heap_items;
+            capacity = other.capacity;
+            other.heap_items = nullptr;
+            other.capacity = 1;
+        } else if (other.count != 0) {
+            T::relocate(items(), other.items()[0]);
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+    T *heap_items = nullptr;
+    std::size_t count = 0;
+    std::size_t capacity = 1;
+    typename std::aligned_storage<inline_size, alignof(void *)>::type inline_storage;
+};
+
+#endif // __BUFFER_SEG_VECTOR_H__
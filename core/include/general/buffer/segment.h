@@ -56,9 +56,13 @@ public:
 
 private:
     friend class Buffer;
+    template <typename, std::size_t> friend class BufferSegVector;
+
+    // The "relocate" method moves the segment to the (uninitialized) memory at "to", as is.
+    static void relocate(Segment *to, Segment &from);
 
     // The "data_container" is the smart pointer to the actual memory.
-    std::shared_ptr<DataContainer> data_container;
+    DataContainerPtr data_container;
     // The "offset" and "len" members are used to indicate what part of the shared memory the segment refers to.
     uint offset = 0, len = 0;
 
@@ -18,6 +18,7 @@
 #include <functional>
 #include <chrono>
 #include <vector>
+#include <type_traits>
 
 #include "common.h"
 #include "singleton.h"
@@ -102,6 +103,7 @@ class Debug
 {
 public:
     class DebugStream;
+    class TraceRecord;
     enum class DebugLevel { NOISE, TRACE, DEBUG, INFO, WARNING, ERROR, ASSERTION, NONE };
     enum class DebugFlags;
 
@@ -119,6 +121,31 @@ public:
             Print(std::ostream *str, const T &obj) { obj.print(*str); }
         };
 
+        // Values that have no raw representation in a trace record are recorded the way they are printed
+        template <typename T, typename Helper = void>
+        struct Record
+        {
+            Record(TraceRecord *record, const T &obj);
+        };
+
+        template <typename T>
+        struct IsRawValue
+                :
+            std::integral_constant<
+                bool,
+                std::is_arithmetic<T>::value ||
+                std::is_pointer<T>::value ||
+                std::is_same<T, std::string>::value ||
+                (std::is_array<T>::value && std::is_same<typename std::decay<const T>::type, const char *>::value)
+            >
+        {};
+
+        template <typename T>
+        struct Record<T, typename std::enable_if<IsRawValue<T>::value>::type>
+        {
+            Record(TraceRecord *record, const T &obj);
+        };
+
     public:
         template <typename T>
         DebugStreamAggr &
@@ -127,6 +154,9 @@ public:
             for (auto &stream : streams) {
                 Print<T>(stream, obj);
             }
+            for (auto &record : trace_records) {
+                Record<T>(record, obj);
+            }
             return *this;
         }
 
@@ -140,9 +170,11 @@ public:
         }
 
         void addStream(std::ostream *stream) { streams.insert(stream); }
+        void addTraceRecord(TraceRecord *record) { trace_records.insert(record); }
 
     private:
         std::set<std::ostream *> streams;
+        std::set<TraceRecord *> trace_records;
     };
 
     class DebugAlert;
@@ -284,6 +316,59 @@ private:
     std::set<std::shared_ptr<DebugStream>> current_active_streams;
 };
 
+// The arguments of a message sent to a binary trace stream, kept as raw values rather than being formatted
+class Debug::TraceRecord
+{
+public:
+    void start(uint32_t call_site, uint64_t timestamp);
+    void finish();
+
+    void add(bool value);
+    void add(char value);
+    void add(signed char value) { add(static_cast<char>(value)); }
+    void add(unsigned char value) { add(static_cast<char>(value)); }
+    void add(double value);
+    void add(long double value) { add(static_cast<double>(value)); }
+    void add(float value) { add(static_cast<double>(value)); }
+    void add(const void *value);
+    void add(const char *value);
+    void add(const std::string &value) { addString(value.data(), value.size()); }
+    void addString(const char *value, std::size_t size);
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    add(T value) { addInteger(value); }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+    add(T value) { addUnsigned(value); }
+
+    const std::string & getData() const { return data; }
+
+private:
+    void addInteger(int64_t value);
+    void addUnsigned(uint64_t value);
+
+    std::string data;
+};
+
+template <typename T, typename Helper>
+Debug::DebugStreamAggr::Record<T, Helper>::Record(TraceRecord *record, const T &obj)
+{
+    std::ostringstream printed;
+    Print<T>(&printed, obj);
+    const std::string &value = printed.str();
+    record->addString(value.data(), value.size());
+}
+
+template <typename T>
+Debug::DebugStreamAggr::Record<T, typename std::enable_if<Debug::DebugStreamAggr::IsRawValue<T>::value>::type>::Record(
+    TraceRecord *record,
+    const T &obj)
+{
+    record->add(obj);
+}
+
 class Debug::DebugAlert
     {
         class DebugAlertImpl
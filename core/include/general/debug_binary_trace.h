@@ -0,0 +1,306 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __DEBUG_BINARY_TRACE_H__
+#define __DEBUG_BINARY_TRACE_H__
+
+// Layout of the files written by binary debug trace streams, and the decoder that turns them back into text.
+// The decoder is header only, so that cpnano_debug can use it without linking the debug infrastructure.
+//
+// The trace file starts with a FileHeader, followed by a ring of records. Each record is a RecordHeader followed by
+// the arguments of the message, each of them a one byte ArgType followed by its raw value. The call sites that the
+// records refer to are listed in a text file next to the trace file, one "id<TAB>prompt<TAB>func<TAB>file<TAB>line"
+// per line. When a process starts tracing, the trace of the previous process is kept under the suffix ".1".
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace DebugBinaryTrace
+{
+
+static const char file_magic[8] = { 'C', 'P', 'T', 'R', 'A', 'C', 'E', '1' };
+static const uint32_t file_version = 2;
+static const uint32_t record_sync = 0x52545043;
+static const uint32_t record_alignment = 8;
+static const uint32_t padding_call_site = 0;
+static const char *const call_sites_suffix = ".callsites";
+static const char *const previous_trace_suffix = ".1";
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;
+    // Bytes that were ever written to the ring, so the ring wrapped around if it is larger than the capacity
+    uint64_t written;
+    uint64_t dropped;
+};
+
+struct RecordHeader
+{
+    uint32_t sync;
+    uint32_t size;
+    uint32_t call_site;
+    // See getChecksum()
+    uint32_t checksum;
+    // Microseconds since the epoch, or 0 when the time is unknown
+    uint64_t timestamp;
+};
+
+enum class ArgType : uint8_t { INTEGER = 1, UNSIGNED, DOUBLE, BOOL, CHAR, STRING, POINTER, NULL_STRING };
+
+// FNV-1a of the whole record, taking its checksum field as 0. It tells a record apart from the remains of records
+// that were partly overwritten, or that another thread was still writing.
+inline uint32_t
+getChecksum(const char *record, uint32_t size)
+{
+    static const uint32_t checksum_begin = offsetof(RecordHeader, checksum);
+    static const uint32_t checksum_end = checksum_begin + sizeof(RecordHeader::checksum);
+
+    uint32_t checksum = 2166136261u;
+    for (uint32_t index = 0; index < size; index++) {
+        bool is_checksum_field = index >= checksum_begin && index < checksum_end;
+        checksum ^= is_checksum_field ? 0 : static_cast<uint8_t>(record[index]);
+        checksum *= 16777619u;
+    }
+    return checksum;
+}
+
+class Decoder
+{
+public:
+    bool
+    decode(const std::string &trace_file, std::ostream &out)
+    {
+        if (!loadCallSites(trace_file + call_sites_suffix)) return false;
+
+        std::ifstream trace(trace_file, std::ios::binary);
+        if (!trace.is_open()) return setError("Cannot open the trace file: " + trace_file);
+        std::string content((std::istreambuf_iterator<char>(trace)), std::istreambuf_iterator<char>());
+
+        if (content.size() < sizeof(FileHeader)) return setError("The trace file is too short");
+        FileHeader header;
+        memcpy(&header, content.data(), sizeof(header));
+        if (memcmp(header.magic, file_magic, sizeof(file_magic)) != 0) return setError("Not a binary trace file");
+        if (header.version != file_version) return setError("Unsupported trace version");
+        if (content.size() < header.header_size + header.capacity) return setError("The trace file is truncated");
+
+        const char *ring = content.data() + header.header_size;
+        uint64_t end = header.written % header.capacity;
+        if (header.written <= header.capacity) {
+            decodeRange(ring, 0, header.written, out);
+        } else {
+            // The oldest records follow the newest one, but the first of them may have been partly overwritten
+            decodeRange(ring + end, 0, header.capacity - end, out);
+            decodeRange(ring, 0, end, out);
+        }
+
+        if (header.dropped > 0) out << header.dropped << " debug messages were too large for the trace" << std::endl;
+        return true;
+    }
+
+    const std::string & getError() const { return error; }
+
+private:
+    struct CallSite
+    {
+        std::string prompt;
+        std::string func;
+        std::string file;
+        std::string line;
+    };
+
+    bool
+    setError(const std::string &_error)
+    {
+        error = _error;
+        return false;
+    }
+
+    bool
+    loadCallSites(const std::string &call_sites_file)
+    {
+        std::ifstream call_sites_stream(call_sites_file);
+        if (!call_sites_stream.is_open()) return setError("Cannot open the call sites file: " + call_sites_file);
+
+        std::string line;
+        while (std::getline(call_sites_stream, line)) {
+            std::stringstream fields(line);
+            uint32_t id;
+            CallSite call_site;
+            fields >> id;
+            fields.ignore();
+            std::getline(fields, call_site.prompt, '\t');
+            std::getline(fields, call_site.func, '\t');
+            std::getline(fields, call_site.file, '\t');
+            std::getline(fields, call_site.line);
+            call_sites[id] = call_site;
+        }
+        return true;
+    }
+
+    static bool
+    isRecord(const char *data, uint64_t pos, uint64_t size)
+    {
+        if (size - pos < sizeof(RecordHeader)) return false;
+        RecordHeader record;
+        memcpy(&record, data + pos, sizeof(record));
+        return
+            record.sync == record_sync &&
+            record.size >= sizeof(RecordHeader) &&
+            record.size % record_alignment == 0 &&
+            record.size <= size - pos &&
+            record.checksum == getChecksum(data + pos, record.size);
+    }
+
+    static uint64_t
+    findRecord(const char *data, uint64_t pos, uint64_t size)
+    {
+        while (pos < size && !isRecord(data, pos, size)) pos += record_alignment;
+        return pos;
+    }
+
+    // Records that can't be decoded are skipped, and decoding resumes from the next whole record
+    void
+    decodeRange(const char *data, uint64_t pos, uint64_t size, std::ostream &out)
+    {
+        for (pos = findRecord(data, pos, size); pos < size; pos = findRecord(data, pos, size)) {
+            RecordHeader record;
+            memcpy(&record, data + pos, sizeof(record));
+            if (record.call_site != padding_call_site) decodeRecord(record, data + pos, out);
+            pos += record.size;
+        }
+    }
+
+    void
+    decodeRecord(const RecordHeader &record, const char *data, std::ostream &out)
+    {
+        std::stringstream location;
+        auto call_site = call_sites.find(record.call_site);
+        if (call_site != call_sites.end()) {
+            location << call_site->second.func << '@' << call_site->second.file << ':' << call_site->second.line;
+        } else {
+            location << "<unknown call site " << record.call_site << ">";
+        }
+
+        out << '[';
+        if (record.timestamp != 0) out << getTimeStr(record.timestamp) << ": ";
+        out << std::left << std::setw(60) << location.str() << std::setw(0) << " | ";
+        out << (call_site != call_sites.end() ? call_site->second.prompt : "???") << "] ";
+
+        const char *arg = data + sizeof(RecordHeader);
+        const char *end = data + record.size;
+        while (arg < end && decodeArg(arg, end, out));
+        out << std::endl;
+    }
+
+    template <typename T>
+    static bool
+    readValue(const char *&arg, const char *end, T &value)
+    {
+        if (static_cast<size_t>(end - arg) < sizeof(T)) return false;
+        memcpy(&value, arg, sizeof(T));
+        arg += sizeof(T);
+        return true;
+    }
+
+    static bool
+    decodeArg(const char *&arg, const char *end, std::ostream &out)
+    {
+        uint8_t type;
+        if (!readValue(arg, end, type)) return false;
+
+        switch (static_cast<ArgType>(type)) {
+            case ArgType::INTEGER: {
+                int64_t value;
+                if (!readValue(arg, end, value)) return false;
+                out << value;
+                return true;
+            }
+            case ArgType::UNSIGNED: {
+                uint64_t value;
+                if (!readValue(arg, end, value)) return false;
+                out << value;
+                return true;
+            }
+            case ArgType::DOUBLE: {
+                double value;
+                if (!readValue(arg, end, value)) return false;
+                out << value;
+                return true;
+            }
+            case ArgType::BOOL: {
+                uint8_t value;
+                if (!readValue(arg, end, value)) return false;
+                out << (value != 0);
+                return true;
+            }
+            case ArgType::CHAR: {
+                char value;
+                if (!readValue(arg, end, value)) return false;
+                out << value;
+                return true;
+            }
+            case ArgType::STRING: {
+                uint32_t length;
+                if (!readValue(arg, end, length) || static_cast<size_t>(end - arg) < length) return false;
+                out.write(arg, length);
+                arg += length;
+                return true;
+            }
+            case ArgType::POINTER: {
+                uint64_t value;
+                if (!readValue(arg, end, value)) return false;
+                out << reinterpret_cast<const void *>(value);
+                return true;
+            }
+            case ArgType::NULL_STRING: {
+                out << "(null)";
+                return true;
+            }
+        }
+
+        // Only the padding at the end of a record is left
+        return false;
+    }
+
+    static std::string
+    getTimeStr(uint64_t timestamp)
+    {
+        time_t seconds = timestamp / 1000000;
+        struct tm gm_time;
+        gmtime_r(&seconds, &gm_time);
+        char date[24];
+        size_t date_len = strftime(date, sizeof(date), "%FT%T", &gm_time);
+        std::stringstream time_str;
+        time_str << std::string(date, date_len) << '.' << std::setw(6) << std::setfill('0') << timestamp % 1000000;
+        return time_str.str();
+    }
+
+    std::map<uint32_t, CallSite> call_sites;
+    std::string error;
+};
+
+} // namespace DebugBinaryTrace
+
+#endif // __DEBUG_BINARY_TRACE_H__
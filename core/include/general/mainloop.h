@@ -14,6 +14,7 @@
 #ifndef __MAINLOOP_H__
 #define __MAINLOOP_H__
 
+#include <atomic>
 #include <memory>
 
 #include "i_mainloop.h"
@@ -26,6 +27,9 @@
 #include "component.h"
 
 extern bool fini_signal_flag;
+// Name of the routine the mainloop currently runs (nullptr between routines), read by the sampling profiler from
+// within its signal handler.
+extern std::atomic<const char *> mainloop_running_routine;
 
 class MainloopComponent
         :
@@ -25,14 +25,14 @@ class Table<Key>::Impl::Entry
 {
     using KeyNodePtr = TableHelper::KeyNodePtr<Key>;
     using ListInterface = TableHelper::I_InternalTableList<KeyNodePtr> *;
-    using ExpirationInterface = TableHelper::I_InternalTableExpiration<Key, ExpIter> *;
+    using ExpirationInterface = TableHelper::I_InternalTableExpiration<ExpirationEntry> *;
     using ms = std::chrono::microseconds;
 public:
     Entry(ListInterface _table, ExpirationInterface _expiration, const Key &key, const KeyNodePtr &ptr, ms expire);
-    bool hasState(std::type_index index) const;
-    bool createState(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &&ptr);
-    bool delState(const std::type_index &index);
-    TableOpaqueBase * getState(const std::type_index &index);
+    bool hasState(uint slot) const;
+    bool createState(uint slot, std::unique_ptr<TableOpaqueBase> &&ptr);
+    bool delState(uint slot);
+    TableOpaqueBase * getState(uint slot);
     void addKey(const Key &key, const KeyNodePtr &ptr);
     void removeSelf();
     void setExpiration(ms expire);
@@ -49,9 +49,11 @@ public:
 private:
     ListInterface table;
     ExpirationInterface expiration;
-    std::unordered_map<Key, KeyNodePtr> keys;
-    std::unordered_map<std::type_index, std::unique_ptr<TableOpaqueBase>> opaques;
-    ExpIter expr_iter;
+    // Entries rarely have more than a couple of keys, so a vector is cheaper than a map
+    std::vector<std::pair<Key, KeyNodePtr>> keys;
+    // Indexed by the opaque's slot (see TableOpaqueSlot), unused slots are null
+    std::vector<std::unique_ptr<TableOpaqueBase>> opaques;
+    ExpirationEntry expr_entry;
 };
 
 template <typename Key>
@@ -63,64 +65,70 @@ Table<Key>::Impl::Entry::Entry(
     ms expire)
         :
     table(_table),
-    expiration(_expiration)
+    expiration(_expiration),
+    expr_entry(expire, key)
 {
     addKey(key, ptr);
-    expr_iter = expiration->addExpiration(expire, key);
+    expiration->addExpiration(&expr_entry);
 }
 
 template <typename Key>
 bool
-Table<Key>::Impl::Entry::hasState(std::type_index index) const
+Table<Key>::Impl::Entry::hasState(uint slot) const
 {
-    return opaques.count(index) != 0;
+    return slot < opaques.size() && opaques[slot] != nullptr;
 }
 
 template <typename Key>
 bool
-Table<Key>::Impl::Entry::createState(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &&ptr)
+Table<Key>::Impl::Entry::createState(uint slot, std::unique_ptr<TableOpaqueBase> &&ptr)
 {
-    if (hasState(index)) {
-        dbgError(D_TABLE) << "Failed to recreate a state of type " << index.name();
+    if (hasState(slot)) {
+        dbgError(D_TABLE) << "Failed to recreate a state of type " << TableOpaqueSlot::getTypeName(slot);
         return false;
     }
 
-    dbgTrace(D_TABLE) << "Creating a state of type " << index.name();
-    return opaques.emplace(index, std::move(ptr)).second;
+    dbgTrace(D_TABLE) << "Creating a state of type " << TableOpaqueSlot::getTypeName(slot);
+    if (slot >= opaques.size()) opaques.resize(slot + 1);
+    opaques[slot] = std::move(ptr);
+    return true;
 }
 
 template <typename Key>
 bool
-Table<Key>::Impl::Entry::delState(const std::type_index &index)
+Table<Key>::Impl::Entry::delState(uint slot)
 {
-    dbgTrace(D_TABLE) << "Deleting state of type " << index.name();
-    auto iter = opaques.find(index);
-    if (iter == opaques.end()) return false;
-    opaques.erase(iter);
+    dbgTrace(D_TABLE) << "Deleting state of type " << TableOpaqueSlot::getTypeName(slot);
+    if (!hasState(slot)) return false;
+    opaques[slot].reset();
     return true;
 }
 
 template <typename Key>
 TableOpaqueBase *
-Table<Key>::Impl::Entry::getState(const std::type_index &index)
+Table<Key>::Impl::Entry::getState(uint slot)
 {
-    auto iter = opaques.find(index);
-    if (iter == opaques.end()) return nullptr;
-    return iter->second.get();
+    return slot < opaques.size() ? opaques[slot].get() : nullptr;
 }
 
 template <typename Key>
 void
 Table<Key>::Impl::Entry::addKey(const Key &key, const KeyNodePtr &ptr)
 {
-    keys[key] = ptr;
+    for (auto &entry_key : keys) {
+        if (entry_key.first == key) {
+            entry_key.second = ptr;
+            return;
+        }
+    }
+    keys.emplace_back(key, ptr);
 }
 
 template <typename Key>
 void
 Table<Key>::Impl::Entry::removeSelf()
 {
-    expiration->removeExpiration(expr_iter);
+    expiration->removeExpiration(&expr_entry);
     for (auto &iter : keys) {
         table->removeKey(iter.second);
     }
@@ -132,15 +140,17 @@ template <typename Key>
 void
 Table<Key>::Impl::Entry::setExpiration(ms expire)
 {
-    expiration->removeExpiration(expr_iter);
-    expr_iter = expiration->addExpiration(expire, keys.begin()->first);
+    if (keys.empty()) return; // The entry was already removed from the table
+    expiration->removeExpiration(&expr_entry);
+    expr_entry.setExpiration(expire);
+    expiration->addExpiration(&expr_entry);
 }
 
 template <typename Key>
 std::chrono::microseconds
 Table<Key>::Impl::Entry::getExpiration()
 {
-    return expr_iter->getExpiration();
+    return expr_entry.getExpiration();
 }
 
 template <typename Key>
@@ -160,7 +170,7 @@ void
 Table<Key>::Impl::Entry::uponEnteringContext()
 {
     for (auto &opauqe : opaques) {
-        opauqe.second->uponEnteringContext();
+        if (opauqe) opauqe->uponEnteringContext();
     }
 }
 
@@ -169,7 +179,7 @@ void
 Table<Key>::Impl::Entry::uponLeavingContext()
 {
     for (auto &opauqe : opaques) {
-        opauqe.second->uponLeavingContext();
+        if (opauqe) opauqe->uponLeavingContext();
     }
 }
 
@@ -181,14 +191,14 @@ Table<Key>::Impl::Entry::save(Archive &ar) const
     std::vector<std::string> opaque_names;
     opaque_names.reserve(opaques.size());
     for (auto &iter : opaques) {
-        opaque_names.emplace_back(iter.second->nameOpaque());
+        if (iter) opaque_names.emplace_back(iter->nameOpaque());
     }
 
     ar(cereal::make_nvp("opaque_names", opaque_names));
 
     for (auto &iter : opaques) {
         // 0 is used currently until supporting versions
-        iter.second->saveOpaque(ar, 0);
+        if (iter) iter->saveOpaque(ar, 0);
     }
 }
 
@@ -211,7 +221,8 @@ Table<Key>::Impl::Entry::load(Archive &ar)
         // 0 is used currently until supporting versions
         opaque->loadOpaque(ar, 0);
 
-        if (!createState(typeid(*opaque), move(opaque))) {
+        auto &opaque_ref = *opaque;
+        if (!createState(TableOpaqueSlot::getByType(typeid(opaque_ref)), move(opaque))) {
             dbgError(D_TABLE) << "Failed to create the state for opaque " << iter;
         }
     }
@@ -18,6 +18,11 @@
 #error "expiration_impl.h should not be included directly"
 #endif // __TABLE_IMPL_H__
 
+#include <algorithm>
+#include <vector>
+
+// An entry's place in the expiration timer wheel. It is held inside the table entry itself, so that adding,
+// moving and removing an expiration never allocates.
 template <typename Key>
 class Table<Key>::Impl::ExpirationEntry
 {
@@ -26,10 +31,17 @@ public:
     bool isBeforeTime(std::chrono::microseconds other_expire) const;
     const Key & getKey() const;
     std::chrono::microseconds getExpiration() const;
+    void setExpiration(std::chrono::microseconds _expire);
 
 private:
+    friend class Table<Key>::Impl::ExpList;
+
     std::chrono::microseconds expire;
     Key key;
+    ExpirationEntry *prev = nullptr;
+    ExpirationEntry *next = nullptr;
+    uint bucket = 0;
+    bool is_listed = false;
 };
 
 template <typename Key>
@@ -61,59 +73,95 @@ Table<Key>::Impl::ExpirationEntry::getExpiration() const
     return expire;
 }
 
+template <typename Key>
+void
+Table<Key>::Impl::ExpirationEntry::setExpiration(std::chrono::microseconds _expire)
+{
+    expire = _expire;
+}
+
+// A hashed timer wheel - every bucket holds the entries that expire during one tick (modulo the number of
+// buckets). Adding and removing an expiration don't depend on the number of entries, and expiring only visits
+// the buckets of the ticks that passed since the previous time.
 template <typename Key>
 class Table<Key>::Impl::ExpList
         :
-    public TableHelper::I_InternalTableExpiration<Key, ExpIter>
+    public TableHelper::I_InternalTableExpiration<ExpirationEntry>
 {
 public:
-    ExpIter addExpiration(std::chrono::microseconds expire, const Key &key) override;
-    void removeExpiration(const ExpIter &iter) override;
-    bool shouldExpire(std::chrono::microseconds expire) const;
-    const Key & getEarliest() const;
+    using ExpiredKeys = std::vector<std::pair<Key, std::chrono::microseconds>>;
+
+    ExpList() : buckets(num_of_buckets, nullptr) {}
+
+    void addExpiration(ExpirationEntry *entry) override;
+    void removeExpiration(ExpirationEntry *entry) override;
+    // Returns the keys of the entries that expired by `curr_time`, along with their expiration time
+    ExpiredKeys getExpired(std::chrono::microseconds curr_time);
+
+    static constexpr std::chrono::milliseconds tick_size{100};
 
 private:
-    std::list<ExpirationEntry> list;
+    static const uint num_of_buckets = 4096;
+
+    static uint64_t getTick(std::chrono::microseconds time) { return time / tick_size; }
+
+    std::vector<ExpirationEntry *> buckets;
+    // Ticks before this one were already visited, so expirations of the past are placed at this tick
+    uint64_t next_tick = 0;
 };
 
 template <typename Key>
-typename Table<Key>::Impl::ExpIter
-Table<Key>::Impl::ExpList::addExpiration(std::chrono::microseconds expire, const Key &key)
+void
+Table<Key>::Impl::ExpList::addExpiration(ExpirationEntry *entry)
 {
-    // The list is ordered from the highest value (in the far future) to the lowest (in the near future).
-    // So we scan the list to enter before the first vlaue that is smaller than us (typically, the first one).
-    for (auto iter = list.begin(); iter != list.end(); iter++) {
-        if (iter->isBeforeTime(expire)) {
-            return list.emplace(iter, expire, key);
-        }
-    }
-    // There was no value that is closer to the current time, so it should be placed in at the end of the list.
-    return list.emplace(list.end(), expire, key);
+    dbgAssert(!entry->is_listed)
+        << AlertInfo(AlertTeam::CORE, "table")
+        << "Trying to add an expiration that is already in the timer wheel";
+
+    entry->bucket = std::max(getTick(entry->expire), next_tick) % num_of_buckets;
+    entry->prev = nullptr;
+    entry->next = buckets[entry->bucket];
+    if (entry->next != nullptr) entry->next->prev = entry;
+    buckets[entry->bucket] = entry;
+    entry->is_listed = true;
 }
 
 template <typename Key>
 void
-Table<Key>::Impl::ExpList::removeExpiration(const ExpIter &iter)
+Table<Key>::Impl::ExpList::removeExpiration(ExpirationEntry *entry)
 {
-    list.erase(iter);
-}
+    if (!entry->is_listed) return;
 
-template <typename Key>
-bool
-Table<Key>::Impl::ExpList::shouldExpire(std::chrono::microseconds expire) const
-{
-    if (list.empty()) return false;
-    return list.back().isBeforeTime(expire);
+    if (entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+    } else {
+        buckets[entry->bucket] = entry->next;
+    }
+    if (entry->next != nullptr) entry->next->prev = entry->prev;
+
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    entry->is_listed = false;
 }
 
 template <typename Key>
-const Key &
-Table<Key>::Impl::ExpList::getEarliest() const
+typename Table<Key>::Impl::ExpList::ExpiredKeys
+Table<Key>::Impl::ExpList::getExpired(std::chrono::microseconds curr_time)
 {
-    dbgAssert(!list.empty())
-        << AlertInfo(AlertTeam::CORE, "table")
-        << "Cannot access the earliest member of an empty list";
-    return list.back().getKey();
+    uint64_t curr_tick = std::max(getTick(curr_time), next_tick);
+    // After a long pause, every bucket is visited once rather than once per tick that passed
+    uint64_t ticks_to_visit = std::min<uint64_t>(curr_tick - next_tick + 1, num_of_buckets);
+
+    ExpiredKeys expired;
+    for (uint64_t tick = curr_tick + 1 - ticks_to_visit; tick <= curr_tick; tick++) {
+        for (auto entry = buckets[tick % num_of_buckets]; entry != nullptr; entry = entry->next) {
+            if (entry->isBeforeTime(curr_time)) expired.emplace_back(entry->key, entry->expire);
+        }
+    }
+
+    // The current tick isn't over, so it will be visited again next time
+    next_tick = curr_tick;
+    return expired;
 }
 
 #endif // __EXPIRATION_IMPL_H__
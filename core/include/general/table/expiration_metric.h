@@ -0,0 +1,65 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __EXPIRATION_METRIC_H__
+#define __EXPIRATION_METRIC_H__
+
+#ifndef __TABLE_IMPL_H__
+#error "expiration_metric.h should not be included directly"
+#endif // __TABLE_IMPL_H__
+
+#include <chrono>
+
+#include "generic_metric.h"
+
+class TableExpirationEvent : public Event<TableExpirationEvent>
+{
+public:
+    TableExpirationEvent(uint _expired_entries, std::chrono::microseconds _max_latency)
+            :
+        expired_entries(_expired_entries),
+        max_latency(_max_latency)
+    {}
+
+    uint getExpiredEntries() const { return expired_entries; }
+    // How long after its expiration time the most delayed entry was removed
+    std::chrono::microseconds getMaxLatency() const { return max_latency; }
+
+private:
+    uint expired_entries;
+    std::chrono::microseconds max_latency;
+};
+
+class TableExpirationMetric : public GenericMetric, public Listener<TableExpirationEvent>
+{
+public:
+    void
+    upon(const TableExpirationEvent &event) override
+    {
+        uint64_t latency = std::chrono::duration_cast<std::chrono::milliseconds>(event.getMaxLatency()).count();
+        expired_entries.report(event.getExpiredEntries());
+        max_expired_entries_per_tick.report(event.getExpiredEntries());
+        avg_expired_entries_per_tick.report(event.getExpiredEntries());
+        max_expiration_latency.report(latency);
+        avg_expiration_latency.report(latency);
+    }
+
+private:
+    MetricCalculations::Counter expired_entries{this, "tableExpiredEntriesSum"};
+    MetricCalculations::Max<uint64_t> max_expired_entries_per_tick{this, "tableMaxExpiredEntriesPerTickSample", 0};
+    MetricCalculations::Average<double> avg_expired_entries_per_tick{this, "tableAvgExpiredEntriesPerTickSample"};
+    MetricCalculations::Max<uint64_t> max_expiration_latency{this, "tableMaxExpirationLatencyMilliSecondsSample", 0};
+    MetricCalculations::Average<double> avg_expiration_latency{this, "tableAvgExpirationLatencyMilliSecondsSample"};
+};
+
+#endif // __EXPIRATION_METRIC_H__
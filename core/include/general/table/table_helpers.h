@@ -39,12 +39,12 @@ protected:
     ~I_InternalTableList() {}
 };
 
-template <typename Key, typename ExpIter>
+template <typename ExpEntry>
 class I_InternalTableExpiration
 {
 public:
-    virtual ExpIter addExpiration(std::chrono::microseconds expire, const Key &key) = 0;
-    virtual void removeExpiration(const ExpIter &iter) = 0;
+    virtual void addExpiration(ExpEntry *entry) = 0;
+    virtual void removeExpiration(ExpEntry *entry) = 0;
 
 protected:
     ~I_InternalTableExpiration() {}
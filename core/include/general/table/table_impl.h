@@ -29,6 +29,7 @@
 #include "table/table_helpers.h"
 #include "table/table_list.h"
 #include "table/opaque_repo.h"
+#include "table/expiration_metric.h"
 #include "config.h"
 #include "key_wrapper.h"
 
@@ -43,7 +44,6 @@ class Table<Key>::Impl
     public Singleton::Provide<I_TableSpecific<Key>>::template From<Table<Key>>
 {
     class ExpirationEntry;
-    using ExpIter = typename std::list<ExpirationEntry>::iterator;
     class ExpList;
 
     class Entry;
@@ -58,10 +58,10 @@ public:
     void removeKey(const TableHelper::KeyNodePtr<Key> &key) override;
 
     // I_Table protected methods
-    bool              hasState   (const std::type_index &index) const                                   override;
-    bool              createState(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &&ptr) override;
-    bool              deleteState(const std::type_index &index)                                         override;
-    TableOpaqueBase * getState   (const std::type_index &index)                                         override;
+    bool              hasState   (uint slot) const                                   override;
+    bool              createState(uint slot, std::unique_ptr<TableOpaqueBase> &&ptr) override;
+    bool              deleteState(uint slot)                                         override;
+    TableOpaqueBase * getState   (uint slot)                                         override;
 
     // I_Table public methods
     void              setExpiration(std::chrono::milliseconds expire)       override;
@@ -91,13 +91,14 @@ private:
     ExpList                   expiration;
     TableHelper::KeyList<Key> list;
     Context                   ctx;
+    TableExpirationMetric     expiration_metric;
     // Interfaces
     I_TimeGet     *timer    = nullptr;
     I_Environment *env      = nullptr;
 };
 
-#include "table/entry_impl.h"
 #include "table/expiration_impl.h"
+#include "table/entry_impl.h"
 
 template <typename Key>
 void
@@ -108,19 +109,29 @@ Table<Key>::Impl::init()
     auto mainloop  = Singleton::Consume<I_MainLoop>::by<Table<Key>>();
     mainloop->addRecurringRoutine(
         I_MainLoop::RoutineType::Timer,
-        std::chrono::milliseconds(100),
+        ExpList::tick_size,
         [&] () { expireEntries(); },
         "Delete expired table entries"
     );
+    expiration_metric.init(
+        "Table Expiration",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        std::chrono::minutes(10),
+        true
+    );
+    expiration_metric.registerListener();
 }
 
 template <typename Key>
 void
 Table<Key>::Impl::fini()
 {
-    while (count() > 0) {
-        deleteEntry(expiration.getEarliest());
+    while (!entries.empty()) {
+        auto ent = entries.begin()->second;
+        ent->removeSelf();
     }
+    expiration_metric.unregisterListener();
 
     env = nullptr;
     timer = nullptr;
@@ -147,43 +158,43 @@ Table<Key>::Impl::removeKey(const TableHelper::KeyNodePtr<Key> &key)
 
 template <typename Key>
 bool
-Table<Key>::Impl::hasState(const std::type_index &index) const
+Table<Key>::Impl::hasState(uint slot) const
 {
-    dbgTrace(D_TABLE) << "Checking if there is a state of type " << index.name();
+    dbgTrace(D_TABLE) << "Checking if there is a state of type " << TableOpaqueSlot::getTypeName(slot);
     auto entry = getCurrEntry();
     if (!entry) return false;
-    return entry->hasState(index);
+    return entry->hasState(slot);
 }
 
 template <typename Key>
 bool
-Table<Key>::Impl::createState(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &&ptr)
+Table<Key>::Impl::createState(uint slot, std::unique_ptr<TableOpaqueBase> &&ptr)
 {
     auto ent = getCurrEntry();
     if (ent == nullptr) {
         dbgError(D_TABLE) << "Trying to create a state without an entry";
         return false;
     }
-    return ent->createState(index, std::move(ptr));
+    return ent->createState(slot, std::move(ptr));
 }
 
 template <typename Key>
 bool
-Table<Key>::Impl::deleteState(const std::type_index &index)
+Table<Key>::Impl::deleteState(uint slot)
 {
     auto ent = getCurrEntry();
-    if (ent) return ent->delState(index);
+    if (ent) return ent->delState(slot);
     return false;
 }
 
 template <typename Key>
 TableOpaqueBase *
-Table<Key>::Impl::getState(const std::type_index &index)
+Table<Key>::Impl::getState(uint slot)
 {
     auto ent = getCurrEntry();
-    dbgTrace(D_TABLE) << "Getting a state of type " << index.name();
+    dbgTrace(D_TABLE) << "Getting a state of type " << TableOpaqueSlot::getTypeName(slot);
     if (!ent) return nullptr;
-    return ent->getState(index);
+    return ent->getState(slot);
 }
 
 template <typename Key>
@@ -300,12 +311,23 @@ void
 Table<Key>::Impl::expireEntries()
 {
     auto curr_time = timer->getMonotonicTime();
-    while (expiration.shouldExpire(curr_time)) {
-        auto key = expiration.getEarliest();
+    auto expired = expiration.getExpired(curr_time);
+    if (expired.empty()) return;
+
+    uint num_of_expired = 0;
+    std::chrono::microseconds max_latency(0);
+    for (auto &expired_key : expired) {
+        // Deleting one entry may have already deleted another one, or given it a new expiration
+        auto entry = entries.find(expired_key.first);
+        if (entry == entries.end() || entry->second->getExpiration() > curr_time) continue;
+        num_of_expired++;
+        max_latency = std::max(max_latency, curr_time - expired_key.second);
         ScopedContext ctx;
-        ctx.registerValue(primary_key, key);
-        deleteEntry(key);
+        ctx.registerValue(primary_key, expired_key.first);
+        deleteEntry(expired_key.first);
     }
+
+    TableExpirationEvent(num_of_expired, max_latency).notify();
 }
 
 template <typename Key>
@@ -35,9 +35,23 @@ public:
     Maybe<T, Context::Error>
     get(const std::string &name) const
     {
-        auto active_contexts_vec = getActiveContexts().first;
-        for (auto iter = active_contexts_vec.crbegin(); iter != active_contexts_vec.crend(); iter++) {
-            auto value = (*iter)->get<T>(name);
+        uint id = Context::findKeyId(name, typeid(T));
+        if (id == Context::unknown_key_id) return genError(Context::Error::NO_VALUE);
+        return get(EnvKey<T>(id));
+    }
+
+    template <typename T>
+    Maybe<T, Context::Error>
+    get(const EnvKey<T> &key) const
+    {
+        // Indexing (rather than iterating) keeps this safe if a value's getter activates or deactivates contexts
+        const auto &active_contexts_vec = getActiveContexts().first;
+        for (auto index = active_contexts_vec.size(); index > 0; index--) {
+            if (index > active_contexts_vec.size()) {
+                index = active_contexts_vec.size();
+                if (index == 0) break;
+            }
+            auto value = active_contexts_vec[index - 1]->get(key);
             if (value.ok() || (value.getErr() != Context::Error::NO_VALUE)) return value;
         }
         return genError(Context::Error::NO_VALUE);
@@ -98,6 +112,30 @@ public:
     // Type-erased key access for Table
     virtual KeyWrapper & getKeyWrapper() = 0;
 
+    // The revisions of the active contexts identify the values they hold (see Context::getRevision()), unless one of
+    // them holds values that are computed by functions, in which case there are no revisions to rely on
+    bool
+    getContextRevisions(std::vector<uint64_t> &revisions) const
+    {
+        revisions.clear();
+        for (auto ctx : getActiveContexts().first) {
+            if (ctx->hasFunctionValues()) return false;
+            revisions.push_back(ctx->getRevision());
+        }
+        return true;
+    }
+
+    bool
+    areContextRevisionsActive(const std::vector<uint64_t> &revisions) const
+    {
+        const auto &active_contexts_vec = getActiveContexts().first;
+        if (revisions.size() != active_contexts_vec.size()) return false;
+        for (uint index = 0; index < revisions.size(); index++) {
+            if (revisions[index] != active_contexts_vec[index]->getRevision()) return false;
+        }
+        return true;
+    }
+
 protected:
     ~I_Environment() {}
     virtual const ActiveContexts & getActiveContexts() const = 0;
@@ -15,6 +15,7 @@
 #define __I_SOCKET_IS_H__
 
 #include <string.h>
+#include <sys/uio.h>
 #include <vector>
 
 #include "maybe_res.h"
@@ -38,6 +39,9 @@ public:
     virtual void closeSocket(socketFd &socket) = 0;
     virtual bool writeData(socketFd socket, const std::vector<char> &data) = 0;
     virtual bool writeDataAsync(socketFd socket, const std::vector<char> &data) = 0;
+    // Datagram sockets send every message as a datagram of its own, stream sockets write the messages one after
+    // the other. Returns how many of the messages (from the first one) were written in full.
+    virtual uint writeMessages(socketFd socket, const std::vector<struct iovec> &messages) = 0;
     virtual Maybe<std::vector<char>> receiveData(socketFd socket, uint data_size, bool is_blocking = true) = 0;
     virtual bool isDataAvailable(socketFd socket) = 0;
     virtual bool isError(socketFd socket) = 0;
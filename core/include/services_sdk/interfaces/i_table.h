@@ -16,9 +16,8 @@
 
 #include <chrono>
 #include <string>
-#include <typeindex>
-
 #include "table/opaque_basic.h"
+#include "table/opaque_slot.h"
 #include "table_iter.h"
 #include "maybe_res.h"
 #include "cereal/archives/binary.hpp"
@@ -53,10 +52,10 @@ public:
 protected:
     ~I_Table() {}
 
-    virtual bool              hasState   (const std::type_index &index) const = 0;
-    virtual bool              createState(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &&ptr) = 0;
-    virtual bool              deleteState(const std::type_index &index) = 0;
-    virtual TableOpaqueBase * getState   (const std::type_index &index) = 0;
+    virtual bool              hasState   (uint slot) const = 0;
+    virtual bool              createState(uint slot, std::unique_ptr<TableOpaqueBase> &&ptr) = 0;
+    virtual bool              deleteState(uint slot) = 0;
+    virtual TableOpaqueBase * getState   (uint slot) = 0;
 };
 
 template <typename Key>
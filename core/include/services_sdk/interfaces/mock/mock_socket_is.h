@@ -17,6 +17,7 @@ public:
     MOCK_METHOD1(isError, bool (socketFd));
     MOCK_METHOD2(writeData, bool (socketFd, const std::vector<char> &));
     MOCK_METHOD2(writeDataAsync, bool (socketFd, const std::vector<char> &));
+    MOCK_METHOD2(writeMessages, uint (socketFd, const std::vector<struct iovec> &));
     MOCK_METHOD3(receiveData, Maybe<std::vector<char>> (socketFd, uint, bool is_blocking));
 };
 
@@ -17,15 +17,15 @@ public:
     MOCK_CONST_METHOD0(end, TableIter());
 
     bool
-    createState(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &&ptr)
+    createState(uint slot, std::unique_ptr<TableOpaqueBase> &&ptr)
     {
-        return createStateRValueRemoved(index, ptr);
+        return createStateRValueRemoved(slot, ptr);
     }
 
-    MOCK_CONST_METHOD1(hasState, bool(const std::type_index &index));
-    MOCK_METHOD2(createStateRValueRemoved, bool(const std::type_index &index, std::unique_ptr<TableOpaqueBase> &ptr));
-    MOCK_METHOD1(deleteState, bool(const std::type_index &index));
-    MOCK_METHOD1(getState, TableOpaqueBase *(const std::type_index &index));
+    MOCK_CONST_METHOD1(hasState, bool(uint slot));
+    MOCK_METHOD2(createStateRValueRemoved, bool(uint slot, std::unique_ptr<TableOpaqueBase> &ptr));
+    MOCK_METHOD1(deleteState, bool(uint slot));
+    MOCK_METHOD1(getState, TableOpaqueBase *(uint slot));
 };
 
 #endif // __MOCK_TABLE_H__
@@ -188,6 +188,8 @@ ConfigCacheEntry<ConfigurationType>* getCacheArray() {
 struct CacheStats {
     static std::atomic<uint64_t> hits;
     static std::atomic<uint64_t> misses;
+    static std::atomic<uint64_t> rulebase_memo_hits;
+    static std::atomic<uint64_t> rulebase_memo_misses;
     static bool tracking_enabled;
 
     static void recordHit() {
@@ -198,12 +200,24 @@ struct CacheStats {
         if (tracking_enabled) misses.fetch_add(1, std::memory_order_relaxed);
     }
 
+    static void recordRulebaseMemoHit() {
+        if (tracking_enabled) rulebase_memo_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void recordRulebaseMemoMiss() {
+        if (tracking_enabled) rulebase_memo_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
     static uint64_t getHits() { return hits.load(std::memory_order_relaxed); }
     static uint64_t getMisses() { return misses.load(std::memory_order_relaxed); }
+    static uint64_t getRulebaseMemoHits() { return rulebase_memo_hits.load(std::memory_order_relaxed); }
+    static uint64_t getRulebaseMemoMisses() { return rulebase_memo_misses.load(std::memory_order_relaxed); }
 
     static void reset() {
         hits.store(0, std::memory_order_relaxed);
         misses.store(0, std::memory_order_relaxed);
+        rulebase_memo_hits.store(0, std::memory_order_relaxed);
+        rulebase_memo_misses.store(0, std::memory_order_relaxed);
     }
 
     static void enableTracking() { tracking_enabled = true; }
@@ -113,6 +113,8 @@ public:
     // Cache statistics access functions
     virtual uint64_t getCacheHits() const = 0;
     virtual uint64_t getCacheMisses() const = 0;
+    virtual uint64_t getRulebaseMemoHits() const = 0;
+    virtual uint64_t getRulebaseMemoMisses() const = 0;
     virtual void resetCacheStats() = 0;
     virtual void enableCacheTracking() = 0;
     virtual void disableCacheTracking() = 0;
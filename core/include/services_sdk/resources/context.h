@@ -18,6 +18,7 @@
 #include <typeindex>
 #include <string>
 #include <map>
+#include <vector>
 
 #include "common.h"
 #include "singleton.h"
@@ -27,6 +28,7 @@ USE_DEBUG_FLAG(D_ENVIRONMENT);
 
 class I_Environment;
 class KeyWrapper;
+template <typename T> class EnvKey;
 
 namespace EnvKeyAttr
 {
@@ -113,15 +115,71 @@ public:
     template <typename T>
     Return<T> get(MetaDataType name) const;
 
+    template <typename T>
+    Return<T> get(const EnvKey<T> &key) const;
+
     std::map<std::string, std::string> getAllStrings(const EnvKeyAttr::ParamAttr &param) const;
     std::map<std::string, uint64_t> getAllUints(const EnvKeyAttr::ParamAttr &param) const;
     std::map<std::string, bool> getAllBools(const EnvKeyAttr::ParamAttr &param) const;
 
     static const std::string convertToString(MetaDataType type);
 
+    // Every (name, type) pair is interned into a dense id the first time it is registered,
+    // so that lookups compare ids rather than strings.
+    static constexpr uint unknown_key_id = static_cast<uint>(-1);
+    static uint getKeyId(const std::string &name, const std::type_index &type);
+    static uint findKeyId(const std::string &name, const std::type_index &type);
+    static const std::string & getKeyName(uint id);
+
+    // Changes whenever a value is registered or unregistered, and is never shared by two contexts, so it identifies
+    // the values that the context holds
+    uint64_t getRevision() const { return revision; }
+    // Values that are computed by functions may change without a new revision
+    bool hasFunctionValues() const { return !function_key_ids.empty(); }
+
 private:
-    std::map<Key, std::unique_ptr<AbstractValue>> values;
-    std::map<Key, std::unique_ptr<AbstractValue>> quick_access_values; // Common values for all contexts
+    static uint64_t getNextRevision();
+
+    template <typename T, typename ... Attr>
+    void registerValueFunc(
+        bool is_quick_access,
+        bool is_function,
+        const std::string &name,
+        std::function<Return<T>()> &&func,
+        Attr ... attr
+    );
+    void setFunctionKey(uint id, bool is_function);
+
+    // Kept sorted by the key id
+    using Values = std::vector<std::pair<Key, std::unique_ptr<AbstractValue>>>;
+
+    static const AbstractValue * findValue(const Values &vals, uint id);
+    static void setValue(Values &vals, Key &&key, std::unique_ptr<AbstractValue> &&value);
+    static void eraseValue(Values &vals, uint id);
+
+    Values values;
+    Values quick_access_values; // Common values for all contexts
+    uint64_t revision = getNextRevision();
+    std::vector<uint> function_key_ids;
+};
+
+// A context key that is interned once, typically into a static, for use in hot lookups.
+template <typename T>
+class EnvKey
+{
+public:
+    explicit EnvKey(const std::string &name) : id(Context::getKeyId(name, typeid(T))) {}
+
+    uint getId() const { return id; }
+    const std::string & getName() const { return Context::getKeyName(id); }
+
+private:
+    friend class Context;
+    friend class I_Environment;
+
+    explicit EnvKey(uint _id) : id(_id) {}
+
+    uint id;
 };
 
 class ScopedContext;
@@ -15,6 +15,7 @@
 #error "context_impl.h should not be included directly"
 #endif // __CONTEXT_H__
 
+#include <algorithm>
 #include <limits>
 #include <sstream>
 
@@ -93,30 +94,74 @@ private:
     std::function<Return<T>()> value_getter;
 };
 
-class Context::Key : public std::pair<std::string, std::type_index>
+class Context::Key
 {
 public:
     Key(const std::string &name, const std::type_index &type) : Key(name, type, EnvKeyAttr::ParamAttr()) {}
 
     Key(const std::string &name, const std::type_index &type, const EnvKeyAttr::ParamAttr &_params)
             :
-        std::pair<std::string, std::type_index>(name, type),
+        id(getKeyId(name, type)),
         params(_params)
     {
     }
 
+    uint getId() const { return id; }
+    const std::string & getName() const { return getKeyName(id); }
     bool doesMatch(const EnvKeyAttr::ParamAttr &param) const { return params.doesMatch(param); }
 
 private:
+    uint id;
     EnvKeyAttr::ParamAttr params;
 };
 
+inline const Context::AbstractValue *
+Context::findValue(const Values &vals, uint id)
+{
+    auto iter = std::lower_bound(
+        vals.begin(),
+        vals.end(),
+        id,
+        [] (const Values::value_type &entry, uint key_id) { return entry.first.getId() < key_id; }
+    );
+    if (iter == vals.end() || iter->first.getId() != id) return nullptr;
+    return iter->second.get();
+}
+
+inline void
+Context::setValue(Values &vals, Key &&key, std::unique_ptr<AbstractValue> &&value)
+{
+    auto iter = std::lower_bound(
+        vals.begin(),
+        vals.end(),
+        key.getId(),
+        [] (const Values::value_type &entry, uint key_id) { return entry.first.getId() < key_id; }
+    );
+    if (iter != vals.end() && iter->first.getId() == key.getId()) {
+        iter->second = std::move(value);
+        return;
+    }
+    vals.emplace(iter, std::move(key), std::move(value));
+}
+
+inline void
+Context::eraseValue(Values &vals, uint id)
+{
+    auto iter = std::lower_bound(
+        vals.begin(),
+        vals.end(),
+        id,
+        [] (const Values::value_type &entry, uint key_id) { return entry.first.getId() < key_id; }
+    );
+    if (iter != vals.end() && iter->first.getId() == id) vals.erase(iter);
+}
+
 template <typename T, typename ... Attr>
 void
 Context::registerValue(const std::string &name, const T &value, Attr ... attr)
 {
     std::function<Return<T>()> new_func = [value] () { return Return<T>(value); };
-    registerFunc(name, std::move(new_func), attr ...);
+    registerValueFunc(false, false, name, std::move(new_func), attr ...);
 }
 
 template <typename T, typename ... Attr>
@@ -124,7 +169,7 @@ void
 Context::registerQuickAccessValue(const std::string &name, const T &value, Attr ... attr)
 {
     std::function<Return<T>()> new_func = [value] () { return Return<T>(value); };
-    registerQuickAccessFunc(name, std::move(new_func), attr ...);
+    registerValueFunc(true, false, name, std::move(new_func), attr ...);
 }
 
 template <typename ... Params>
@@ -161,18 +206,35 @@ template <typename T, typename ... Attr>
 void
 Context::registerFunc(const std::string &name, std::function<Return<T>()> &&func, Attr ... attr)
 {
-    dbgTrace(D_ENVIRONMENT) << "Registering key : " << name;
-    Key key(name, typeid(T), EnvKeyAttr::ParamAttr(attr ...));
-    values[key] = std::make_unique<Value<T>>(std::move(func));
+    registerValueFunc(false, true, name, std::move(func), attr ...);
 }
 
 template <typename T, typename ... Attr>
 void
 Context::registerQuickAccessFunc(const std::string &name, std::function<Return<T>()> &&func, Attr ... attr)
+{
+    registerValueFunc(true, true, name, std::move(func), attr ...);
+}
+
+template <typename T, typename ... Attr>
+void
+Context::registerValueFunc(
+    bool is_quick_access,
+    bool is_function,
+    const std::string &name,
+    std::function<Return<T>()> &&func,
+    Attr ... attr)
 {
     dbgTrace(D_ENVIRONMENT) << "Registering key : " << name;
+    revision = getNextRevision();
     Key key(name, typeid(T), EnvKeyAttr::ParamAttr(attr ...));
-    quick_access_values[key] = std::make_unique<Value<T>>(std::move(func));
+    // A key stays marked as a function until it is unregistered, even if a value replaces the function
+    if (is_function) setFunctionKey(key.getId(), true);
+    setValue(
+        is_quick_access ? quick_access_values : values,
+        std::move(key),
+        std::make_unique<Value<T>>(std::move(func))
+    );
 }
 
 template <typename T>
@@ -180,9 +242,12 @@ void
 Context::unregisterKey(const std::string &name)
 {
     dbgTrace(D_ENVIRONMENT) << "Unregistering key : " << name;
-    Key key(name, typeid(T));
-    values.erase(key);
-    quick_access_values.erase(key);
+    uint id = findKeyId(name, typeid(T));
+    if (id == unknown_key_id) return;
+    revision = getNextRevision();
+    setFunctionKey(id, false);
+    eraseValue(values, id);
+    eraseValue(quick_access_values, id);
 }
 
 template <typename T>
@@ -196,15 +261,21 @@ template <typename T>
 Context::Return<T>
 Context::get(const std::string &name) const
 {
-    Key key(name, typeid(T));
-    auto iter = quick_access_values.find(key);
-    if (iter == quick_access_values.end()) {
-        // If not found in quick access, search in the main values map
-        iter = values.find(key);
-        if (iter == values.end()) return genError(Error::NO_VALUE);
-    }
-    Value<T> *val = dynamic_cast<Value<T> *>(iter->second.get());
-    return val->get();
+    uint id = findKeyId(name, typeid(T));
+    if (id == unknown_key_id) return genError(Error::NO_VALUE);
+    return get(EnvKey<T>(id));
+}
+
+template <typename T>
+Context::Return<T>
+Context::get(const EnvKey<T> &key) const
+{
+    auto val = findValue(quick_access_values, key.getId());
+    // If not found in quick access, search in the main values
+    if (val == nullptr) val = findValue(values, key.getId());
+    if (val == nullptr) return genError(Error::NO_VALUE);
+    // The key id is unique per type, so the value is known to be of type T
+    return static_cast<const Value<T> *>(val)->get();
 }
 
 template <typename T>
@@ -34,6 +34,21 @@ public:
         return MyListener::performNamedQuery(dynamic_cast<const EventType *>(this));
     }
 
+    // Like `performNamedQuery`, but fills a vector owned by the caller (so its memory can be reused between events)
+    // and skips listeners that are inactive for the current asset
+    void
+    dispatch(std::vector<ListenerResponse<ReturnType>> &responses) const
+    {
+        MyListener::dispatch(dynamic_cast<const EventType *>(this), responses);
+    }
+
+    template <typename FinalResponseCheck>
+    void
+    dispatch(std::vector<ListenerResponse<ReturnType>> &responses, const FinalResponseCheck &is_final) const
+    {
+        MyListener::dispatch(dynamic_cast<const EventType *>(this), responses, is_final);
+    }
+
 protected:
     virtual ~EventImpl() {} // Makes Event polimorphic, so dynamic_cast will work
 };
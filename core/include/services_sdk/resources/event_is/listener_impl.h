@@ -15,10 +15,13 @@
 #error "listener_impl.h should only be included from listener.h"
 #endif // __LISTENER_H__
 
+#include <algorithm>
+#include <chrono>
 #include <set>
 #include <map>
 #include <vector>
 #include <string>
+#include <utility>
 
 class BaseListener
 {
@@ -39,6 +42,31 @@ private:
     std::set<ActivationFunction> deactivate;
 };
 
+// The response of a single listener to a dispatched event. The name of the listener is resolved once, when the
+// dispatch table of the event is built, so it is handed out by reference rather than copied for every event.
+// The response also holds the time it took the listener to respond, so the cost of every listener can be tracked.
+template <typename ReturnType>
+class ListenerResponse
+{
+public:
+    ListenerResponse(const std::string &_name, ReturnType &&_response, std::chrono::microseconds _respond_time)
+            :
+        name(&_name),
+        response(std::move(_response)),
+        respond_time(_respond_time)
+    {
+    }
+
+    const std::string & getListenerName() const { return *name; }
+    const ReturnType & getResponse() const { return response; }
+    std::chrono::microseconds getRespondTime() const { return respond_time; }
+
+private:
+    const std::string *name;
+    ReturnType response;
+    std::chrono::microseconds respond_time;
+};
+
 template <typename EventType, typename ReturnType>
 class ListenerImpl : public ListenerImpl<EventType, void>
 {
@@ -48,6 +76,11 @@ public:
 
     virtual void upon(const EventType &event) { query(&event); }
 
+    // Listeners that have nothing to say about the current asset are skipped by `dispatch`
+    virtual bool isActiveForAsset() const { return true; }
+    // `dispatch` goes over the listeners from the lowest priority value to the highest
+    virtual uint getDispatchPriority() const { return 0; }
+
     static std::vector<typename EventType::EventReturnType>
     query(const EventType *event)
     {
@@ -68,6 +101,65 @@ public:
         }
         return responses;
     }
+
+    static void
+    dispatch(const EventType *event, std::vector<ListenerResponse<ReturnType>> &responses)
+    {
+        dispatch(event, responses, [] (const ReturnType &) { return false; });
+    }
+
+    // Stops going over the listeners once `is_final` holds for a response
+    template <typename FinalResponseCheck>
+    static void
+    dispatch(
+        const EventType *event,
+        std::vector<ListenerResponse<ReturnType>> &responses,
+        const FinalResponseCheck &is_final)
+    {
+        responses.clear();
+        for (const auto &entry : getDispatchTable()) {
+            if (!entry.first->isActiveForAsset()) continue;
+            auto start = std::chrono::steady_clock::now();
+            auto response = entry.first->respond(*event);
+            auto respond_time = std::chrono::steady_clock::now() - start;
+            responses.emplace_back(
+                *entry.second,
+                std::move(response),
+                std::chrono::duration_cast<std::chrono::microseconds>(respond_time)
+            );
+            if (is_final(responses.back().getResponse())) return;
+        }
+    }
+
+private:
+    using DispatchTable = std::vector<std::pair<ListenerImpl *, const std::string *>>;
+
+    static const DispatchTable &
+    getDispatchTable()
+    {
+        static DispatchTable table;
+        static uint table_revision = static_cast<uint>(-1);
+        // Names are kept in a set so the responses of earlier dispatches can still refer to them after a rebuild
+        static std::set<std::string> names;
+
+        if (table_revision == ListenerImpl<EventType, void>::revision) return table;
+
+        table.clear();
+        for (auto &listener : ListenerImpl<EventType, void>::listeners) {
+            ListenerImpl *listener_impl = dynamic_cast<ListenerImpl *>(listener);
+            table.emplace_back(listener_impl, &*names.insert(listener_impl->getListenerName()).first);
+        }
+        std::stable_sort(
+            table.begin(),
+            table.end(),
+            [] (const typename DispatchTable::value_type &first, const typename DispatchTable::value_type &second)
+            {
+                return first.first->getDispatchPriority() < second.first->getDispatchPriority();
+            }
+        );
+        table_revision = ListenerImpl<EventType, void>::revision;
+        return table;
+    }
 };
 
 template <typename EventType>
@@ -90,10 +182,13 @@ public:
 
 protected:
     static std::set<BaseListener *> listeners;
+    // Changes whenever a listener is added or removed, so cached views of "listeners" know when to be rebuilt
+    static uint revision;
 
 private:
-    static void activate(BaseListener *ptr) { listeners.insert(ptr); }
-    static void deactivate(BaseListener *ptr) { listeners.erase(ptr); }
+    static void activate(BaseListener *ptr) { listeners.insert(ptr); revision++; }
+    static void deactivate(BaseListener *ptr) { listeners.erase(ptr); revision++; }
 };
 
 template <typename EventType> std::set<BaseListener *> ListenerImpl<EventType, void>::listeners;
+template <typename EventType> uint ListenerImpl<EventType, void>::revision = 0;
@@ -35,6 +35,8 @@
 namespace MetricCalculations
 {
     class Counter;
+    class ShardedCounter;
+    class LatencyHistogram;
     template <typename T> class Max;
     template <typename T> class Min;
     template <typename T> class Average;
@@ -60,7 +62,8 @@ class GenericMetric
     Singleton::Consume<I_RestApi>,
     Singleton::Consume<I_Encryptor>,
     public Listener<AllMetricEvent>,
-    public Listener<MetricScrapeEvent>
+    public Listener<MetricScrapeEvent>,
+    public Listener<MetricExpositionEvent>
 {
 public:
     enum class Stream { FOG, DEBUG, AIOPS, COUNT };
@@ -93,12 +96,14 @@ public:
     static void fini() {}
 
     static std::string getName() { return "GenericMetric"; }
+    static bool isPrometheusEnabled();
 
     std::string generateReport() const;
     void resetMetrics();
     void upon(const AllMetricEvent &) override;
     std::string respond(const AllMetricEvent &event) override;
     std::vector<PrometheusData> respond(const MetricScrapeEvent &event) override;
+    void upon(const MetricExpositionEvent &event) override;
     std::string getListenerName() const override;
 
     std::string getMetricName() const;
@@ -109,6 +114,8 @@ public:
 
 protected:
     virtual void sendLog(const LogRest &metric_client_rest) const;
+    // Called before the calculations are reported, for metrics that derive them from a state of their own
+    virtual void updateMetrics() {}
 
 private:
     class MetricsRest;
@@ -117,6 +124,7 @@ private:
     void addCalc(MetricCalc *calc);
 
     std::vector<PrometheusData> getPromMetricsData(const std::vector<MetricCalc*> *allowed_calcs = nullptr);
+    std::string & getPrometheusLabels();
 
     void handleMetricStreamSending();
     void generateLog();
@@ -137,14 +145,18 @@ private:
     bool force_buffering = false;
     Context ctx;
     std::string asset_id;
+    std::string prometheus_labels;
+    std::string prometheus_labels_agent_id;
 };
 
 #include "metric/counter.h"
 #include "metric/no_reset_counter.h"
+#include "metric/sharded_counter.h"
 #include "metric/max.h"
 #include "metric/min.h"
 #include "metric/average.h"
 #include "metric/top_values.h"
+#include "metric/latency_histogram.h"
 #include "metric/last_reported_value.h"
 #include "metric/metric_map.h"
 
@@ -0,0 +1,228 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LATENCY_HISTOGRAM_H__
+#define __LATENCY_HISTOGRAM_H__
+
+#ifndef __GENERIC_METRIC_H__
+#error metric/latency_histogram.h should not be included directly
+#endif // __GENERIC_METRIC_H_
+
+#include <array>
+#include <chrono>
+
+namespace MetricCalculations
+{
+
+// Keeps the distribution of latencies (in microseconds) in HDR-style buckets: every value under 64 has a bucket of its
+// own, and every power of two above it is split into 32 buckets. The memory of the histogram is fixed, and a reported
+// percentile is never lower than the real one, and is at most 1/32 (about 3%) above it.
+class LatencyHistogram : public MetricCalc
+{
+public:
+    template <typename ... Args>
+    LatencyHistogram(GenericMetric *metric, const std::string &title, const Args & ... args)
+            :
+        MetricCalc(metric, title, args ...)
+    {
+        buckets.fill(0);
+    }
+
+    void
+    report(const std::chrono::microseconds &latency)
+    {
+        report(latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0);
+    }
+
+    void
+    report(uint64_t latency)
+    {
+        if (latency > max_latency) latency = max_latency;
+        buckets[getBucketIndex(latency)]++;
+        count++;
+        if (latency > max) max = latency;
+    }
+
+    void
+    reset() override
+    {
+        buckets.fill(0);
+        count = 0;
+        max = 0;
+    }
+
+    uint64_t getCount() const { return count; }
+
+    uint64_t
+    getPercentile(double percentile) const
+    {
+        if (count == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100 * count));
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (uint index = 0; index < buckets_count; index++) {
+            seen += buckets[index];
+            if (seen >= rank) return std::min(getBucketTop(index), max);
+        }
+        return max;
+    }
+
+    // A single number doesn't describe the distribution, so the histogram is only reported by its percentiles
+    float
+    getValue() const override
+    {
+        return std::nanf("");
+    }
+
+    void
+    save(cereal::JSONOutputArchive &ar) const override
+    {
+        ar.setNextName(getMetricName().c_str());
+        ar.startNode();
+        for (const auto &percentile : percentiles) {
+            ar(cereal::make_nvp(percentile.name, getPercentile(percentile.value)));
+        }
+        ar(cereal::make_nvp("count", count));
+        ar.finishNode();
+    }
+
+    LogField
+    getLogField() const override
+    {
+        LogField field(getMetricName());
+        for (const auto &percentile : percentiles) {
+            field.addFields(LogField(percentile.name, getPercentile(percentile.value)));
+        }
+        field.addFields(LogField("count", count));
+        return field;
+    }
+
+    std::vector<PrometheusData>
+    getPrometheusMetrics(const std::string &metric_name, const std::string &asset_id) const override
+    {
+        if (count == 0) return {};
+
+        std::string name = getMetricDotName() != "" ? getMetricDotName() : getMetricName();
+        std::string labels;
+        for (auto &label : getBasicLabels(metric_name, asset_id)) {
+            PrometheusExposition::appendLabel(labels, label.first, label.second);
+        }
+
+        std::vector<PrometheusData> res;
+        for (const auto &percentile : percentiles) {
+            PrometheusData data;
+            data.name = name;
+            data.unique_name = name + "_" + percentile.name + "_" + metric_name;
+            data.type = "gauge";
+            data.description = getMetircDescription();
+            data.label = labels;
+            PrometheusExposition::appendLabel(data.label, "quantile", percentile.quantile);
+            data.value = std::to_string(getPercentile(percentile.value));
+            res.push_back(std::move(data));
+        }
+        return res;
+    }
+
+    std::vector<AiopsMetricData>
+    getAiopsMetrics() const override
+    {
+        if (count == 0) return {};
+
+        std::string name = getMetricDotName() != "" ? getMetricDotName() : getMetricName();
+        std::vector<AiopsMetricData> res;
+        for (const auto &percentile : percentiles) {
+            res.emplace_back(
+                name,
+                "Gauge",
+                getMetircUnits(),
+                getMetircDescription(),
+                getBasicLabels(getMetricName()),
+                static_cast<float>(getPercentile(percentile.value))
+            );
+            res.back().addMetricAttribute("quantile", percentile.quantile);
+        }
+        return res;
+    }
+
+    void
+    renderPrometheus(PrometheusExposition &exposition, const std::string &name, std::string &labels) const override
+    {
+        if (count == 0) return;
+
+        auto shared_labels_size = labels.size();
+        for (const auto &percentile : percentiles) {
+            PrometheusExposition::appendLabel(labels, "quantile", percentile.quantile);
+            exposition.addSample(
+                name,
+                MetricType::GAUGE,
+                getPrometheusDescription(),
+                labels,
+                static_cast<float>(getPercentile(percentile.value))
+            );
+            labels.resize(shared_labels_size);
+        }
+    }
+
+private:
+    static const uint sub_bucket_bits = 6;
+    static const uint sub_bucket_count = 1 << sub_bucket_bits;
+    static const uint half_sub_bucket_count = sub_bucket_count / 2;
+    // Latencies are kept up to 2^36 microseconds (about 19 hours), longer ones are counted as that
+    static const uint max_latency_bits = 36;
+    static const uint64_t max_latency = (uint64_t(1) << max_latency_bits) - 1;
+    static const uint buckets_count =
+        sub_bucket_count + (max_latency_bits - sub_bucket_bits) * half_sub_bucket_count;
+
+    class Percentile
+    {
+    public:
+        const char *name;
+        const char *quantile;
+        double value;
+    };
+
+    static constexpr Percentile percentiles[] = {
+        { "p50", "0.5", 50 },
+        { "p99", "0.99", 99 },
+        { "p999", "0.999", 99.9 }
+    };
+
+    static uint
+    getBucketIndex(uint64_t latency)
+    {
+        if (latency < sub_bucket_count) return latency;
+
+        uint shift = (63 - __builtin_clzll(latency)) - (sub_bucket_bits - 1);
+        return sub_bucket_count + (shift - 1) * half_sub_bucket_count + (latency >> shift) - half_sub_bucket_count;
+    }
+
+    static uint64_t
+    getBucketTop(uint index)
+    {
+        if (index < sub_bucket_count) return index;
+
+        uint shift = (index - sub_bucket_count) / half_sub_bucket_count + 1;
+        uint64_t sub_bucket = (index - sub_bucket_count) % half_sub_bucket_count + half_sub_bucket_count;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    std::array<uint32_t, buckets_count> buckets;
+    uint64_t count = 0;
+    uint64_t max = 0;
+};
+
+} // namespace MetricCalculations
+
+#endif // __LATENCY_HISTOGRAM_H__
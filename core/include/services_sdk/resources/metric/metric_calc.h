@@ -66,6 +66,54 @@ public:
 
 };
 
+// Renders metrics in the Prometheus text exposition format. The samples are grouped by the family (metric name) they
+// belong to, and the buffers of the families are kept from one scrape to the next, so once they have grown, rendering
+// the metrics doesn't allocate.
+class PrometheusExposition
+{
+public:
+    void addSample(
+        const std::string &name,
+        MetricType type,
+        const std::string &description,
+        const std::string &labels,
+        float value
+    );
+    const std::string & render();
+
+    static void appendLabel(std::string &labels, const std::string &name, const std::string &value);
+
+private:
+    class Family
+    {
+    public:
+        MetricType type = MetricType::GAUGE;
+        std::string description;
+        std::string samples;
+    };
+
+    std::map<std::string, Family> families;
+    std::string exposition;
+};
+
+class MetricExpositionEvent : public Event<MetricExpositionEvent>
+{
+public:
+    MetricExpositionEvent(PrometheusExposition &_exposition, bool _are_all_metrics_enabled)
+            :
+        exposition(_exposition),
+        are_all_metrics_enabled(_are_all_metrics_enabled)
+    {
+    }
+
+    PrometheusExposition & getExposition() const { return exposition; }
+    bool areAllMetricsEnabled() const { return are_all_metrics_enabled; }
+
+private:
+    PrometheusExposition &exposition;
+    bool are_all_metrics_enabled;
+};
+
 class AiopsMetricData
 {
 public:
@@ -261,6 +309,11 @@ public:
     ) const;
     virtual float getValue() const = 0;
     virtual std::vector<AiopsMetricData> getAiopsMetrics() const;
+    // Adds the samples of the calculation, under `name`, to a Prometheus exposition. Calculations that hold other
+    // calculations add the labels of each of them to `labels` while it is rendered, and then restore it.
+    virtual void renderPrometheus(PrometheusExposition &exposition, const std::string &name, std::string &labels) const;
+    const std::string & getPrometheusName() const;
+    bool isDefaultPrometheusMetric() const;
 
     void setMetricName(const std::string &name) { setMetadata("BaseName", name); }
     void setMetricDotName(const std::string &name) { setMetadata("DotName", name); }
@@ -270,6 +323,7 @@ public:
 
 protected:
     void addMetric(GenericMetric *metric);
+    const std::string & getPrometheusDescription() const;
     std::map<std::string, std::string> getBasicLabels(
         const std::string &metric_name,
         const std::string &asset_id = ""
@@ -289,7 +343,13 @@ protected:
     void parseMetadata() {}
 
 private:
+    void cachePrometheusSeries() const;
+
     std::map<std::string, std::string> metadata;
+    mutable bool is_prometheus_series_cached = false;
+    mutable std::string prometheus_name;
+    mutable std::string prometheus_description;
+    mutable bool is_default_prometheus_metric = false;
 };
 
 #endif // __METRIC_CALC_H__
@@ -44,7 +44,19 @@ class MetricMap : public MetricCalc
             return inner_map.emplace(key, std::move(metric));
         }
 
-        void clear() { inner_map.clear(); }
+        Metric *
+        find(const std::string &key)
+        {
+            auto metric = inner_map.find(key);
+            return metric != inner_map.end() ? &metric->second : nullptr;
+        }
+
+        void
+        clear()
+        {
+            inner_map.clear();
+            prometheus_key_labels.clear();
+        }
 
         MetricType
         getMetricType() const
@@ -76,6 +88,30 @@ class MetricMap : public MetricCalc
             return res;
         }
 
+        void
+        renderPrometheus(
+            PrometheusExposition &exposition,
+            const std::string &name,
+            const std::string &label,
+            std::string &labels
+        ) const
+        {
+            auto shared_labels_size = labels.size();
+            for (auto &metric : inner_map) {
+                auto key_labels = prometheus_key_labels.find(metric.first);
+                if (key_labels == prometheus_key_labels.end()) {
+                    std::string new_key_labels;
+                    PrometheusExposition::appendLabel(new_key_labels, label, metric.first);
+                    key_labels = prometheus_key_labels.emplace(metric.first, std::move(new_key_labels)).first;
+                }
+
+                if (shared_labels_size > 0) labels += ',';
+                labels += key_labels->second;
+                metric.second.renderPrometheus(exposition, name, labels);
+                labels.resize(shared_labels_size);
+            }
+        }
+
         std::vector<AiopsMetricData>
         getAiopsMetrics(const std::string &label) const
         {
@@ -95,6 +131,8 @@ class MetricMap : public MetricCalc
 
     private:
         std::map<std::string, Metric> inner_map;
+        // The label of every key is built once, when the key is first rendered, rather than on every scrape
+        mutable std::map<std::string, std::string> prometheus_key_labels;
     };
 
 public:
@@ -139,12 +177,15 @@ public:
     void
     report(const PrintableKey &key, const Values & ... new_values)
     {
-        std::stringstream string_key;
-        string_key << key;
-        auto new_metric = base_metric;
-        new_metric.setMetricName(string_key.str());
-        auto metric = metric_map.emplace(string_key.str(), std::move(new_metric)).first;
-        metric->second.report(new_values...);
+        const std::string &string_key = getKeyString(key);
+        // The base metric is only copied for new keys, as some metrics (like histograms) are costly to copy
+        Metric *metric = metric_map.find(string_key);
+        if (metric == nullptr) {
+            auto new_metric = base_metric;
+            new_metric.setMetricName(string_key);
+            metric = &metric_map.emplace(string_key, std::move(new_metric)).first->second;
+        }
+        metric->report(new_values...);
     }
 
     LogField
@@ -165,6 +206,12 @@ public:
         return metric_map.getPrometheusMetrics(metric_name, label, getMetricName(), asset_id);
     }
 
+    void
+    renderPrometheus(PrometheusExposition &exposition, const std::string &name, std::string &labels) const override
+    {
+        metric_map.renderPrometheus(exposition, name, label, labels);
+    }
+
     std::vector<AiopsMetricData>
     getAiopsMetrics() const
     {
@@ -172,6 +219,17 @@ public:
     }
 
 private:
+    static const std::string & getKeyString(const std::string &key) { return key; }
+
+    template <typename Key>
+    static std::string
+    getKeyString(const Key &key)
+    {
+        std::stringstream string_key;
+        string_key << key;
+        return string_key.str();
+    }
+
     InnerMap metric_map;
     Metric base_metric;
     std::string label;
@@ -0,0 +1,105 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef __SHARDED_COUNTER_H__
+#define __SHARDED_COUNTER_H__
+
+#ifndef __GENERIC_METRIC_H__
+#error metric/sharded_counter.h should not be included directly
+#endif // __GENERIC_METRIC_H_
+
+#include <array>
+#include <atomic>
+
+namespace MetricCalculations
+{
+
+// A counter that is meant to be updated directly from the data path, rather than through an event. Every thread adds
+// to a shard of its own (threads share a shard only when there are more of them than shards), so an update is an
+// uncontended relaxed addition. The shards are only summed when the metric is reported.
+class ShardedCounter : public MetricCalc
+{
+public:
+    template <typename ... Args>
+    ShardedCounter(GenericMetric *metric, const std::string &title, const Args & ... args)
+            :
+        MetricCalc(metric, title, args ...)
+    {
+    }
+
+    void
+    reset() override
+    {
+        for (auto &shard : shards) {
+            shard.counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t
+    getCounter() const
+    {
+        uint64_t counter = 0;
+        for (const auto &shard : shards) {
+            counter += shard.counter.load(std::memory_order_relaxed);
+        }
+        return counter;
+    }
+
+    float
+    getValue() const override
+    {
+        return static_cast<float>(getCounter());
+    }
+
+    void
+    save(cereal::JSONOutputArchive &ar) const override
+    {
+        ar(cereal::make_nvp(getMetricName(), getCounter()));
+    }
+
+    void
+    report(const uint64_t &new_value)
+    {
+        shards[getShardIndex()].counter.fetch_add(new_value, std::memory_order_relaxed);
+    }
+
+    LogField
+    getLogField() const override
+    {
+        return LogField(getMetricName(), static_cast<uint64_t>(getCounter()));
+    }
+
+private:
+    static const uint shards_count = 16;
+
+    // Every shard is on a cache line of its own, so threads that update different shards don't contend
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> counter{0};
+    };
+
+    static uint
+    getShardIndex()
+    {
+        static std::atomic<uint> next_shard_index{0};
+        thread_local uint shard_index = next_shard_index.fetch_add(1, std::memory_order_relaxed) % shards_count;
+        return shard_index;
+    }
+
+    std::array<Shard, shards_count> shards;
+};
+
+} // namespace MetricCalculations
+
+#endif // __SHARDED_COUNTER_H__
@@ -81,8 +81,10 @@ public:
     void addToOrigin(const LogField &log);
 
     void setIndex(size_t index) { reportIndex = index;}
+    const std::string & getTitle() const { return title; }
     bool isStreamActive(const ReportIS::StreamType stream_type) const { return stream_types.isSet(stream_type); }
     bool isEnreachmentActive(const ReportIS::Enreachments type) const { return enreachments.isSet(type); }
+    bool isSecurityEvent() const { return audience == ReportIS::Audience::SECURITY; }
 
     std::map<std::string, std::string> & getMarkers() { return markers; }
     const std::map<std::string, std::string> & getMarkers() const { return markers; }
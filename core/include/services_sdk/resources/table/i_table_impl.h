@@ -25,7 +25,7 @@ template <typename Opaque>
 bool
 I_Table::hasState() const
 {
-    return hasState(typeid(Opaque));
+    return hasState(TableOpaqueSlot::get<Opaque>());
 }
 
 template <typename Opaque, typename ...Args>
@@ -33,21 +33,21 @@ bool
 I_Table::createState(Args ...args)
 {
     std::unique_ptr<TableOpaqueBase>  ptr = std::make_unique<Opaque>(std::forward<Args>(args)...);
-    return createState(typeid(Opaque), std::move(ptr));
+    return createState(TableOpaqueSlot::get<Opaque>(), std::move(ptr));
 }
 
 template <typename Opaque>
 void
 I_Table::deleteState()
 {
-    deleteState(typeid(Opaque));
+    deleteState(TableOpaqueSlot::get<Opaque>());
 }
 
 template <typename Opaque>
 Opaque &
 I_Table::getState()
 {
-    Opaque *ptr = static_cast<Opaque *>(getState(typeid(Opaque)));
+    Opaque *ptr = static_cast<Opaque *>(getState(TableOpaqueSlot::get<Opaque>()));
     dbgAssert(ptr != nullptr)
         << AlertInfo(AlertTeam::CORE, "table")
         << "Trying to access a non existing opaque "
@@ -0,0 +1,37 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __TABLE_OPAQUE_SLOT_H__
+#define __TABLE_OPAQUE_SLOT_H__
+
+#include <typeindex>
+#include <sys/types.h>
+
+// Every opaque type is given a dense slot number the first time it is used, so that table entries can keep
+// their opaques in an array indexed by the slot, rather than in a map keyed by the type.
+class TableOpaqueSlot
+{
+public:
+    template <typename Opaque>
+    static uint
+    get()
+    {
+        static const uint slot = getByType(typeid(Opaque));
+        return slot;
+    }
+
+    static uint getByType(const std::type_index &index);
+    static const char * getTypeName(uint slot);
+};
+
+#endif // __TABLE_OPAQUE_SLOT_H__
@@ -48,12 +48,7 @@ CefStream::~CefStream()
 void
 CefStream::sendLog(const Report &log)
 {
-    string cef_report = log.getCef();
-    if (protocol == I_Socket::SocketType::TCP) {
-        cef_report = to_string(cef_report.length()) + " " + cef_report;
-    }
-    vector<char> data(cef_report.begin(), cef_report.end());
-    sendLogWithQueue(data);
+    sendLogWithQueue(log.getCef());
 }
 
 void
@@ -23,6 +23,41 @@ using namespace cereal;
 
 USE_DEBUG_FLAG(D_REPORT);
 
+// Receives the JSON that cereal generates for a log and appends it to a (reused) string. When the log is written in
+// a single line, the line breaks that the JSON writer puts between elements are dropped on the way. Line breaks
+// inside of values are escaped by the writer, so they never reach here as is.
+class LogLineBuffer : public streambuf
+{
+public:
+    LogLineBuffer(string &_line, bool _is_single_line) : line(_line), is_single_line(_is_single_line) {}
+
+protected:
+    int_type
+    overflow(int_type ch) override
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+        if (!is_single_line || ch != '\n') line.push_back(traits_type::to_char_type(ch));
+        return ch;
+    }
+
+    streamsize
+    xsputn(const char *data, streamsize size) override
+    {
+        if (!is_single_line) {
+            line.append(data, size);
+            return size;
+        }
+        for (streamsize index = 0; index < size; index++) {
+            if (data[index] != '\n') line.push_back(data[index]);
+        }
+        return size;
+    }
+
+private:
+    string &line;
+    bool is_single_line;
+};
+
 string
 getLogFileName()
 {
@@ -38,13 +73,26 @@ getLogFileName()
     return file_path;
 }
 
-LogFileStream::LogFileStream() : log_file_name(getLogFileName())
+LogFileStream::LogFileStream()
+        :
+    log_file_name(getLogFileName()),
+    mainloop(Singleton::Consume<I_MainLoop>::by<LoggingComp>())
 {
     openLogFile();
+
+    // Logs are flushed to the file in batches, so this routine makes sure the last ones don't linger in memory
+    auto flush_interval = getConfigurationWithDefault<uint>(500, "Logging", "Log file flush interval in msec");
+    flush_routine = mainloop->addRecurringRoutine(
+        I_MainLoop::RoutineType::Offline,
+        chrono::milliseconds(flush_interval),
+        [this] () { flushLogFile(); },
+        "Flushing the log file"
+    );
 }
 
 LogFileStream::~LogFileStream()
 {
+    if (mainloop->doesRoutineExist(flush_routine)) mainloop->stop(flush_routine);
     closeLogFile();
 }
 
@@ -65,31 +113,34 @@ LogFileStream::sendLog(const Report &log)
     string logs_separator = getProfileAgentSettingWithDefault<string>("", "agent.config.logFileLineSeparator");
     logs_separator = getConfigurationWithDefault<string>(logs_separator, "Logging", "Log file line separator");
 
-    stringstream ss;
-    if (should_format_log) {
-        {
-            JSONOutputArchive ar(ss);
-            log.serialize(ar);
-        }
-        log_stream << ss.str() << logs_separator << endl;
-    } else {
-        {
-            JSONOutputArchive ar(ss, JSONOutputArchive::Options::NoIndent());
-            log.serialize(ar);
-        }
-        static const boost::regex reg("\\n");
-        log_stream << NGEN::Regex::regexReplace(__FILE__, __LINE__, ss.str(), reg, "") << logs_separator << endl;
+    log_line.clear();
+    {
+        LogLineBuffer line_buffer(log_line, !should_format_log);
+        ostream line_stream(&line_buffer);
+        JSONOutputArchive ar(
+            line_stream,
+            should_format_log ? JSONOutputArchive::Options::Default() : JSONOutputArchive::Options::NoIndent()
+        );
+        log.serialize(ar);
     }
+    log_line += logs_separator;
+    log_line += '\n';
 
+    log_stream.write(log_line.data(), log_line.size());
     if (!log_stream.good()) {
         dbgWarning(D_REPORT) << "Failed to write log to file, will retry. File path: " << log_file_name;
 
-        if (!retryWritingLog(ss.str())) {
+        if (!retryWritingLog(log_line)) {
             dbgWarning(D_REPORT) << "Failed to write log to file";
             return;
         }
     }
 
+    unflushed_logs++;
+    if (unflushed_logs >= getConfigurationWithDefault<uint>(100, "Logging", "Maximum unflushed logs in file")) {
+        flushLogFile();
+    }
+
     dbgDebug(D_REPORT) << "Successfully wrote log to file";
 }
 
@@ -111,9 +162,22 @@ LogFileStream::openLogFile()
     dbgDebug(D_REPORT) << "Successfully opened log file at path: " << log_file_name;
 }
 
+void
+LogFileStream::flushLogFile()
+{
+    if (unflushed_logs == 0) return;
+
+    unflushed_logs = 0;
+    log_stream.flush();
+    if (!log_stream.good()) {
+        dbgWarning(D_REPORT) << "Failed to flush logs to file. File path: " << log_file_name;
+    }
+}
+
 void
 LogFileStream::closeLogFile()
 {
+    unflushed_logs = 0;
     log_stream.close();
     if (log_stream.is_open() || log_stream.failbit) {
         dbgWarning(D_REPORT) << "Failed in closing log file. File path: " << log_file_name;
@@ -131,7 +195,7 @@ LogFileStream::retryWritingLog(const string &log)
         closeLogFile();
         openLogFile();
 
-        log_stream << log << endl;
+        log_stream << log << flush;
         if (log_stream.good()) return true;
     }
 
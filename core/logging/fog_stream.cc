@@ -49,6 +49,17 @@ FogStream::sendLog(const LogBulkRest &logs, bool persistence_only)
     ctx.registerValue<bool>("Obfuscate log field", true);
 
     auto fog_log_uri = getConfigurationWithDefault<string>("/api/v1/agents/events/bulk", "Logging", "Fog Log URI");
+    if (shouldCompressLogBulks()) {
+        auto compressed_logs = compressLogBulk(logs);
+        if (compressed_logs.ok()) {
+            MessageMetadata fog_log_md;
+            fog_log_md.insertHeader("Content-Encoding", "gzip");
+            i_msg->sendAsyncMessage(HTTPMethod::POST, fog_log_uri, *compressed_logs, MessageCategory::LOG, fog_log_md);
+            return;
+        }
+        dbgWarning(D_REPORT) << "Sending bulk of logs uncompressed. Error: " << compressed_logs.getErr();
+    }
+
     if (!persistence_only) {
         i_msg->sendAsyncMessage(HTTPMethod::POST, fog_log_uri, logs, MessageCategory::LOG);
     } else {
@@ -86,6 +86,26 @@ ContainerSvcStream::sendLog(const LogBulkRest &logs, bool persistence_only)
     MessageMetadata rest_req_md(svc_host, 80);
     rest_req_md.insertHeader("X-Tenant-Id", Singleton::Consume<I_AgentDetails>::by<LoggingComp>()->getTenantId());
     rest_req_md.setConnectioFlag(MessageConnectionConfig::UNSECURE_CONN);
+
+    if (shouldCompressLogBulks()) {
+        auto compressed_logs = compressLogBulk(logs);
+        if (compressed_logs.ok()) {
+            rest_req_md.insertHeader("Content-Encoding", "gzip");
+            auto response = i_msg->sendSyncMessage(
+                HTTPMethod::POST,
+                svc_log_uri,
+                *compressed_logs,
+                MessageCategory::LOG,
+                rest_req_md
+            );
+            if (!response.ok() || response->getHTTPStatusCode() != HTTPStatusCode::HTTP_OK) {
+                dbgWarning(D_REPORT) << "failed to send compressed bulk logs";
+            }
+            return;
+        }
+        dbgWarning(D_REPORT) << "Sending bulk logs uncompressed. Error: " << compressed_logs.getErr();
+    }
+
     bool ok = i_msg->sendSyncMessageWithoutResponse(
         HTTPMethod::POST,
         svc_log_uri,
@@ -0,0 +1,101 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "log_aggregator.h"
+
+#include "logging_comp.h"
+
+using namespace std;
+
+static const vector<string> signature_fields = {
+    "assetId",
+    "practiceId",
+    "ruleId",
+    "sourceIP",
+    "securityAction",
+    "waapIncidentType"
+};
+
+bool
+LogAggregator::fold(const Report &log, chrono::microseconds now, chrono::microseconds window)
+{
+    if (!log.isSecurityEvent()) return false;
+
+    string signature = getSignature(log);
+    auto existing_window = windows.find(signature);
+    if (existing_window == windows.end() || existing_window->second.end <= now) {
+        if (existing_window != windows.end()) windows.erase(existing_window);
+        if (windows.size() < max_windows) windows.emplace(signature, Window(now + window));
+        return false;
+    }
+
+    auto &open_window = existing_window->second;
+    if (open_window.folded_logs == 0) {
+        open_window.sample = log;
+        open_window.first_folded_time = now;
+    }
+    open_window.folded_logs++;
+    open_window.last_folded_time = now;
+    return true;
+}
+
+vector<Report>
+LogAggregator::popEndedWindows(chrono::microseconds now)
+{
+    vector<Report> logs;
+    for (auto window = windows.begin(); window != windows.end();) {
+        if (window->second.end > now) {
+            window++;
+            continue;
+        }
+        popWindow(window->second, logs);
+        window = windows.erase(window);
+    }
+    return logs;
+}
+
+vector<Report>
+LogAggregator::popAllWindows()
+{
+    vector<Report> logs;
+    for (auto &window : windows) {
+        popWindow(window.second, logs);
+    }
+    windows.clear();
+    return logs;
+}
+
+string
+LogAggregator::getSignature(const Report &log)
+{
+    string signature = log.getTitle();
+    for (const auto &field : signature_fields) {
+        signature += '\0';
+        auto value = log.getStringData(field);
+        if (value.ok()) signature += *value;
+    }
+    return signature;
+}
+
+void
+LogAggregator::popWindow(const Window &window, vector<Report> &logs)
+{
+    if (window.folded_logs == 0) return;
+
+    auto i_time = Singleton::Consume<I_TimeGet>::by<LoggingComp>();
+    logs.push_back(window.sample);
+    logs.back()
+        << LogField("aggregatedEventsCount", window.folded_logs)
+        << LogField("firstAggregatedEventTime", i_time->getWalltimeStr(window.first_folded_time))
+        << LogField("lastAggregatedEventTime", i_time->getWalltimeStr(window.last_folded_time));
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LOG_AGGREGATOR_H__
+#define __LOG_AGGREGATOR_H__
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "report/report.h"
+
+// Folds security events that repeat within a time window into a single log.
+// The first event of a kind is sent as is, and opens a window. Events of the same kind that arrive until the window
+// ends are held back and counted. When the window ends, one of them is sent with the number of held back events and
+// the times of the first and the last of them.
+// Events are of the same kind when their titles and their signature fields (asset, rule, source etc.) match.
+class LogAggregator
+{
+public:
+    // Returns true if the log was folded into earlier logs of its kind, and shouldn't be sent now
+    bool fold(const Report &log, std::chrono::microseconds now, std::chrono::microseconds window);
+    // Returns the logs that summarize the windows that ended
+    std::vector<Report> popEndedWindows(std::chrono::microseconds now);
+    std::vector<Report> popAllWindows();
+
+    static const uint max_windows = 10000;
+
+private:
+    class Window
+    {
+    public:
+        Window(std::chrono::microseconds _end) : end(_end) {}
+
+        std::chrono::microseconds end;
+        Report sample;
+        uint folded_logs = 0;
+        std::chrono::microseconds first_folded_time;
+        std::chrono::microseconds last_folded_time;
+    };
+
+    static std::string getSignature(const Report &log);
+    static void popWindow(const Window &window, std::vector<Report> &logs);
+
+    std::unordered_map<std::string, Window> windows;
+};
+
+#endif // __LOG_AGGREGATOR_H__
@@ -0,0 +1,55 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "log_streams.h"
+
+#include "compression_utils.h"
+#include "config.h"
+
+using namespace std;
+
+bool
+shouldCompressLogBulks()
+{
+    bool should_compress = getProfileAgentSettingWithDefault<bool>(false, "agent.config.log.compressBulk");
+    return getConfigurationWithDefault<bool>(should_compress, "Logging", "Compress bulk of logs");
+}
+
+Maybe<string>
+compressLogBulk(const LogBulkRest &logs)
+{
+    auto logs_json = logs.genJson();
+    if (!logs_json.ok()) return logs_json;
+
+    auto compression_stream = initCompressionStream();
+    CompressionResult result = compressData(
+        compression_stream,
+        CompressionType::GZIP,
+        logs_json->size(),
+        reinterpret_cast<const unsigned char *>(logs_json->data()),
+        1
+    );
+    finiCompressionStream(compression_stream);
+
+    if (!result.ok) return genError("Failed to compress the bulk of logs");
+
+    string compressed_logs(reinterpret_cast<const char *>(result.output), result.num_output_bytes);
+    free(result.output);
+
+    dbgTrace(D_REPORT)
+        << "Compressed bulk of logs. Original size: "
+        << logs_json->size()
+        << ", compressed size: "
+        << compressed_logs.size();
+    return compressed_logs;
+}
@@ -13,6 +13,8 @@
 
 #include "log_streams.h"
 
+using namespace std;
+
 void
 LogStreamConnector::maintainConnection()
 {
@@ -33,16 +35,24 @@ LogStreamConnector::maintainConnection()
 }
 
 void
-LogStreamConnector::addLogToQueue(const std::vector<char> &data)
+LogStreamConnector::addLogToQueue(const string &data)
 {
-    if (logs_in_queue.size() < max_data_in_queue) {
-        dbgTrace(D_REPORT)
-            << "Adding log to queue, Amount of logs in queue: "
-            << logs_in_queue.size();
-        logs_in_queue.push_back(data);
-    } else {
+    if (queued_log_sizes.size() >= max_data_in_queue) {
         dbgWarning(D_REPORT) << "Queue is full, dropping log";
+        return;
+    }
+
+    dbgTrace(D_REPORT) << "Adding log to queue, Amount of logs in queue: " << queued_log_sizes.size();
+    size_t log_size = data.size();
+    if (protocol == I_Socket::SocketType::TCP) {
+        // Logs sent over TCP are framed by their length and a space that come before them
+        auto log_length = to_string(data.size());
+        queued_logs_data.insert(queued_logs_data.end(), log_length.begin(), log_length.end());
+        queued_logs_data.push_back(' ');
+        log_size += log_length.size() + 1;
     }
+    queued_logs_data.insert(queued_logs_data.end(), data.begin(), data.end());
+    queued_log_sizes.push_back(log_size);
 }
 
 void
@@ -62,70 +72,57 @@ LogStreamConnector::writeFail()
 }
 
 bool
-LogStreamConnector::basicWriteLog(const std::vector<char> &data)
+LogStreamConnector::writeQueuedLogs()
 {
-    for (size_t tries = 0; tries < 3; tries++) {
-        if (socket.ok() && i_socket->writeData(socket.unpack(), data)) {
-            dbgTrace(D_REPORT) << "log was sent to server";
+    size_t logs_in_batch = min<size_t>(queued_log_sizes.size(), max(max_logs_per_send, 1));
+    logs_to_write.clear();
+    char *log_data = queued_logs_data.data();
+    for (size_t index = 0; index < logs_in_batch; index++) {
+        logs_to_write.push_back({ log_data, queued_log_sizes[index] });
+        log_data += queued_log_sizes[index];
+    }
+
+    // A batch that couldn't be written over the current connection is written again after reconnecting
+    for (size_t connection_tries = 0; connection_tries < 2; connection_tries++) {
+        for (size_t tries = 0; socket.ok() && tries < 3; tries++) {
+            uint written_logs = i_socket->writeMessages(socket.unpack(), logs_to_write);
+            if (written_logs == 0) continue;
+
+            dbgTrace(D_REPORT) << written_logs << " logs were written to " << log_name << " server";
+            size_t written_bytes = 0;
+            for (size_t index = 0; index < written_logs; index++) {
+                written_bytes += queued_log_sizes[index];
+            }
+            queued_logs_data.erase(queued_logs_data.begin(), queued_logs_data.begin() + written_bytes);
+            queued_log_sizes.erase(queued_log_sizes.begin(), queued_log_sizes.begin() + written_logs);
             return true;
-        } else {
-            dbgTrace(D_REPORT) << "Failed to send log to server";
-            writeFail();
         }
+        dbgTrace(D_REPORT) << "Failed to send logs to " << log_name << " server";
+        writeFail();
     }
     return false;
 }
 
 void
-LogStreamConnector::sendLogWithQueue(const std::vector<char> &data)
+LogStreamConnector::sendLogWithQueue(const string &data)
 {
+    addLogToQueue(data);
     if (!socket.ok()) {
         dbgTrace(D_REPORT)
             << "Socket not ok. Size of logs in queue: "
-            << logs_in_queue.size()
+            << queued_log_sizes.size()
             << ". Adding logs to the queue until the connection is established.";
-        addLogToQueue(data);
         return;
     }
 
-    if (logs_in_queue.empty() && basicWriteLog(data)) return;
-
-    addLogToQueue(data);
-
-    int write_iterations = 0;
-    
-    while (write_iterations < max_logs_per_send && !logs_in_queue.empty()) {
-        dbgTrace(D_REPORT)
-            << " Iteration: "
-            << write_iterations
-            << " to try and write a log from queue to server"
-            << log_name;
-        int i = 0;
-        bool write_success = false;
-        while (
-            socket.ok() &&
-            (i < 3) &&
-            !(write_success = i_socket->writeData(socket.unpack(), logs_in_queue.front()))) {
-            i++;
-        }
-        if (write_success) {
-            dbgTrace(D_REPORT) << "log was written to " << log_name << " server";
-            logs_in_queue.erase(logs_in_queue.begin());
-            write_iterations++;
-        } else {
-            dbgTrace(D_REPORT) << "Failed to send log to " << log_name << " server";
-            writeFail();
-            return;
-        }
-    }
+    writeQueuedLogs();
 }
 
 void
 LogStreamConnector::sendAllLogs()
 {
     dbgTrace(D_REPORT) << "Sending all logs from queue to server";
-    for(auto &log : logs_in_queue) {
-        basicWriteLog(log);
-    }
-    logs_in_queue.clear();
+    while (hasQueuedLogs() && writeQueuedLogs()) {}
+    queued_logs_data.clear();
+    queued_log_sizes.clear();
 }
@@ -35,6 +35,11 @@ static size_t MAX_LOG_QUEUE = 1000;
 
 USE_DEBUG_FLAG(D_REPORT);
 
+// Bulks of logs may be sent compressed with gzip (with a "Content-Encoding: gzip" header), as most of their content is
+// the same field names over and over
+bool shouldCompressLogBulks();
+Maybe<std::string> compressLogBulk(const LogBulkRest &logs);
+
 class Stream
 {
 public:
@@ -70,10 +75,15 @@ public:
 private:
     void openLogFile();
     void closeLogFile();
+    void flushLogFile();
     bool retryWritingLog(const std::string &log);
 
-    std::string     log_file_name;
-    std::ofstream   log_stream;
+    std::string             log_file_name;
+    std::ofstream           log_stream;
+    std::string             log_line;
+    uint                    unflushed_logs = 0;
+    I_MainLoop              *mainloop = nullptr;
+    I_MainLoop::RoutineID   flush_routine = -1;
 };
 
 class FogStream : public Stream
@@ -115,7 +125,6 @@ public:
         address(_address),
         port(_port),
         protocol(_protocol),
-        logs_in_queue(),
         log_name(_log_name) {}
     virtual ~LogStreamConnector() {}
 
@@ -124,11 +133,12 @@ protected:
     virtual void updateSettings() = 0;
 
     void maintainConnection();
-    void addLogToQueue(const std::vector<char> &data);
+    void addLogToQueue(const std::string &data);
     void writeFail();
-    bool basicWriteLog(const std::vector<char> &data);
-    void sendLogWithQueue(const std::vector<char> &data);
+    bool writeQueuedLogs();
+    void sendLogWithQueue(const std::string &data);
     void sendAllLogs();
+    bool hasQueuedLogs() const { return !queued_log_sizes.empty(); }
 
     I_MainLoop *mainloop = nullptr;
     I_Socket *i_socket = nullptr;
@@ -137,7 +147,10 @@ protected:
     I_Socket::SocketType protocol = I_Socket::SocketType::UDP;
     Maybe<I_Socket::socketFd> socket = genError("Not set yet");
     bool did_write_fail_in_this_window = false;
-    std::vector<std::vector<char>> logs_in_queue;
+    // The queued logs are kept one after the other in a buffer that is reused, so queueing a log doesn't allocate
+    std::vector<char> queued_logs_data;
+    std::vector<size_t> queued_log_sizes;
+    std::vector<struct iovec> logs_to_write;
     I_MainLoop::RoutineID connecting_routine = -1;
     int max_logs_per_send = NUMBER_OF_LOGS_PER_SEND;
     std::string log_name;
@@ -157,8 +170,9 @@ protected:
 
 private:
     void init();
-    void sendLogData(const std::vector<char> &data);
+    void sendQueuedLogs();
     I_MainLoop::RoutineID log_send_routine = -1;
+    bool is_log_send_scheduled = false;
 };
 
 class CefStream : public LogStreamConnector
@@ -18,6 +18,8 @@
 #include <fstream>
 
 #include "log_streams.h"
+#include "stream_log_queue.h"
+#include "log_aggregator.h"
 #include "common.h"
 #include "singleton.h"
 #include "debug.h"
@@ -60,6 +62,13 @@ public:
             "Logging Fog stream messaging"
         );
 
+        log_aggregation_routine = i_mainloop->addRecurringRoutine(
+            I_MainLoop::RoutineType::Offline,
+            chrono::seconds(1),
+            [this] () { sendAggregatedLogs(false); },
+            "Logging aggregated logs"
+        );
+
         auto metrics_interval = getConfigurationWithDefault<uint64_t>(600, "Logging", "Metrics Routine Interval");
         log_metric.init(
             "Logging data",
@@ -74,10 +83,15 @@ public:
     void
     fini()
     {
+        sendAggregatedLogs(true);
+        deliverQueuedLogs(false);
         streams.clear();
         if (i_mainloop != nullptr && i_mainloop->doesRoutineExist(log_send_routine)) {
             i_mainloop->stop(log_send_routine);
         }
+        if (i_mainloop != nullptr && i_mainloop->doesRoutineExist(log_aggregation_routine)) {
+            i_mainloop->stop(log_aggregation_routine);
+        }
     }
 
     void
@@ -161,26 +175,16 @@ public:
     void
     sendLog(const Report &log) override
     {
-        if (getConf("agent.config.log.useBulkMode", "Enable bulk of logs", true)) {
-            dbgTrace(D_REPORT) << "Adding log to bulk";
-            reports.setBulkSize(getConfigurationWithDefault<uint>(100, "Logging", "Sent log bulk size"));
-            reports.push(log);
-            if (reports.sizeQueue() >= 4) {
-                auto persistence_only = getConf("agent.config.log.skip.enable", "Enable Log skipping", true);
-                dbgTrace(D_REPORT)
-                << "Sending buffered logs from queue size: "
-                << reports.sizeQueue()
-                << ", persistence_only: "
-                << persistence_only;
-            sendBufferedLogsImpl(false, persistence_only);
-            }
-        } else {
-            LogEventLogsSent(true).notify();
-            for (auto &iter : streams) {
-                dbgTrace(D_REPORT) << "Sending log to stream: " << TagAndEnumManagement::convertToString(iter.first);
-                if (log.isStreamActive(iter.first)) iter.second->sendLog(log);
+        if (getConf("agent.config.log.aggregation.enable", "Enable log aggregation", false)) {
+            auto window = getConfigurationWithDefault<uint>(10, "Logging", "Log aggregation window in sec");
+            auto now = Singleton::Consume<I_TimeGet>::by<LoggingComp>()->getWalltime();
+            if (log_aggregator.fold(log, now, chrono::seconds(window))) {
+                dbgTrace(D_REPORT) << "Log was folded into an aggregated log. Title: " << log.getTitle();
+                return;
             }
         }
+
+        queueLog(log);
     }
 
     uint64_t
@@ -212,6 +216,98 @@ public:
     }
 
 private:
+    void
+    queueLog(const Report &log)
+    {
+        if (getConf("agent.config.log.useBulkMode", "Enable bulk of logs", true)) {
+            dbgTrace(D_REPORT) << "Adding log to bulk";
+            reports.setBulkSize(getConfigurationWithDefault<uint>(100, "Logging", "Sent log bulk size"));
+            reports.push(log);
+            if (reports.sizeQueue() >= 4) scheduleLogsDelivery();
+        } else {
+            LogEventLogsSent(true).notify();
+            auto queue_capacity = getConfigurationWithDefault<uint>(
+                MAX_LOG_QUEUE,
+                "Logging",
+                "Maximum queued logs per stream"
+            );
+            auto queued_log = make_shared<const Report>(log);
+            for (auto &iter : streams) {
+                if (!log.isStreamActive(iter.first)) continue;
+                dbgTrace(D_REPORT) << "Queuing log to stream: " << TagAndEnumManagement::convertToString(iter.first);
+                auto &queue = queued_logs.emplace(iter.first, queue_capacity).first->second;
+                queue.setCapacity(queue_capacity);
+                // A security event may push another log out of a full queue, which also counts as a dropped log
+                auto dropped_logs = queue.getDroppedLogs();
+                if (!queue.push(queued_log)) {
+                    dbgDebug(D_REPORT)
+                        << "Dropping log as the queue of the stream is full. Stream type: "
+                        << TagAndEnumManagement::convertToString(iter.first);
+                }
+                if (queue.getDroppedLogs() != dropped_logs) LogEventLogsDropped(1).notify();
+            }
+            scheduleLogsDelivery();
+        }
+    }
+
+    void
+    sendAggregatedLogs(bool is_final)
+    {
+        auto aggregated_logs =
+            is_final ?
+            log_aggregator.popAllWindows() :
+            log_aggregator.popEndedWindows(Singleton::Consume<I_TimeGet>::by<LoggingComp>()->getWalltime());
+        for (const auto &log : aggregated_logs) {
+            queueLog(log);
+        }
+    }
+
+    // Logs are only queued by the routines that generate them. They are delivered by a routine of their own, so a slow
+    // stream never holds back the inspection of traffic.
+    void
+    scheduleLogsDelivery()
+    {
+        if (is_delivery_scheduled) return;
+
+        is_delivery_scheduled = true;
+        Singleton::Consume<I_MainLoop>::by<LoggingComp>()->addOneTimeRoutine(
+            I_MainLoop::RoutineType::Offline,
+            [this] () { deliverQueuedLogs(true); },
+            "Logging stream delivery"
+        );
+    }
+
+    void
+    deliverQueuedLogs(bool is_async)
+    {
+        while (reports.sizeQueue() >= 4) {
+            auto persistence_only = getConf("agent.config.log.skip.enable", "Enable Log skipping", true);
+            dbgTrace(D_REPORT)
+                << "Sending buffered logs from queue size: "
+                << reports.sizeQueue()
+                << ", persistence_only: "
+                << persistence_only;
+            sendBufferedLogsImpl(is_async, persistence_only);
+        }
+
+        bool are_logs_queued = true;
+        while (are_logs_queued) {
+            are_logs_queued = false;
+            for (auto &iter : queued_logs) {
+                auto stream = streams.find(iter.first);
+                for (uint sent_logs = 0; !iter.second.empty() && sent_logs < logs_per_delivery; sent_logs++) {
+                    auto log = iter.second.pop();
+                    if (stream != streams.end()) stream->second->sendLog(*log);
+                }
+                if (!iter.second.empty()) are_logs_queued = true;
+            }
+            // Yielding may change the streams, so they are looked up again after it
+            if (is_async && are_logs_queued) Singleton::Consume<I_MainLoop>::by<LoggingComp>()->yield();
+        }
+
+        is_delivery_scheduled = false;
+    }
+
     void
     sendBufferedLogs()
     {
@@ -313,12 +409,18 @@ private:
         return nullptr;
     }
 
+    static const uint logs_per_delivery = 20;
+
     uint64_t log_id = 0;
+    map<StreamType, StreamLogQueue> queued_logs;
+    bool is_delivery_scheduled = false;
     map<StreamType, shared_ptr<Stream>> streams;
     map<StreamType, shared_ptr<Stream>> streams_preperation;
     I_MainLoop *i_mainloop;
     ReportsBulk reports;
     I_MainLoop::RoutineID log_send_routine = 0;
+    I_MainLoop::RoutineID log_aggregation_routine = 0;
+    LogAggregator log_aggregator;
     LogMetric log_metric;
     vector<GeneralModifier> modifiers;
 };
@@ -348,6 +450,12 @@ LoggingComp::preload()
     registerExpectedConfiguration<uint>("Logging", "Log bulk sending interval in msec");
     registerExpectedConfiguration<uint>("Logging", "Sent log bulk size");
     registerExpectedConfiguration<uint>("Logging", "Maximum number of write retries");
+    registerExpectedConfiguration<uint>("Logging", "Maximum queued logs per stream");
+    registerExpectedConfiguration<bool>("Logging", "Compress bulk of logs");
+    registerExpectedConfiguration<bool>("Logging", "Enable log aggregation");
+    registerExpectedConfiguration<uint>("Logging", "Log aggregation window in sec");
+    registerExpectedConfiguration<uint>("Logging", "Log file flush interval in msec");
+    registerExpectedConfiguration<uint>("Logging", "Maximum unflushed logs in file");
     registerExpectedConfiguration<uint>("Logging", "Metrics Routine Interval");
 
     pimpl->preload();
@@ -40,11 +40,23 @@ private:
     uint64_t bulks;
 };
 
+class LogEventLogsDropped : public Event<LogEventLogsDropped>
+{
+public:
+    LogEventLogsDropped(uint64_t _logs) : logs(_logs) {}
+
+    uint64_t getLogsNumber() const { return logs; }
+
+private:
+    uint64_t logs;
+};
+
 class LogMetric
         :
     public GenericMetric,
     public Listener<LogEventQueueSize>,
-    public Listener<LogEventLogsSent>
+    public Listener<LogEventLogsSent>,
+    public Listener<LogEventLogsDropped>
 {
 public:
     void
@@ -62,12 +74,15 @@ public:
         sent_logs_bulks.report(event.getBulksNumber());
     }
 
+    void upon(const LogEventLogsDropped &event) override { dropped_logs.report(event.getLogsNumber()); }
+
 private:
     MetricCalculations::Max<uint64_t> max_queue_size{this, "logQueueMaxSizeSample", 0};
     MetricCalculations::Average<double> avg_queue_size{this, "logQueueAvgSizeSample"};
     MetricCalculations::LastReportedValue<uint64_t> current_queue_size{this, "logQueueCurrentSizeSample"};
     MetricCalculations::Counter sent_logs{this, "sentLogsSum"};
     MetricCalculations::Counter sent_logs_bulks{this, "sentLogsBulksSum"};
+    MetricCalculations::Counter dropped_logs{this, "droppedLogsSum"};
 };
 
 #endif // __LOGGING_METRIC_H__
@@ -25,6 +25,9 @@
 #include "mock/mock_shell_cmd.h"
 #include "version.h"
 #include "../log_streams.h"
+#include "../stream_log_queue.h"
+#include "../log_aggregator.h"
+#include "compression_utils.h"
 
 using namespace testing;
 using namespace std;
@@ -130,6 +133,20 @@ public:
             addRecurringRoutine(_, _, _, "Metric Fog stream messaging for Logging data", _)
         ).WillOnce(Return(1));
 
+        EXPECT_CALL(
+            mock_mainloop,
+            addRecurringRoutine(_, _, _, "Logging aggregated logs", _)
+        ).WillOnce(Return(5));
+
+        EXPECT_CALL(
+            mock_mainloop,
+            addRecurringRoutine(_, _, _, "Flushing the log file", _)
+        ).WillRepeatedly(DoAll(SaveArg<2>(&flush_log_file_routine), Return(4)));
+
+        EXPECT_CALL(mock_mainloop, addOneTimeRoutine(_, _, "Logging stream delivery", _)).WillRepeatedly(
+            DoAll(InvokeArgument<1>(), Return(0))
+        );
+
         EXPECT_CALL(mock_mainloop, addOneTimeRoutine(_, _, "Logging Syslog stream messaging", _)).WillRepeatedly(
             DoAll(SaveArg<1>(&sysog_routine), Return(0))
         );
@@ -154,16 +171,8 @@ public:
                 addRecurringRoutine(_, _, _, "connecting to CEF server", _)
             ).WillRepeatedly(DoAll(SaveArg<2>(&connect_cef_routine), Return(3)));
 
-        EXPECT_CALL(mock_socket_is, writeData(1, _)).WillRepeatedly(
-            WithArg<1>(
-                Invoke(
-                    [this](const vector<char> &data)
-                    {
-                        capture_syslog_cef_data.emplace_back(data.begin(), data.end());
-                        return true;
-                    }
-                )
-            )
+        EXPECT_CALL(mock_socket_is, writeMessages(1, _)).WillRepeatedly(
+            WithArg<1>(Invoke(this, &LogTest::captureSyslogCefMessages))
         );
 
         EXPECT_CALL(mock_mainloop, doesRoutineExist(_)).WillRepeatedly(Return(true));
@@ -252,6 +261,8 @@ public:
     string
     readLogFile()
     {
+        if (flush_log_file_routine != nullptr) flush_log_file_routine();
+
         ofstream file;
         file.open(output_filename, ios::in);
 
@@ -265,12 +276,23 @@ public:
         return string_stream.str();
     }
 
+    uint
+    captureSyslogCefMessages(const vector<struct iovec> &messages)
+    {
+        for (const auto &message : messages) {
+            capture_syslog_cef_data.emplace_back(static_cast<const char *>(message.iov_base), message.iov_len);
+        }
+        return messages.size();
+    }
+
     bool
     loadFakeConfiguration(
         bool enable_bulk,
         bool domain = false,
         const string &log_file_name = "",
-        int bulks_size = -1)
+        int bulks_size = -1,
+        bool compress_bulks = false,
+        bool aggregate_logs = false)
     {
         string is_enable_bulks = enable_bulk ? "true" : "false";
         string is_domain = domain ? "true" : "false";
@@ -293,6 +315,9 @@ public:
             str_stream << ", \"Sent log bulk size\": [{\"value\": " << bulks_size << "}]";
         }
 
+        if (compress_bulks) str_stream << ", \"Compress bulk of logs\": [{\"value\": true}]";
+        if (aggregate_logs) str_stream << ", \"Enable log aggregation\": [{\"value\": true}]";
+
         str_stream << "}}";
 
         return Singleton::Consume<Config::I_Config>::from(config)->loadConfiguration(str_stream);
@@ -317,6 +342,7 @@ public:
     I_MainLoop::Routine       first_connect_cef_routine = nullptr;
     I_MainLoop::Routine       connect_syslog_routine = nullptr;
     I_MainLoop::Routine       connect_cef_routine = nullptr;
+    I_MainLoop::Routine       flush_log_file_routine = nullptr;
     StrictMock<MockShellCmd>  mock_shell_cmd;
     bool                      is_domain;
 
@@ -821,6 +847,52 @@ TEST_F(LogTest, FogBulkLogs)
     EXPECT_EQ(local_body, str1);
 }
 
+// Stands in for the receiving side of the logs, which decompresses the bulk before parsing it
+static string
+decompressLogBulk(const string &compressed_logs)
+{
+    auto compression_stream = initCompressionStream();
+    DecompressionResult result = decompressData(
+        compression_stream,
+        compressed_logs.size(),
+        reinterpret_cast<const unsigned char *>(compressed_logs.data())
+    );
+    finiCompressionStream(compression_stream);
+    if (!result.ok) return "";
+
+    string logs(reinterpret_cast<const char *>(result.output), result.num_output_bytes);
+    free(result.output);
+    return logs;
+}
+
+TEST_F(LogTest, CompressedFogBulkLogs)
+{
+    loadFakeConfiguration(true);
+    string plain_body;
+    EXPECT_CALL(mock_msg, sendAsyncMessage(_, _, _, MessageCategory::LOG, _, _))
+        .WillOnce(SaveArg<2>(&plain_body));
+
+    LogGen("Install policy", Audience::INTERNAL, Severity::INFO, Priority::LOW, Tags::POLICY_INSTALLATION);
+    bulk_routine();
+
+    loadFakeConfiguration(true, false, "", -1, true);
+    string compressed_body;
+    MessageMetadata compressed_md;
+    EXPECT_CALL(mock_msg, sendAsyncMessage(_, _, _, MessageCategory::LOG, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&compressed_body), SaveArg<4>(&compressed_md)));
+
+    LogGen("Install policy", Audience::INTERNAL, Severity::INFO, Priority::LOW, Tags::POLICY_INSTALLATION);
+    bulk_routine();
+
+    EXPECT_THAT(compressed_md.getHeaders(), Contains(Pair("Content-Encoding", "gzip")));
+    EXPECT_LT(compressed_body.size(), plain_body.size());
+
+    string received_body = decompressLogBulk(compressed_body);
+    EXPECT_THAT(received_body, HasSubstr("\"eventName\": \"Install policy\""));
+    // The log index is the only difference between the two logs
+    EXPECT_EQ(received_body.size(), plain_body.size());
+}
+
 TEST_F(LogTest, OfflineK8sSvcTest)
 {
     i_agent_details->setOrchestrationMode(OrchestrationMode::HYBRID);
@@ -958,13 +1030,155 @@ TEST_F(LogTest, metrics_check)
         "    \"logQueueAvgSizeSample\": 4.0,\n"
         "    \"logQueueCurrentSizeSample\": 1,\n"
         "    \"sentLogsSum\": 7,\n"
-        "    \"sentLogsBulksSum\": 3\n"
+        "    \"sentLogsBulksSum\": 3,\n"
+        "    \"droppedLogsSum\": 0\n"
         "}";
 
     EXPECT_THAT(AllMetricEvent().performNamedQuery(), ElementsAre(Pair("Logging data", logging_metric_str)));
     EXPECT_THAT(AllMetricEvent().query(), ElementsAre(logging_metric_str));
 }
 
+TEST_F(LogTest, LogsAreDeliveredByTheirOwnRoutine)
+{
+    loadFakeConfiguration(false);
+
+    I_MainLoop::Routine delivery_routine = nullptr;
+    EXPECT_CALL(mock_mainloop, addOneTimeRoutine(_, _, "Logging stream delivery", _))
+        .WillOnce(DoAll(SaveArg<1>(&delivery_routine), Return(0)));
+
+    LogGen(
+        "Install policy",
+        Audience::INTERNAL,
+        Severity::INFO,
+        Priority::LOW,
+        Tags::POLICY_INSTALLATION,
+        ReportIS::StreamType::JSON_DEBUG
+    );
+    LogGen(
+        "Remove policy",
+        Audience::INTERNAL,
+        Severity::INFO,
+        Priority::LOW,
+        Tags::POLICY_INSTALLATION,
+        ReportIS::StreamType::JSON_DEBUG
+    );
+    EXPECT_THAT(getMessages(), Not(HasSubstr("policy")));
+
+    ASSERT_NE(delivery_routine, nullptr);
+    delivery_routine();
+    string messages = getMessages();
+    EXPECT_THAT(messages, HasSubstr("Install policy"));
+    EXPECT_THAT(messages, HasSubstr("Remove policy"));
+}
+
+TEST_F(LogTest, StreamLogQueuePrefersSecurityEvents)
+{
+    auto makeLog =
+        [] (const string &title, Audience audience)
+        {
+            return make_shared<const Report>(
+                title,
+                chrono::microseconds(0),
+                Type::EVENT,
+                Level::LOG,
+                LogLevel::INFO,
+                audience,
+                AudienceTeam::AGENT_CORE,
+                Severity::INFO,
+                Priority::LOW,
+                chrono::seconds(0),
+                Tags::POLICY_INSTALLATION
+            );
+        };
+
+    StreamLogQueue queue(2);
+    EXPECT_TRUE(queue.push(makeLog("metric 1", Audience::INTERNAL)));
+    EXPECT_TRUE(queue.push(makeLog("metric 2", Audience::INTERNAL)));
+    EXPECT_FALSE(queue.push(makeLog("metric 3", Audience::INTERNAL)));
+    EXPECT_TRUE(queue.push(makeLog("attack", Audience::SECURITY)));
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.getDroppedLogs(), 2u);
+
+    EXPECT_THAT(queue.pop()->getSyslog(), HasSubstr("title='attack'"));
+    EXPECT_THAT(queue.pop()->getSyslog(), HasSubstr("title='metric 1'"));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LogTest, RepeatedSecurityEventsAreAggregated)
+{
+    EXPECT_TRUE(loadFakeConfiguration(false, false, "", -1, false, true));
+
+    auto sendAttackLog =
+        [] (const string &source)
+        {
+            LogGen(
+                "Web attack",
+                Audience::SECURITY,
+                Severity::HIGH,
+                Priority::HIGH,
+                Tags::WAF,
+                ReportIS::StreamType::JSON_DEBUG
+            ) << LogField("sourceIP", source);
+        };
+
+    sendAttackLog("1.2.3.4");
+    sendAttackLog("1.2.3.4");
+    sendAttackLog("1.2.3.4");
+    sendAttackLog("5.6.7.8");
+
+    string messages = getMessages();
+    uint sent_logs = 0;
+    for (auto pos = messages.find("Web attack"); pos != string::npos; pos = messages.find("Web attack", pos + 1)) {
+        sent_logs++;
+    }
+    EXPECT_EQ(sent_logs, 2u);
+    EXPECT_THAT(messages, HasSubstr("1.2.3.4"));
+    EXPECT_THAT(messages, HasSubstr("5.6.7.8"));
+}
+
+TEST_F(LogTest, LogAggregatorFoldsEventsOfTheSameKind)
+{
+    auto makeLog =
+        [] (const string &source, Audience audience)
+        {
+            Report log(
+                "Web attack",
+                chrono::microseconds(0),
+                Type::EVENT,
+                Level::LOG,
+                LogLevel::INFO,
+                audience,
+                AudienceTeam::AGENT_CORE,
+                Severity::HIGH,
+                Priority::HIGH,
+                chrono::seconds(0),
+                Tags::WAF
+            );
+            log << LogField("sourceIP", source);
+            return log;
+        };
+
+    LogAggregator aggregator;
+    chrono::seconds window(10);
+    EXPECT_FALSE(aggregator.fold(makeLog("1.2.3.4", Audience::SECURITY), chrono::seconds(1), window));
+    EXPECT_TRUE(aggregator.fold(makeLog("1.2.3.4", Audience::SECURITY), chrono::seconds(2), window));
+    EXPECT_TRUE(aggregator.fold(makeLog("1.2.3.4", Audience::SECURITY), chrono::seconds(3), window));
+    EXPECT_FALSE(aggregator.fold(makeLog("5.6.7.8", Audience::SECURITY), chrono::seconds(4), window));
+    EXPECT_FALSE(aggregator.fold(makeLog("1.2.3.4", Audience::INTERNAL), chrono::seconds(5), window));
+
+    EXPECT_THAT(aggregator.popEndedWindows(chrono::seconds(10)), IsEmpty());
+    auto aggregated_logs = aggregator.popEndedWindows(chrono::seconds(11));
+    ASSERT_EQ(aggregated_logs.size(), 1u);
+    EXPECT_EQ(aggregated_logs[0].getStringData("sourceIP").unpack(), "1.2.3.4");
+    EXPECT_EQ(aggregated_logs[0].getStringData("aggregatedEventsCount").unpack(), "2");
+    EXPECT_EQ(aggregated_logs[0].getStringData("firstAggregatedEventTime").unpack(), "0:0:0");
+
+    // The window of the first source ended, so its next event opens a new one
+    EXPECT_FALSE(aggregator.fold(makeLog("1.2.3.4", Audience::SECURITY), chrono::seconds(12), window));
+    EXPECT_TRUE(aggregator.fold(makeLog("5.6.7.8", Audience::SECURITY), chrono::seconds(13), window));
+    EXPECT_THAT(aggregator.popAllWindows(), SizeIs(1));
+}
+
 TEST_F(LogTest, DeleteStreamTest)
 {
     loadFakeConfiguration(false);
@@ -1094,6 +1308,30 @@ TEST_F(LogTest, ShouldRetryAfterFailedWriteToFile)
     );
 }
 
+TEST_F(LogTest, SingleLineLogsAreFlushedInBatches)
+{
+    loadFakeConfiguration(false);
+
+    LogGen(
+        "Install policy",
+        Audience::INTERNAL,
+        Severity::INFO,
+        Priority::LOW,
+        Tags::POLICY_INSTALLATION,
+        Tags::ACCESS_CONTROL
+    );
+
+    ifstream unflushed_file(output_filename);
+    stringstream unflushed_logs;
+    unflushed_logs << unflushed_file.rdbuf();
+    EXPECT_EQ(unflushed_logs.str(), "");
+
+    string logs = readLogFile();
+    EXPECT_THAT(logs, StartsWith("{\"eventTime\": \"0:0:0\",\"eventName\": \"Install policy\",\"eventSeverity\": "));
+    EXPECT_THAT(logs, EndsWith("\"eventData\": {\"logIndex\": 1}}\n"));
+    EXPECT_EQ(count(logs.begin(), logs.end(), '\n'), 1);
+}
+
 TEST_F(LogTest, automaticly_added_fields)
 {
     using Log = EnvKeyAttr::LogSection;
@@ -1173,6 +1411,14 @@ TEST(LogTestInstanceAwareness, LogGenInstanceAwareness)
     EXPECT_CALL(mock_socket_is, closeSocket(_)).Times(AnyNumber());
     EXPECT_CALL(mock_mainloop, doesRoutineExist(_)).WillRepeatedly(Return(true));
     EXPECT_CALL(mock_mainloop, stop(_)).Times(AnyNumber());
+    I_MainLoop::Routine flush_log_file_routine = nullptr;
+    EXPECT_CALL(
+        mock_mainloop,
+        addRecurringRoutine(_, _, _, "Flushing the log file", _)
+    ).WillOnce(DoAll(SaveArg<2>(&flush_log_file_routine), Return(1)));
+    EXPECT_CALL(mock_mainloop, addOneTimeRoutine(_, _, "Logging stream delivery", _)).WillRepeatedly(
+        DoAll(InvokeArgument<1>(), Return(2))
+    );
 
     EXPECT_CALL(mock_timer, getWalltimeStr(_)).WillRepeatedly(Return("0:0:0"));
     EXPECT_CALL(mock_timer, getWalltime()).WillRepeatedly(
@@ -1249,6 +1495,8 @@ TEST(LogTestInstanceAwareness, LogGenInstanceAwareness)
             Enreachments::BEAUTIFY_OUTPUT
         );
     }
+    ASSERT_NE(flush_log_file_routine, nullptr);
+    flush_log_file_routine();
     ifstream text_file(new_output_filename);
     EXPECT_TRUE(text_file.is_open());
     stringstream buffer;
@@ -1575,21 +1823,11 @@ TEST_F(LogTest, SysLogWriteFailTest)
     ASSERT_NE(connect_syslog_routine, nullptr);
     connect_syslog_routine();
 
-    EXPECT_CALL(mock_socket_is, writeData(1, _))
-        .WillOnce(Return(false))
-        .WillOnce(Return(false))
-        .WillOnce(Return(false))
-        .WillRepeatedly(
-            WithArg<1>(
-                Invoke(
-                    [this](const vector<char> &data)
-                    {
-                        capture_syslog_cef_data.emplace_back(data.begin(), data.end());
-                        return true;
-                    }
-                )
-            )
-        );
+    EXPECT_CALL(mock_socket_is, writeMessages(1, _))
+        .WillOnce(Return(0))
+        .WillOnce(Return(0))
+        .WillOnce(Return(0))
+        .WillRepeatedly(WithArg<1>(Invoke(this, &LogTest::captureSyslogCefMessages)));
 
     syslog_stream.sendLog(CreateReport(tag1, tag2));
     ASSERT_NE(sysog_routine, nullptr);
@@ -1604,6 +1842,37 @@ TEST_F(LogTest, SysLogWriteFailTest)
     }
 }
 
+TEST_F(LogTest, QueuedSyslogLogsAreSentInOneBatch)
+{
+    loadFakeConfiguration(false);
+    capture_syslog_cef_data.clear();
+    Tags tag1 = Tags::POLICY_INSTALLATION;
+    Tags tag2 = Tags::ACCESS_CONTROL;
+    SyslogStream syslog_stream("172.28.1.6", 514, I_Socket::SocketType::TCP);
+
+    syslog_stream.sendLog(CreateReport(tag1, tag2));
+    syslog_stream.sendLog(CreateReport(tag1, tag2));
+    ASSERT_NE(sysog_routine, nullptr);
+    sysog_routine();
+    EXPECT_TRUE(capture_syslog_cef_data.empty());
+
+    ASSERT_NE(connect_syslog_routine, nullptr);
+    connect_syslog_routine();
+    syslog_stream.sendLog(CreateReport(tag1, tag2));
+
+    EXPECT_CALL(mock_socket_is, writeMessages(1, SizeIs(3)))
+        .WillOnce(WithArg<1>(Invoke(this, &LogTest::captureSyslogCefMessages)));
+    sysog_routine();
+
+    ASSERT_EQ(capture_syslog_cef_data.size(), 3u);
+    for (const string &log : capture_syslog_cef_data) {
+        auto length_end = log.find(' ');
+        ASSERT_NE(length_end, string::npos);
+        EXPECT_EQ(log.substr(0, length_end), to_string(log.size() - length_end - 1));
+        EXPECT_THAT(log, HasSubstr("<133>1"));
+    }
+}
+
 TEST_F(LogTest, CefWriteFailTest)
 {
     loadFakeConfiguration(false);
@@ -1622,21 +1891,11 @@ TEST_F(LogTest, CefWriteFailTest)
     ASSERT_NE(connect_cef_routine, nullptr);
     connect_cef_routine();
 
-    EXPECT_CALL(mock_socket_is, writeData(1, _))
-        .WillOnce(Return(false))
-        .WillOnce(Return(false))
-        .WillOnce(Return(false))
-        .WillRepeatedly(
-            WithArg<1>(
-                Invoke(
-                    [this](const vector<char> &data)
-                    {
-                        capture_syslog_cef_data.emplace_back(data.begin(), data.end());
-                        return true;
-                    }
-                )
-            )
-        );
+    EXPECT_CALL(mock_socket_is, writeMessages(1, _))
+        .WillOnce(Return(0))
+        .WillOnce(Return(0))
+        .WillOnce(Return(0))
+        .WillRepeatedly(WithArg<1>(Invoke(this, &LogTest::captureSyslogCefMessages)));
     EXPECT_EQ(capture_syslog_cef_data.size(), 0u); //before write
     cef_stream.sendLog(CreateReport(tag1, tag2));
     EXPECT_EQ(capture_syslog_cef_data.size(), 1u);
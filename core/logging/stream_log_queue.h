@@ -0,0 +1,65 @@
+// Copyright (C) 2022 Check Point Software Technologies Ltd. All rights reserved.
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __STREAM_LOG_QUEUE_H__
+#define __STREAM_LOG_QUEUE_H__
+
+#include <deque>
+#include <memory>
+
+#include "report/report.h"
+
+// Logs that wait to be delivered to a single stream.
+// Security events are delivered before the rest of the logs. Once the queue is full, a new log takes the place of
+// the newest log of a lower priority if there is one, and is dropped otherwise.
+class StreamLogQueue
+{
+public:
+    StreamLogQueue(uint _capacity) : capacity(_capacity) {}
+
+    bool
+    push(const std::shared_ptr<const Report> &log)
+    {
+        bool is_security_event = log->isSecurityEvent();
+        if (size() >= capacity) {
+            dropped_logs++;
+            if (!is_security_event || other_logs.empty()) return false;
+            other_logs.pop_back();
+        }
+
+        (is_security_event ? security_logs : other_logs).push_back(log);
+        return true;
+    }
+
+    std::shared_ptr<const Report>
+    pop()
+    {
+        auto &logs = security_logs.empty() ? other_logs : security_logs;
+        auto log = logs.front();
+        logs.pop_front();
+        return log;
+    }
+
+    bool empty() const { return security_logs.empty() && other_logs.empty(); }
+    size_t size() const { return security_logs.size() + other_logs.size(); }
+    void setCapacity(uint new_capacity) { capacity = new_capacity; }
+    uint64_t getDroppedLogs() const { return dropped_logs; }
+
+private:
+    std::deque<std::shared_ptr<const Report>> security_logs;
+    std::deque<std::shared_ptr<const Report>> other_logs;
+    uint capacity;
+    uint64_t dropped_logs = 0;
+};
+
+#endif // __STREAM_LOG_QUEUE_H__
@@ -48,26 +48,29 @@ SyslogStream::~SyslogStream()
 void
 SyslogStream::sendLog(const Report &log)
 {
-    string syslog_report = log.getSyslog();
-    if (protocol == I_Socket::SocketType::TCP) {
-        syslog_report = to_string(syslog_report.length()) + " " + syslog_report;
-    }
-    vector<char> data(syslog_report.begin(), syslog_report.end());
+    addLogToQueue(log.getSyslog());
+    if (is_log_send_scheduled) return;
+
+    is_log_send_scheduled = true;
     log_send_routine = mainloop->addOneTimeRoutine(
         I_MainLoop::RoutineType::Offline,
-        [this, data] () { sendLogData(data); },
+        [this] () { sendQueuedLogs(); },
         "Logging Syslog stream messaging"
     );
 }
 
 void
-SyslogStream::sendLogData(const vector<char> &data)
+SyslogStream::sendQueuedLogs()
 {
-    dbgTrace(D_REPORT) << "Sending Syslog log." << " Max logs per send: " << max_logs_per_send;
-    sendLogWithQueue(data);
+    is_log_send_scheduled = false;
+    dbgTrace(D_REPORT) << "Sending Syslog logs." << " Max logs per send: " << max_logs_per_send;
+    if (!socket.ok()) {
+        dbgTrace(D_REPORT) << "Socket not ok, keeping the logs in the queue until the connection is established.";
+        return;
+    }
+    while (hasQueuedLogs() && writeQueuedLogs()) {}
 }
 
-
 void
 SyslogStream::init() {
     updateSettings();
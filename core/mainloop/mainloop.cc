@@ -35,6 +35,7 @@ using namespace std;
 USE_DEBUG_FLAG(D_MAINLOOP);
 
 bool fini_signal_flag = false;
+atomic<const char *> mainloop_running_routine(nullptr);
 
 static const AlertInfo alert(AlertTeam::CORE, "mainloop i/s");
 
@@ -301,6 +302,7 @@ MainloopComponent::Impl::run()
                     "Starting execution of corutine. Routine named: " <<
                     curr_iter->second.getRoutineName();
 
+                mainloop_running_routine.store(curr_iter->second.getRoutineName().c_str(), memory_order_relaxed);
                 try {
                     curr_iter->second.run();
                 } catch (const exception &e) {
@@ -317,6 +319,7 @@ MainloopComponent::Impl::run()
                         + curr_iter->second.getRoutineName()
                         + "'";
                 }
+                mainloop_running_routine.store(nullptr, memory_order_relaxed);
 
                 if (error != "") {
                     cerr << error << endl;
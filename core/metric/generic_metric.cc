@@ -66,6 +66,18 @@ static const set<string> default_metrics = {
     "preventEngineMatchesSample",
     "detectEngineMatchesSample",
     "ignoreEngineMatchesSample",
+    "pmScansSample",
+    "pmBytesScannedSample",
+    "pmScanTimeMicroSecondsSample",
+    "pmMaxScanTimeMicroSecondsSample",
+    "ipsSignatureSampledEvaluationsSample",
+    "ipsSignatureSampledMatchesSample",
+    "ipsSignatureCpuTimeMicroSecondsSample",
+    "tableExpiredEntriesSum",
+    "tableMaxExpiredEntriesPerTickSample",
+    "tableAvgExpiredEntriesPerTickSample",
+    "tableMaxExpirationLatencyMilliSecondsSample",
+    "tableAvgExpirationLatencyMilliSecondsSample",
     "cpuMaxSample",
     "cpuAvgSample",
     "cpuSample",
@@ -111,6 +123,7 @@ MetricCalc::getMetadata(const string &key) const
 void
 MetricCalc::setMetadata(const string &key, const string &value)
 {
+    is_prometheus_series_cached = false;
     if (value.empty()) {
         metadata.erase(key);
     } else {
@@ -155,8 +168,8 @@ MetricCalc::getPrometheusMetrics(const std::string &metric_name, const string &a
     return {res};
 }
 
-map<string, string>
-MetricCalc::getBasicLabels(const string &metric_name, const string &asset_id) const
+static map<string, string>
+getPrometheusBasicLabels(const string &metric_name, const string &asset_id)
 {
     map<string, string> res;
 
@@ -177,6 +190,140 @@ MetricCalc::getBasicLabels(const string &metric_name, const string &asset_id) co
     return res;
 }
 
+map<string, string>
+MetricCalc::getBasicLabels(const string &metric_name, const string &asset_id) const
+{
+    return getPrometheusBasicLabels(metric_name, asset_id);
+}
+
+void
+MetricCalc::renderPrometheus(PrometheusExposition &exposition, const string &name, string &labels) const
+{
+    float value = getValue();
+    if (isnan(value)) return;
+
+    cachePrometheusSeries();
+    exposition.addSample(name, getMetricType(), prometheus_description, labels, value);
+}
+
+const string &
+MetricCalc::getPrometheusName() const
+{
+    cachePrometheusSeries();
+    return prometheus_name;
+}
+
+const string &
+MetricCalc::getPrometheusDescription() const
+{
+    cachePrometheusSeries();
+    return prometheus_description;
+}
+
+bool
+MetricCalc::isDefaultPrometheusMetric() const
+{
+    cachePrometheusSeries();
+    return is_default_prometheus_metric;
+}
+
+void
+MetricCalc::cachePrometheusSeries() const
+{
+    if (is_prometheus_series_cached) return;
+
+    string name = getMetricDotName() != "" ? getMetricDotName() : getMetricName();
+    is_default_prometheus_metric = default_metrics.find(name) != default_metrics.end();
+
+    // Prometheus metric names are made of letters, digits, underscores and colons only
+    prometheus_name.clear();
+    for (char ch : name) {
+        prometheus_name += isalnum(static_cast<unsigned char>(ch)) || ch == ':' ? ch : '_';
+    }
+    if (!prometheus_name.empty() && isdigit(static_cast<unsigned char>(prometheus_name[0]))) {
+        prometheus_name.insert(0, "_");
+    }
+    prometheus_description = getMetircDescription();
+    is_prometheus_series_cached = true;
+}
+
+static void
+appendEscaped(string &out, const string &value, bool is_label_value)
+{
+    for (char ch : value) {
+        if (ch == '\\') {
+            out += "\\\\";
+        } else if (ch == '\n') {
+            out += "\\n";
+        } else if (ch == '"' && is_label_value) {
+            out += "\\\"";
+        } else {
+            out += ch;
+        }
+    }
+}
+
+void
+PrometheusExposition::appendLabel(string &labels, const string &name, const string &value)
+{
+    if (!labels.empty()) labels += ',';
+    labels += name;
+    labels += "=\"";
+    appendEscaped(labels, value, true);
+    labels += '"';
+}
+
+void
+PrometheusExposition::addSample(
+    const string &name,
+    MetricType type,
+    const string &description,
+    const string &labels,
+    float value)
+{
+    auto family = families.find(name);
+    if (family == families.end()) family = families.emplace(name, Family()).first;
+
+    if (family->second.samples.empty()) {
+        family->second.type = type;
+        family->second.description = description;
+    }
+
+    auto &samples = family->second.samples;
+    samples += name;
+    if (!labels.empty()) {
+        samples += '{';
+        samples += labels;
+        samples += '}';
+    }
+    char value_str[32];
+    int value_length = snprintf(value_str, sizeof(value_str), " %g\n", value);
+    samples.append(value_str, value_length);
+}
+
+const string &
+PrometheusExposition::render()
+{
+    exposition.clear();
+    for (auto &family : families) {
+        if (family.second.samples.empty()) continue;
+
+        if (!family.second.description.empty()) {
+            exposition += "# HELP ";
+            exposition += family.first;
+            exposition += ' ';
+            appendEscaped(exposition, family.second.description, false);
+            exposition += '\n';
+        }
+        exposition += "# TYPE ";
+        exposition += family.first;
+        exposition += family.second.type == MetricType::GAUGE ? " gauge\n" : " counter\n";
+        exposition += family.second.samples;
+        family.second.samples.clear();
+    }
+    return exposition;
+}
+
 static const string metric_file = "/tmp/metrics_output.txt";
 
 class GenericMetric::MetricsRest : public ServerRest
@@ -249,6 +396,7 @@ GenericMetric::init(
 void
 GenericMetric::handleMetricStreamSending()
 {
+    updateMetrics();
     if (active_streams.isSet(Stream::DEBUG)) generateDebug();
     if (active_streams.isSet(Stream::FOG)) generateLog();
     if (active_streams.isSet(Stream::AIOPS)) generateAiopsLog();
@@ -301,6 +449,7 @@ GenericMetric::addCalc(MetricCalc *calc)
 void
 GenericMetric::upon(const AllMetricEvent &event)
 {
+    updateMetrics();
     dbgTrace(D_METRICS) << generateReport();
     if (event.getReset()) resetMetrics();
 }
@@ -308,6 +457,7 @@ GenericMetric::upon(const AllMetricEvent &event)
 string
 GenericMetric::respond(const AllMetricEvent &event)
 {
+    updateMetrics();
     auto res = generateReport();
     if (event.getReset()) resetMetrics();
     return res;
@@ -316,6 +466,7 @@ GenericMetric::respond(const AllMetricEvent &event)
 vector<PrometheusData>
 GenericMetric::respond(const MetricScrapeEvent &)
 {
+    updateMetrics();
     bool enable_all_metrics = getProfileAgentSettingWithDefault<bool>(false, "enable_all_metrics");
     if (enable_all_metrics) {
         dbgTrace(D_METRICS) << "Sensitive metrics enabled, returning all metrics";
@@ -334,6 +485,32 @@ GenericMetric::respond(const MetricScrapeEvent &)
     return getPromMetricsData(&allowed_calcs);
 }
 
+void
+GenericMetric::upon(const MetricExpositionEvent &event)
+{
+    updateMetrics();
+    auto &labels = getPrometheusLabels();
+    for (auto &calc : prometheus_calcs) {
+        if (!event.areAllMetricsEnabled() && !calc->isDefaultPrometheusMetric()) continue;
+        calc->renderPrometheus(event.getExposition(), calc->getPrometheusName(), labels);
+    }
+}
+
+string &
+GenericMetric::getPrometheusLabels()
+{
+    // The labels of a metric only change when the agent registers and gets its ID
+    auto agent_id = Singleton::Consume<I_AgentDetails>::by<GenericMetric>()->getAgentId();
+    if (!prometheus_labels.empty() && agent_id == prometheus_labels_agent_id) return prometheus_labels;
+
+    prometheus_labels.clear();
+    for (auto &label : getPrometheusBasicLabels(metric_name, asset_id)) {
+        PrometheusExposition::appendLabel(prometheus_labels, label.first, label.second);
+    }
+    prometheus_labels_agent_id = agent_id;
+    return prometheus_labels;
+}
+
 string GenericMetric::getListenerName() const { return metric_name; }
 
 void
@@ -396,21 +573,21 @@ GenericMetric::generateLog()
     sendLog(metric_client_rest);
 }
 
+bool
+GenericMetric::isPrometheusEnabled()
+{
+    auto prometheus_settings = getProfileAgentSetting<bool>("prometheus");
+    if (prometheus_settings.ok()) return prometheus_settings.unpack();
+
+    const char *prometheus_env = getenv("PROMETHEUS");
+    return prometheus_env != nullptr && string(prometheus_env) == "true";
+}
+
 vector<PrometheusData>
 GenericMetric::getPromMetricsData(const vector<MetricCalc*> *allowed_calcs)
 {
     vector<PrometheusData> all_metrics;
-    bool enable_prometheus = false;
-    auto prometheus_settings = getProfileAgentSetting<bool>("prometheus");
-    if (prometheus_settings.ok()) {
-        enable_prometheus = prometheus_settings.unpack();
-    } else {
-        const char *prometheus_env = getenv("PROMETHEUS");
-        if (prometheus_env != nullptr) {
-            enable_prometheus = string(prometheus_env) == "true";
-        }
-    }
-    if (!enable_prometheus) return all_metrics;
+    if (!isPrometheusEnabled()) return all_metrics;
     dbgTrace(D_METRICS) << "Get prometheus metrics";
 
     const vector<MetricCalc*> &calcs_to_use = allowed_calcs ? *allowed_calcs : prometheus_calcs;
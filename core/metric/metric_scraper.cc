@@ -1,5 +1,7 @@
 #include "metric/metric_scraper.h"
 
+#include "config.h"
+
 using namespace std;
 
 USE_DEBUG_FLAG(D_METRICS);
@@ -14,6 +16,10 @@ public:
             "service-metrics",
             [&] () { return getAllPrometheusMetrics(); }
         );
+        Singleton::Consume<I_RestApi>::by<MetricScraper>()->addGetCall(
+            "prometheus-metrics",
+            [&] () { return getPrometheusExposition(); }
+        );
     }
 
     string
@@ -35,8 +41,21 @@ public:
         return ss.str();
     }
 
+    // Unlike `getAllPrometheusMetrics`, the metrics are rendered in the Prometheus text format by the process itself,
+    // and reading them doesn't reset them
+    string
+    getPrometheusExposition()
+    {
+        if (!GenericMetric::isPrometheusEnabled()) return "";
+
+        bool are_all_metrics_enabled = getProfileAgentSettingWithDefault<bool>(false, "enable_all_metrics");
+        MetricExpositionEvent(exposition, are_all_metrics_enabled).notify();
+        return exposition.render();
+    }
+
 private:
     vector<PrometheusData> all_metrics;
+    PrometheusExposition exposition;
 };
 
 MetricScraper::MetricScraper() : Component("MetricScraper"), pimpl(make_unique<MetricScraper::Impl>()) {}
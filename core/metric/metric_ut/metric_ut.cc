@@ -1,5 +1,7 @@
 #include "generic_metric.h"
 
+#include <thread>
+
 #include "cptest.h"
 #include "metric/all_metric_event.h"
 #include "event.h"
@@ -33,6 +35,53 @@ TEST(BaseMetric, generic_metadata)
     EXPECT_EQ(test.getMetircDescription(), "CPU utilization percentage");
 }
 
+TEST(BaseMetric, sharded_counter_sums_all_threads)
+{
+    ShardedCounter requests(nullptr, "requestsSum");
+
+    vector<thread> workers;
+    for (uint worker = 0; worker < 20; worker++) {
+        workers.emplace_back([&requests] () { for (uint i = 0; i < 1000; i++) requests.report(1); });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    requests.report(5);
+
+    EXPECT_EQ(requests.getCounter(), 20005u);
+    EXPECT_EQ(requests.getValue(), 20005.0);
+
+    requests.reset();
+    EXPECT_EQ(requests.getCounter(), 0u);
+}
+
+TEST(BaseMetric, latency_histogram_percentiles)
+{
+    LatencyHistogram latency(nullptr, "latency", "microseconds"_unit);
+    EXPECT_EQ(latency.getPercentile(99), 0u);
+
+    for (uint i = 1; i <= 1000; i++) {
+        latency.report(microseconds(i));
+    }
+
+    EXPECT_EQ(latency.getCount(), 1000u);
+    // Every value is reported at most 1/32 above the real one, and never above the highest latency seen
+    EXPECT_THAT(latency.getPercentile(50), AllOf(Ge(500u), Le(516u)));
+    EXPECT_THAT(latency.getPercentile(99), AllOf(Ge(990u), Le(1000u)));
+    EXPECT_EQ(latency.getPercentile(99.9), 1000u);
+
+    latency.reset();
+    for (uint i = 0; i < 10; i++) {
+        latency.report(i < 9 ? 20 : 40);
+    }
+    // Small latencies are kept exactly
+    EXPECT_EQ(latency.getPercentile(50), 20u);
+    EXPECT_EQ(latency.getPercentile(99), 40u);
+
+    latency.report(hours(100));
+    EXPECT_EQ(latency.getPercentile(100), (uint64_t(1) << 36) - 1);
+}
+
 class CPUEvent : public Event<CPUEvent>
 {
 public:
@@ -186,6 +235,15 @@ private:
     };
 };
 
+class StageLatencyMetric : public GenericMetric
+{
+public:
+    void report(const string &stage, uint64_t latency) { stages.report(stage, latency); }
+
+private:
+    MetricMap<string, LatencyHistogram> stages{LatencyHistogram{nullptr, ""}, this, "stage", "stageLatency"};
+};
+
 class MetricTest : public Test
 {
 public:
@@ -539,6 +597,7 @@ TEST_F(MetricTest, getPromeathusMetric)
     MetricScraper metric_scraper;
     function<string()> get_metrics_func;
     EXPECT_CALL(rest, addGetCall("service-metrics", _)).WillOnce(DoAll(SaveArg<1>(&get_metrics_func), Return(true)));
+    EXPECT_CALL(rest, addGetCall("prometheus-metrics", _)).WillOnce(Return(true));
     metric_scraper.init();
 
     stringstream configuration;
@@ -638,6 +697,7 @@ TEST_F(MetricTest, getPromeathusMultiMap)
     MetricScraper metric_scraper;
     function<string()> get_metrics_func;
     EXPECT_CALL(rest, addGetCall("service-metrics", _)).WillOnce(DoAll(SaveArg<1>(&get_metrics_func), Return(true)));
+    EXPECT_CALL(rest, addGetCall("prometheus-metrics", _)).WillOnce(Return(true));
     metric_scraper.init();
 
     stringstream configuration;
@@ -702,11 +762,105 @@ TEST_F(MetricTest, getPromeathusMultiMap)
     EXPECT_EQ(message_body, res);
 }
 
+TEST_F(MetricTest, getPrometheusExposition)
+{
+    MetricScraper metric_scraper;
+    function<string()> get_exposition_func;
+    EXPECT_CALL(rest, addGetCall("service-metrics", _)).WillOnce(Return(true));
+    EXPECT_CALL(rest, addGetCall("prometheus-metrics", _))
+        .WillOnce(DoAll(SaveArg<1>(&get_exposition_func), Return(true)));
+    metric_scraper.init();
+
+    EXPECT_EQ(get_exposition_func(), "");
+
+    stringstream configuration;
+    configuration << "{\"agentSettings\":[{\"key\":\"prometheus\",\"id\":\"id1\",\"value\":\"true\"},";
+    configuration << "{\"key\":\"enable_all_metrics\",\"id\":\"id2\",\"value\":\"true\"}]}\n";
+
+    EXPECT_TRUE(Singleton::Consume<Config::I_Config>::from(conf)->loadConfiguration(configuration));
+
+    UrlMetric2 metric;
+    metric.init(
+        "Bytes per URL",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        seconds(5),
+        true,
+        ReportIS::Audience::INTERNAL,
+        false,
+        "asset id"
+    );
+    metric.registerListener();
+
+    HttpTransaction("/index.html", "GET", 10).notify();
+    HttpTransaction("/index2.html", "GET", 20).notify();
+    HttpTransaction("/index.html", "POST", 40).notify();
+
+    string res =
+        "# TYPE request_total counter\n"
+        "request_total{agent=\"Unknown\",assetId=\"asset id\",id=\"87\",metricName=\"Bytes per URL\","
+            "url=\"/index.html\",method=\"GET\"} 1\n"
+        "request_total{agent=\"Unknown\",assetId=\"asset id\",id=\"87\",metricName=\"Bytes per URL\","
+            "url=\"/index.html\",method=\"POST\"} 1\n"
+        "request_total{agent=\"Unknown\",assetId=\"asset id\",id=\"87\",metricName=\"Bytes per URL\","
+            "url=\"/index2.html\",method=\"GET\"} 1\n";
+
+    EXPECT_EQ(get_exposition_func(), res);
+    // Rendering the exposition doesn't reset the metrics
+    EXPECT_EQ(get_exposition_func(), res);
+}
+
+TEST_F(MetricTest, latencyHistogramExposition)
+{
+    MetricScraper metric_scraper;
+    function<string()> get_exposition_func;
+    EXPECT_CALL(rest, addGetCall("service-metrics", _)).WillOnce(Return(true));
+    EXPECT_CALL(rest, addGetCall("prometheus-metrics", _))
+        .WillOnce(DoAll(SaveArg<1>(&get_exposition_func), Return(true)));
+    metric_scraper.init();
+
+    stringstream configuration;
+    configuration << "{\"agentSettings\":[{\"key\":\"prometheus\",\"id\":\"id1\",\"value\":\"true\"},";
+    configuration << "{\"key\":\"enable_all_metrics\",\"id\":\"id2\",\"value\":\"true\"}]}\n";
+    EXPECT_TRUE(Singleton::Consume<Config::I_Config>::from(conf)->loadConfiguration(configuration));
+
+    StageLatencyMetric metric;
+    metric.init(
+        "Stage latency",
+        ReportIS::AudienceTeam::AGENT_CORE,
+        ReportIS::IssuingEngine::AGENT_CORE,
+        seconds(5),
+        true
+    );
+    for (uint i = 0; i < 100; i++) {
+        metric.report("parse", i < 99 ? 10 : 2000);
+    }
+
+    string res =
+        "# TYPE stageLatency gauge\n"
+        "stageLatency{agent=\"Unknown\",id=\"87\",metricName=\"Stage latency\",stage=\"parse\",quantile=\"0.5\"} 10\n"
+        "stageLatency{agent=\"Unknown\",id=\"87\",metricName=\"Stage latency\",stage=\"parse\",quantile=\"0.99\"} 10\n"
+        "stageLatency{agent=\"Unknown\",id=\"87\",metricName=\"Stage latency\",stage=\"parse\","
+            "quantile=\"0.999\"} 2000\n";
+    EXPECT_EQ(get_exposition_func(), res);
+
+
+    LatencyHistogram latency(nullptr, "latency", "microseconds"_unit);
+    EXPECT_TRUE(latency.getAiopsMetrics().empty());
+    latency.report(2000);
+    auto aiops_metrics = latency.getAiopsMetrics();
+    ASSERT_EQ(aiops_metrics.size(), 3u);
+    EXPECT_THAT(aiops_metrics[2].toString(), HasSubstr("\"MetricValue\": 2000.0"));
+    EXPECT_THAT(aiops_metrics[2].toString(), HasSubstr("\"MetricUnit\": \"microseconds\""));
+    EXPECT_THAT(aiops_metrics[2].toString(), HasSubstr("\"quantile\": \"0.999\""));
+}
+
 TEST_F(MetricTest, getPromeathusTwoMetrics)
 {
     MetricScraper metric_scraper;
     function<string()> get_metrics_func;
     EXPECT_CALL(rest, addGetCall("service-metrics", _)).WillOnce(DoAll(SaveArg<1>(&get_metrics_func), Return(true)));
+    EXPECT_CALL(rest, addGetCall("prometheus-metrics", _)).WillOnce(Return(true));
     metric_scraper.init();
 
     stringstream configuration;
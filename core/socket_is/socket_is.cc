@@ -15,12 +15,14 @@
 
 #include <poll.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <unistd.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <set>
 #include <algorithm>
 #include <sys/stat.h>
@@ -222,6 +224,51 @@ public:
         return true;
     }
 
+    // Stream sockets write the messages back to back with as few gathered writes as possible
+    virtual uint
+    writeMessages(const vector<struct iovec> &messages)
+    {
+        unsent_messages.assign(messages.begin(), messages.end());
+        size_t next_message = 0;
+        bool is_first_iter = true;
+        while (next_message < unsent_messages.size()) {
+            if (!is_first_iter && !is_blocking) {
+                dbgTrace(D_SOCKET)
+                    << "Trying to yield before writing to socket again. Messages written: "
+                    << next_message
+                    << ", Total messages: "
+                    << unsent_messages.size();
+
+                Singleton::Consume<I_MainLoop>::by<SocketIS>()->yield(false);
+            }
+            is_first_iter = false;
+
+            struct msghdr header;
+            memset(&header, 0, sizeof(header));
+            header.msg_iov = unsent_messages.data() + next_message;
+            header.msg_iovlen = min<size_t>(unsent_messages.size() - next_message, IOV_MAX);
+
+            ssize_t res = sendmsg(socket_int, &header, MSG_NOSIGNAL);
+            if (res <= 0) {
+                dbgWarning(D_SOCKET) << "Failed to send messages, Error: " << strerror(errno);
+                return next_message;
+            }
+
+            size_t bytes_left = res;
+            while (next_message < unsent_messages.size() && bytes_left >= unsent_messages[next_message].iov_len) {
+                bytes_left -= unsent_messages[next_message].iov_len;
+                next_message++;
+            }
+            if (bytes_left > 0) {
+                auto &partial_message = unsent_messages[next_message];
+                partial_message.iov_base = static_cast<char *>(partial_message.iov_base) + bytes_left;
+                partial_message.iov_len -= bytes_left;
+            }
+        }
+
+        return next_message;
+    }
+
     bool
     isDataAvailable()
     {
@@ -357,7 +404,39 @@ protected:
     I_MainLoop *i_mainloop = nullptr;
     bool is_error = false;
 
+    // Datagram sockets send every message as a datagram of its own, as many as possible in each system call
+    uint
+    writeDatagrams(const vector<struct iovec> &messages)
+    {
+        message_headers.resize(messages.size());
+        for (size_t index = 0; index < messages.size(); index++) {
+            memset(&message_headers[index], 0, sizeof(struct mmsghdr));
+            message_headers[index].msg_hdr.msg_iov = const_cast<struct iovec *>(&messages[index]);
+            message_headers[index].msg_hdr.msg_iovlen = 1;
+        }
+
+        uint sent_messages = 0;
+        while (sent_messages < messages.size()) {
+            int res = sendmmsg(
+                socket_int,
+                message_headers.data() + sent_messages,
+                messages.size() - sent_messages,
+                MSG_NOSIGNAL
+            );
+            if (res <= 0) {
+                dbgWarning(D_SOCKET) << "Failed to send datagrams, Error: " << strerror(errno);
+                return sent_messages;
+            }
+            sent_messages += res;
+        }
+
+        return sent_messages;
+    }
+
 private:
+    vector<struct iovec> unsent_messages;
+    vector<struct mmsghdr> message_headers;
+
     Maybe<string>
     getAuthorizedIP(
         const struct sockaddr_in &clientaddr,
@@ -626,6 +705,12 @@ public:
         return receiveData(data_size, 0);
     }
 
+    uint
+    writeMessages(const vector<struct iovec> &messages) override
+    {
+        return writeDatagrams(messages);
+    }
+
     void cleanServer() override {}
 
     UDPSocket(bool _is_blocking, bool _is_server_socket)
@@ -824,6 +909,12 @@ public:
         return param_to_read;
     }
 
+    uint
+    writeMessages(const vector<struct iovec> &messages) override
+    {
+        return writeDatagrams(messages);
+    }
+
     UnixDGSocket(bool _is_blocking, bool _is_server_socket)
         :
         SocketInternal(_is_blocking, _is_server_socket)
@@ -852,6 +943,7 @@ public:
     void closeSocket(socketFd &socket_fd) override;
     bool writeData(socketFd socket_fd, const vector<char> &data) override;
     bool writeDataAsync(socketFd socket_fd, const vector<char> &data) override;
+    uint writeMessages(socketFd socket_fd, const vector<struct iovec> &messages) override;
     Maybe<vector<char>> receiveData(socketFd socket_fd, uint data_size, bool is_blocking = true) override;
     bool isDataAvailable(socketFd socket) override;
     bool isError(socketFd socket) override;
@@ -967,6 +1059,18 @@ SocketIS::Impl::writeDataAsync(socketFd socket_fd, const vector<char> &data)
     return sock->second->writeDataAsync(data);
 }
 
+uint
+SocketIS::Impl::writeMessages(socketFd socket_fd, const vector<struct iovec> &messages)
+{
+    auto sock = active_sockets.find(socket_fd);
+    if (sock == active_sockets.end()) {
+        dbgWarning(D_SOCKET) << "The provided socket file descriptor does not exist. Socket FD: " << socket_fd;
+        return 0;
+    }
+
+    return sock->second->writeMessages(messages);
+}
+
 Maybe<vector<char>>
 SocketIS::Impl::receiveData(socketFd socket_fd, uint data_size, bool is_blocking)
 {
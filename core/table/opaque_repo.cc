@@ -12,6 +12,9 @@
 // limitations under the License.
 
 #include "table/opaque_repo.h"
+#include "table/opaque_slot.h"
+
+#include <vector>
 
 void
 TableOpaqueRep::addType(const std::string &name, const Gen &gen, const uint &curr, const uint &min)
@@ -28,3 +31,28 @@ TableOpaqueRep::getOpaqueByName(const std::string &name)
     if (iter == GenRep.end()) return nullptr;
     return (iter->second)();
 }
+
+static std::vector<std::type_index> &
+getSlotTypes()
+{
+    static std::vector<std::type_index> slot_types;
+    return slot_types;
+}
+
+uint
+TableOpaqueSlot::getByType(const std::type_index &index)
+{
+    auto &slot_types = getSlotTypes();
+    for (uint slot = 0; slot < slot_types.size(); slot++) {
+        if (slot_types[slot] == index) return slot;
+    }
+    slot_types.push_back(index);
+    return slot_types.size() - 1;
+}
+
+const char *
+TableOpaqueSlot::getTypeName(uint slot)
+{
+    auto &slot_types = getSlotTypes();
+    return slot < slot_types.size() ? slot_types[slot].name() : "unknown";
+}
@@ -0,0 +1,310 @@
+#include "table.h"
+
+#include <sstream>
+
+#include "cptest.h"
+#include "environment.h"
+#include "config.h"
+#include "config_component.h"
+#include "table_opaque.h"
+#include "mock/mock_mainloop.h"
+#include "mock/mock_time_get.h"
+
+using namespace std;
+using namespace chrono;
+using namespace testing;
+
+class FirstOpaque : public TableOpaqueSerialize<FirstOpaque>
+{
+public:
+    FirstOpaque(int _value = 0) : TableOpaqueSerialize<FirstOpaque>(this), value(_value) {}
+
+    template <typename T>
+    void serialize(T &ar, uint) { ar(value); }
+    static string name() { return "FirstOpaque"; }
+    static unique_ptr<TableOpaqueBase> prototype() { return make_unique<FirstOpaque>(); }
+    static uint currVer() { return 0; }
+    static uint minVer() { return 0; }
+
+    int value;
+};
+
+class SecondOpaque : public TableOpaqueSerialize<SecondOpaque>
+{
+public:
+    SecondOpaque(const string &_value = "") : TableOpaqueSerialize<SecondOpaque>(this), value(_value) {}
+
+    template <typename T>
+    void serialize(T &ar, uint) { ar(value); }
+    static string name() { return "SecondOpaque"; }
+    static unique_ptr<TableOpaqueBase> prototype() { return make_unique<SecondOpaque>(); }
+    static uint currVer() { return 0; }
+    static uint minVer() { return 0; }
+
+    string value;
+};
+
+// Runs a callback when the entry holding it is removed, to act on the table in the middle of a removal
+class RemovalHook : public TableOpaqueSerialize<RemovalHook>
+{
+public:
+    RemovalHook(function<void()> _on_removal = nullptr)
+            :
+        TableOpaqueSerialize<RemovalHook>(this),
+        on_removal(_on_removal)
+    {}
+
+    ~RemovalHook() { if (on_removal) on_removal(); }
+
+    template <typename T>
+    void serialize(T &, uint) {}
+    static string name() { return "RemovalHook"; }
+    static unique_ptr<TableOpaqueBase> prototype() { return make_unique<RemovalHook>(); }
+    static uint currVer() { return 0; }
+    static uint minVer() { return 0; }
+
+private:
+    function<void()> on_removal;
+};
+
+class TableTest : public Test
+{
+public:
+    TableTest()
+    {
+        env.preload();
+        env.init();
+
+        EXPECT_CALL(mock_timer, getMonotonicTime()).WillRepeatedly(InvokeWithoutArgs([this] () { return curr_time; }));
+        EXPECT_CALL(mock_mainloop, addRecurringRoutine(I_MainLoop::RoutineType::System, _, _, _, _))
+            .WillRepeatedly(Return(0));
+        EXPECT_CALL(
+            mock_mainloop,
+            addRecurringRoutine(I_MainLoop::RoutineType::Timer, _, _, "Delete expired table entries", _)
+        ).WillOnce(DoAll(SaveArg<2>(&expiration_routine), Return(0)));
+        table.init();
+    }
+
+    ~TableTest()
+    {
+        table.fini();
+        env.fini();
+    }
+
+    void
+    expireAt(microseconds time)
+    {
+        curr_time = time;
+        expiration_routine();
+    }
+
+    void
+    addRemovalHook(const string &key, function<void()> on_removal)
+    {
+        EXPECT_TRUE(i_table->setActiveKey(key));
+        EXPECT_TRUE(i_table->createState<RemovalHook>(on_removal));
+        i_table->unsetActiveKey();
+    }
+
+    microseconds curr_time{0};
+    I_MainLoop::Routine expiration_routine;
+    NiceMock<MockMainLoop> mock_mainloop;
+    NiceMock<MockTimeGet> mock_timer;
+    ConfigComponent conf;
+    ::Environment env;
+    Table<string> table;
+    I_TableSpecific<string> *i_table = Singleton::Consume<I_TableSpecific<string>>::from(table);
+};
+
+TEST_F(TableTest, opaque_types_get_distinct_slots)
+{
+    uint first_slot = TableOpaqueSlot::get<FirstOpaque>();
+    uint second_slot = TableOpaqueSlot::get<SecondOpaque>();
+
+    EXPECT_NE(first_slot, second_slot);
+    EXPECT_EQ(TableOpaqueSlot::get<FirstOpaque>(), first_slot);
+    EXPECT_EQ(TableOpaqueSlot::getByType(typeid(FirstOpaque)), first_slot);
+    EXPECT_EQ(TableOpaqueSlot::getByType(typeid(SecondOpaque)), second_slot);
+}
+
+TEST_F(TableTest, entry_without_the_slot_has_no_state)
+{
+    EXPECT_TRUE(i_table->createEntry("first", seconds(10)));
+    EXPECT_TRUE(i_table->createEntry("second", seconds(10)));
+
+    EXPECT_TRUE(i_table->setActiveKey("first"));
+    EXPECT_TRUE(i_table->createState<FirstOpaque>(1));
+    EXPECT_FALSE(i_table->createState<FirstOpaque>(2));
+    i_table->unsetActiveKey();
+
+    EXPECT_TRUE(i_table->setActiveKey("second"));
+    EXPECT_TRUE(i_table->createState<SecondOpaque>("value"));
+    i_table->unsetActiveKey();
+
+    // Each entry is missing the slot of the other one, whichever of the slots is the higher one
+    EXPECT_TRUE(i_table->setActiveKey("first"));
+    EXPECT_TRUE(i_table->hasState<FirstOpaque>());
+    EXPECT_EQ(i_table->getState<FirstOpaque>().value, 1);
+    EXPECT_FALSE(i_table->hasState<SecondOpaque>());
+    cptestPrepareToDie();
+    EXPECT_DEATH(i_table->getState<SecondOpaque>(), "Trying to access a non existing opaque");
+    i_table->unsetActiveKey();
+
+    EXPECT_TRUE(i_table->setActiveKey("second"));
+    EXPECT_FALSE(i_table->hasState<FirstOpaque>());
+    EXPECT_DEATH(i_table->getState<FirstOpaque>(), "Trying to access a non existing opaque");
+    EXPECT_EQ(i_table->getState<SecondOpaque>().value, "value");
+    i_table->deleteState<SecondOpaque>();
+    EXPECT_FALSE(i_table->hasState<SecondOpaque>());
+    i_table->unsetActiveKey();
+}
+
+TEST_F(TableTest, synced_entry_keeps_its_states)
+{
+    EXPECT_TRUE(i_table->createEntry("key", seconds(10)));
+    EXPECT_TRUE(i_table->addLinkToEntry("key", "link"));
+    EXPECT_TRUE(i_table->setActiveKey("key"));
+    EXPECT_TRUE(i_table->createState<SecondOpaque>("value"));
+    EXPECT_TRUE(i_table->createState<FirstOpaque>(7));
+    i_table->unsetActiveKey();
+
+    stringstream synced;
+    {
+        cereal::BinaryOutputArchive ar(synced);
+        i_table->saveEntry(i_table->begin(), SyncMode::TRANSFER_ENTRY, ar);
+    }
+    EXPECT_EQ(i_table->count(), 0u);
+
+    {
+        cereal::BinaryInputArchive ar(synced);
+        i_table->loadEntry(ar);
+    }
+    EXPECT_EQ(i_table->count(), 2u);
+
+    // The loaded opaques are placed by their runtime type, so they are found in the slots of their types
+    EXPECT_TRUE(i_table->setActiveKey("link"));
+    EXPECT_EQ(i_table->getState<FirstOpaque>().value, 7);
+    EXPECT_EQ(i_table->getState<SecondOpaque>().value, "value");
+    i_table->unsetActiveKey();
+}
+
+TEST_F(TableTest, entry_expires_within_the_current_tick)
+{
+    curr_time = milliseconds(1010);
+    EXPECT_TRUE(i_table->createEntry("key", milliseconds(30)));
+
+    expireAt(milliseconds(1020));
+    EXPECT_TRUE(i_table->hasEntry("key"));
+
+    // Still the same tick, which wasn't over the previous time it was visited
+    expireAt(milliseconds(1040));
+    EXPECT_FALSE(i_table->hasEntry("key"));
+}
+
+TEST_F(TableTest, expiration_in_the_past)
+{
+    expireAt(seconds(10));
+
+    EXPECT_TRUE(i_table->createEntry("key", seconds(-5)));
+    EXPECT_TRUE(i_table->createEntry("other", seconds(5)));
+
+    expireAt(seconds(10));
+    EXPECT_FALSE(i_table->hasEntry("key"));
+    EXPECT_TRUE(i_table->hasEntry("other"));
+}
+
+TEST_F(TableTest, expiration_beyond_one_rotation)
+{
+    // 5000 ticks away, so the entry shares its bucket with ticks of the first rotation
+    EXPECT_TRUE(i_table->createEntry("key", milliseconds(500000)));
+
+    for (uint tick = 1; tick <= 4096; tick++) {
+        expireAt(milliseconds(tick * 100));
+        EXPECT_TRUE(i_table->hasEntry("key")) << "Expired at tick " << tick;
+    }
+
+    expireAt(milliseconds(499900));
+    EXPECT_TRUE(i_table->hasEntry("key"));
+
+    expireAt(milliseconds(500000));
+    EXPECT_FALSE(i_table->hasEntry("key"));
+}
+
+TEST_F(TableTest, pause_longer_than_one_rotation)
+{
+    EXPECT_TRUE(i_table->createEntry("first", seconds(1)));
+    EXPECT_TRUE(i_table->createEntry("second", seconds(300)));
+    EXPECT_TRUE(i_table->createEntry("third", seconds(700)));
+    EXPECT_TRUE(i_table->createEntry("fourth", seconds(900)));
+
+    expireAt(milliseconds(100));
+    EXPECT_EQ(i_table->count(), 4u);
+
+    expireAt(seconds(800));
+    EXPECT_FALSE(i_table->hasEntry("first"));
+    EXPECT_FALSE(i_table->hasEntry("second"));
+    EXPECT_FALSE(i_table->hasEntry("third"));
+    EXPECT_TRUE(i_table->hasEntry("fourth"));
+
+    expireAt(seconds(900));
+    EXPECT_EQ(i_table->count(), 0u);
+}
+
+TEST_F(TableTest, expiration_is_rearmed)
+{
+    EXPECT_TRUE(i_table->createEntry("key", seconds(1)));
+
+    EXPECT_TRUE(i_table->setActiveKey("key"));
+    i_table->setExpiration(seconds(5));
+    i_table->unsetActiveKey();
+
+    expireAt(seconds(2));
+    EXPECT_TRUE(i_table->hasEntry("key"));
+
+    EXPECT_TRUE(i_table->setActiveKey("key"));
+    i_table->setExpiration(milliseconds(500));
+    i_table->unsetActiveKey();
+
+    expireAt(milliseconds(2400));
+    EXPECT_TRUE(i_table->hasEntry("key"));
+    expireAt(milliseconds(2500));
+    EXPECT_FALSE(i_table->hasEntry("key"));
+}
+
+TEST_F(TableTest, entry_rearmed_while_expiring_is_kept)
+{
+    EXPECT_TRUE(i_table->createEntry("first", seconds(1)));
+    EXPECT_TRUE(i_table->createEntry("second", milliseconds(1500)));
+    addRemovalHook(
+        "first",
+        [this] ()
+        {
+            EXPECT_TRUE(i_table->setActiveKey("second"));
+            i_table->setExpiration(seconds(10));
+            i_table->unsetActiveKey();
+        }
+    );
+
+    // Both entries are due, but removing the first one sets a new expiration for the second one
+    expireAt(seconds(2));
+    EXPECT_FALSE(i_table->hasEntry("first"));
+    EXPECT_TRUE(i_table->hasEntry("second"));
+
+    expireAt(seconds(12));
+    EXPECT_FALSE(i_table->hasEntry("second"));
+}
+
+TEST_F(TableTest, entry_deleted_while_finishing)
+{
+    EXPECT_TRUE(i_table->createEntry("first", seconds(1)));
+    EXPECT_TRUE(i_table->createEntry("second", seconds(1)));
+    EXPECT_TRUE(i_table->addLinkToEntry("second", "link"));
+
+    bool is_removed = false;
+    addRemovalHook("first", [this] () { i_table->deleteEntry("second"); });
+    addRemovalHook("second", [this, &is_removed] () { i_table->deleteEntry("first"); is_removed = true; });
+
+    table.fini();
+    EXPECT_TRUE(is_removed);
+    EXPECT_EQ(i_table->count(), 0u);
+}
@@ -263,6 +263,7 @@ usage()
     set_public_key="-pk, --set-public-key <Public key file path>"
     set_traffic_recording_policy_option="-tr, --traffic-recording-policy <off|req_hdr|req_body|resp_hdr|resp_body>"
     print_metrics_option="-pm, --print-metrics <service>"
+    sampling_profiler_option="-pf, --profile <service> [seconds]"
     view_policy_option="-vp, --view-policy [policy-file]"
     edit_policy_option="-ep, --edit-policy [policy-file]"
     apply_policy_option="-ap, --apply-policy [policy-file]"
@@ -293,6 +294,7 @@ usage()
    # printf "%s %s : Set the SSL certificate's public key file path (PEM format)\n" "$set_public_key" "$(printf "%s" "$line_padding" | cut -c 1-"$(max_num 1 $((${#line_padding} - ${#set_public_key})))")"
    # printf "%s %s : Set traffic recording policy\n" "$set_traffic_recording_policy_option" "$(printf "%s" "$line_padding" | cut -c 1-"$(max_num 1 $((${#line_padding} - ${#set_traffic_recording_policy_option})))")"
    # printf "%s %s : Print metrics report\n" "$print_metrics_option" "$(printf "%s" "$line_padding" | cut -c 1-"$(max_num 1 $((${#line_padding} - ${#print_metrics_option})))")"
+    printf "%s %s : Profile a service and write its collapsed stacks for a flame graph\n" "$sampling_profiler_option" "$(printf "%s" "$line_padding" | cut -c 1-"$(max_num 1 $((${#line_padding} - ${#sampling_profiler_option})))")"
 
     exit 255
 }
@@ -780,6 +782,39 @@ run_print_metrics() # Initials - rpm
     fi
 }
 
+run_sampling_profiler() # Initials - rsp
+{
+    rsp_service_name=$1
+    rsp_duration=${2:-30}
+    if [ -z "${rsp_service_name}" ]; then
+        echo "Usage: open-appsec-ctl --profile <service> [seconds]"
+        return
+    fi
+
+    rsp_port=$(extract_api_port "$rsp_service_name")
+    if [ -z "${rsp_port}" ]; then
+        echo "${rsp_service_name} is not running"
+        return
+    fi
+
+    rsp_errors=$(curl_func "${rsp_port}"/set-sampling-profiler "{\"duration\": ${rsp_duration}}")
+    if [ -n "$(echo "$rsp_errors" | sed "s/$(printf '\r')//g")" ]; then
+        echo "Failed to start the sampling profiler. Error: $rsp_errors"
+        return
+    fi
+
+    echo "Profiling ${rsp_service_name} for ${rsp_duration} seconds"
+    sleep "$rsp_duration"
+
+    rsp_output_file="/tmp/${rsp_service_name}_profile.folded"
+    if [ "${remove_curl_ld_path}" = "true" ]; then
+        LD_LIBRARY_PATH="" ${curl_cmd} -sS --noproxy "*" http://127.0.0.1:"${rsp_port}"/sampling-profiler > "$rsp_output_file"
+    else
+        ${curl_cmd} -sS --noproxy "*" http://127.0.0.1:"${rsp_port}"/sampling-profiler > "$rsp_output_file"
+    fi
+    echo "Collapsed stacks were written to ${rsp_output_file}"
+}
+
 run_health_check() # Initials - rhc
 {
     rhc_orchestration_port=$(extract_default_api_port orchestration)
@@ -1622,6 +1657,8 @@ run() # Initials - r
         run_set_publick_key "$2"
     elif [ "--print-metrics" = "$1" ] || [ "-pm" = "$1" ]; then
         run_print_metrics "$2"
+    elif [ "--profile" = "$1" ] || [ "-pf" = "$1" ]; then
+        run_sampling_profiler "$2" "$3"
     elif [ "--stop-service" = "$1" ] || [ "-qs" = "$1" ]; then
         shift
         stop_service "${@}"
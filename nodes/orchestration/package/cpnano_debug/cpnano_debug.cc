@@ -22,6 +22,7 @@
 
 #include "common.h"
 #include "customized_cereal_map.h"
+#include "debug_binary_trace.h"
 #include "enum_range.h"
 
 #include "cereal/archives/json.hpp"
@@ -66,7 +67,7 @@ static const int error_exit_code = -1;
 static const int ok_exit_code = 0;
 static const int reload_settings_exit_code = 1;
 
-enum class CliCommand { NONE, SHOW, SET, DELETE, ADD, DEFAULT, COUNT };
+enum class CliCommand { NONE, SHOW, SET, DELETE, ADD, DEFAULT, DECODE_TRACE, COUNT };
 
 enum class Service {
     ORCHESTRATION,
@@ -1230,6 +1231,7 @@ DebugCli::usage(const string &custom_error)
         << "\t--add [output stream]          : add debug configuration" << endl
         << "\t--delete [output stream]       : turn off debug configuration" << endl
         << "\t--default                      : set all flags to default debug configuration" << endl
+        << "\t--decode-trace <trace file>    : print the messages of a binary trace output stream" << endl
         << "\t\t output stream : specify which debug output to change (\"FOG\"|\"STDOUT\"|<file>)" << endl
         << "\t--service <nano services list> : specify which Nano service debug configuration will be changed" << endl
         << "\t\t Nano Services list : one or more from the following list separated by spaces : "
@@ -1261,6 +1263,7 @@ convertStringToCliCommand(const string &input)
     if (input == "--delete") return CliCommand::DELETE;
     if (input == "--add") return CliCommand::ADD;
     if (input == "--default") return CliCommand::DEFAULT;
+    if (input == "--decode-trace") return CliCommand::DECODE_TRACE;
     if (input == "-h" || input == "--help") {
         DebugCli::usage();
         exit(ok_exit_code);
@@ -1366,6 +1369,19 @@ DebugCli::main(vector<string> &args)
     CliCommand command = convertStringToCliCommand(args.front());
     args.erase(args.begin());
 
+    if (command == CliCommand::DECODE_TRACE) {
+        if (args.empty()) {
+            usage("No trace file was provided");
+            return error_exit_code;
+        }
+        DebugBinaryTrace::Decoder decoder;
+        if (!decoder.decode(args.front(), cout)) {
+            cerr << "Error: " << decoder.getError() << endl;
+            return error_exit_code;
+        }
+        return ok_exit_code;
+    }
+
     string output_stream;
     if (!args.empty()) {
         switch (command) {